@@ -7,3 +7,5 @@ mkdir build
 cd build
 cmake ..
 make -j4
+./ruby-gte-vectors verify ../tests/gte-vectors.bin
+ctest --output-on-failure
@@ -0,0 +1,259 @@
+#version 450 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+struct Primitive {
+  // x, y, color (0xBBGGRR) and texture position (u | v << 16) of each vertex
+  ivec4 vertices[3];
+  // Bounding box already clipped to the drawing area, inclusive
+  ivec4 bounds;
+  // Flags, texture page (x | y << 16), CLUT (x | y << 16) and texture window
+  uvec4 attributes;
+};
+
+layout(std430, binding = 0) readonly buffer Primitives {
+  Primitive primitives[];
+};
+
+layout(r16ui, binding = 0) uniform uimage2D vram;
+
+uniform ivec2 origin;
+uniform uint primitive_count;
+
+const uint FLAG_LINE = 1u;
+const uint FLAG_TEXTURE_BLEND_MODE_SHIFT = 1u;
+const uint FLAG_TEXTURE_DEPTH_SHIFT_SHIFT = 3u;
+const uint FLAG_SEMI_TRANSPARENCY_MODE_SHIFT = 5u;
+const uint FLAG_SEMI_TRANSPARENT = 1u << 7;
+const uint FLAG_DITHER = 1u << 8;
+const uint FLAG_SET_MASK_BIT = 1u << 9;
+const uint FLAG_CHECK_MASK_BIT = 1u << 10;
+
+const uint TEXTURE_BLEND_MODE_NO_TEXTURE = 0u;
+const uint TEXTURE_BLEND_MODE_RAW_TEXTURE = 1u;
+
+/*
+24bit to 15bit Dither Pattern
+The dither pattern is added to the lower 3bit of the 8bit color values, prior to
+stripping the lower 3bit
+  -4  +0  -3  +1   ;\Dither offsets for first two scanlines
+  +2  -2  +3  -1   ;/
+  -3  +1  -4  +0   ;\Dither offsets for next two scanlines
+  +3  -1  +2  -2   ;/(same as above, but shifted two pixels horizontally)
+*/
+const int DITHER_TABLE[16] = int[16](
+  -4, 0, -3, 1,
+  2, -2, 3, -1,
+  -3, 1, -4, 0,
+  3, -1, 2, -2
+);
+
+shared ivec4 shared_bounds[64];
+
+int floor_div(int numerator, int denominator) {
+  return numerator >= 0 ? numerator / denominator : -((denominator - 1 - numerator) / denominator);
+}
+
+int edge(ivec2 a, ivec2 b, ivec2 p) {
+  return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+// Pixels exactly on an edge only belong to the triangle when the edge is a top or a left one,
+// so triangles sharing an edge never draw the same pixel twice
+bool is_top_left(ivec2 a, ivec2 b) {
+  return (a.y == b.y && b.x > a.x) || b.y < a.y;
+}
+
+ivec3 unpack_color(int color) {
+  return ivec3(color & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff);
+}
+
+ivec2 unpack_texture_position(int position) {
+  return ivec2(position & 0xffff, (position >> 16) & 0xffff);
+}
+
+uint vram_at(int x, int y) {
+  return imageLoad(vram, ivec2(x & 1023, y & 511)).r;
+}
+
+uint texel_at(uvec4 attributes, uint depth_shift, ivec2 texture_position) {
+  ivec2 uv = texture_position & 0xff;
+  // Texel = (Texel AND (NOT (Mask*8))) OR ((Offset AND Mask)*8)
+  ivec2 mask = ivec2(attributes.w & 0x1fu, (attributes.w >> 5) & 0x1fu);
+  ivec2 offset = ivec2((attributes.w >> 10) & 0x1fu, (attributes.w >> 15) & 0x1fu);
+  uv = (uv & ~(mask * 8)) | ((offset & mask) * 8);
+  ivec2 page = ivec2(attributes.y & 0xffffu, attributes.y >> 16);
+  if (depth_shift == 0u) {
+    return vram_at(page.x + uv.x, page.y + uv.y);
+  }
+  uint halfword = vram_at(page.x + (uv.x >> depth_shift), page.y + uv.y);
+  uint bits_per_pixel = 16u >> depth_shift;
+  uint align_mask = (1u << depth_shift) - 1u;
+  uint index = (halfword >> ((uint(uv.x) & align_mask) * bits_per_pixel)) & ((1u << bits_per_pixel) - 1u);
+  ivec2 clut = ivec2(attributes.z & 0xffffu, attributes.z >> 16);
+  return vram_at(clut.x + int(index), clut.y);
+}
+
+ivec3 blend(ivec3 background, ivec3 foreground, uint mode) {
+  switch (mode) {
+    case 0u: {
+      return (background + foreground) >> 1;
+    }
+    case 1u: {
+      return min(background + foreground, ivec3(31));
+    }
+    case 2u: {
+      return max(background - foreground, ivec3(0));
+    }
+    default: {
+      return min(background + (foreground >> 2), ivec3(31));
+    }
+  }
+}
+
+/*
+Returns whether the pixel is covered by the primitive and, if it is, the interpolated color and
+texture position. Values are interpolated with integer barycentrics relative to the first vertex:
+the weights of the other two vertices never add up to more than the doubled area, which keeps
+every product within 32 bits even for 11bit coordinates.
+*/
+bool coverage(Primitive primitive, ivec2 p, out ivec3 color, out ivec2 texture_position) {
+  ivec2 p0 = primitive.vertices[0].xy;
+  ivec2 p1 = primitive.vertices[1].xy;
+  ivec3 c0 = unpack_color(primitive.vertices[0].z);
+  ivec3 c1 = unpack_color(primitive.vertices[1].z);
+  ivec2 t0 = unpack_texture_position(primitive.vertices[0].w);
+  ivec2 t1 = unpack_texture_position(primitive.vertices[1].w);
+  if ((primitive.attributes.x & FLAG_LINE) != 0u) {
+    ivec2 delta = p1 - p0;
+    int steps = max(abs(delta.x), abs(delta.y));
+    int step = 0;
+    if (steps == 0) {
+      if (p != p0) {
+        return false;
+      }
+    } else if (abs(delta.x) >= abs(delta.y)) {
+      step = (p.x - p0.x) * sign(delta.x);
+      if (step < 0 || step > steps || p.y != p0.y + floor_div(2 * step * delta.y + steps, 2 * steps)) {
+        return false;
+      }
+    } else {
+      step = (p.y - p0.y) * sign(delta.y);
+      if (step < 0 || step > steps || p.x != p0.x + floor_div(2 * step * delta.x + steps, 2 * steps)) {
+        return false;
+      }
+    }
+    color = steps == 0 ? c0 : c0 + ivec3(floor_div(step * (c1.r - c0.r), steps), floor_div(step * (c1.g - c0.g), steps), floor_div(step * (c1.b - c0.b), steps));
+    texture_position = t0;
+    return true;
+  }
+  ivec2 p2 = primitive.vertices[2].xy;
+  ivec3 c2 = unpack_color(primitive.vertices[2].z);
+  ivec2 t2 = unpack_texture_position(primitive.vertices[2].w);
+  int area = edge(p0, p1, p2);
+  if (area == 0) {
+    return false;
+  }
+  if (area < 0) {
+    ivec2 swap_point = p1; p1 = p2; p2 = swap_point;
+    ivec3 swap_color = c1; c1 = c2; c2 = swap_color;
+    ivec2 swap_texture = t1; t1 = t2; t2 = swap_texture;
+    area = -area;
+  }
+  int w0 = edge(p1, p2, p);
+  int w1 = edge(p2, p0, p);
+  int w2 = edge(p0, p1, p);
+  if (w0 < 0 || w1 < 0 || w2 < 0) {
+    return false;
+  }
+  if ((w0 == 0 && !is_top_left(p1, p2)) || (w1 == 0 && !is_top_left(p2, p0)) || (w2 == 0 && !is_top_left(p0, p1))) {
+    return false;
+  }
+  ivec3 dc1 = c1 - c0;
+  ivec3 dc2 = c2 - c0;
+  color = c0 + ivec3(floor_div(w1 * dc1.r + w2 * dc2.r, area), floor_div(w1 * dc1.g + w2 * dc2.g, area), floor_div(w1 * dc1.b + w2 * dc2.b, area));
+  ivec2 dt1 = t1 - t0;
+  ivec2 dt2 = t2 - t0;
+  texture_position = t0 + ivec2(floor_div(w1 * dt1.x + w2 * dt2.x, area), floor_div(w1 * dt1.y + w2 * dt2.y, area));
+  return true;
+}
+
+/*
+Shades one pixel of the primitive on top of the current VRAM halfword, returns false when the
+pixel is left untouched (transparent texel or masked destination).
+*/
+bool shade(Primitive primitive, ivec2 p, ivec3 color, ivec2 texture_position, inout uint pixel) {
+  uint flags = primitive.attributes.x;
+  if ((flags & FLAG_CHECK_MASK_BIT) != 0u && (pixel & 0x8000u) != 0u) {
+    return false;
+  }
+  uint texture_blend_mode = (flags >> FLAG_TEXTURE_BLEND_MODE_SHIFT) & 3u;
+  int dither = (flags & FLAG_DITHER) != 0u ? DITHER_TABLE[(p.y & 3) * 4 + (p.x & 3)] : 0;
+  bool semi_transparent = (flags & FLAG_SEMI_TRANSPARENT) != 0u;
+  uint mask = 0u;
+  ivec3 foreground;
+  if (texture_blend_mode == TEXTURE_BLEND_MODE_NO_TEXTURE) {
+    foreground = clamp(color + dither, 0, 255) >> 3;
+  } else {
+    uint texel = texel_at(primitive.attributes, (flags >> FLAG_TEXTURE_DEPTH_SHIFT_SHIFT) & 3u, texture_position);
+    // Texel 0000h is fully transparent
+    if (texel == 0u) {
+      return false;
+    }
+    ivec3 texel_color = ivec3(texel & 0x1fu, (texel >> 5) & 0x1fu, (texel >> 10) & 0x1fu);
+    if (texture_blend_mode == TEXTURE_BLEND_MODE_RAW_TEXTURE) {
+      foreground = texel_color;
+    } else {
+      foreground = clamp(((texel_color << 3) * color >> 7) + dither, 0, 255) >> 3;
+    }
+    mask = texel & 0x8000u;
+    // Textured primitives are only semi-transparent where the texel has bit 15 set
+    semi_transparent = semi_transparent && mask != 0u;
+  }
+  if (semi_transparent) {
+    ivec3 background = ivec3(pixel & 0x1fu, (pixel >> 5) & 0x1fu, (pixel >> 10) & 0x1fu);
+    foreground = blend(background, foreground, (flags >> FLAG_SEMI_TRANSPARENCY_MODE_SHIFT) & 3u);
+  }
+  if ((flags & FLAG_SET_MASK_BIT) != 0u) {
+    mask = 0x8000u;
+  }
+  pixel = uint(foreground.r) | (uint(foreground.g) << 5) | (uint(foreground.b) << 10) | mask;
+  return true;
+}
+
+void main() {
+  ivec2 p = origin + ivec2(gl_GlobalInvocationID.xy);
+  bool inside_vram = p.x < 1024 && p.y < 512;
+  uint pixel = inside_vram ? imageLoad(vram, p).r : 0u;
+  bool modified = false;
+  ivec2 tile_start = origin + ivec2(gl_WorkGroupID.xy * gl_WorkGroupSize.xy);
+  ivec2 tile_end = tile_start + ivec2(gl_WorkGroupSize.xy) - 1;
+  // Primitives are walked in submission order so later ones land on top of earlier ones, each
+  // invocation owns its pixel for the whole batch which keeps blending and mask checks exact
+  for (uint chunk = 0u; chunk < primitive_count; chunk += 64u) {
+    uint index = chunk + gl_LocalInvocationIndex;
+    shared_bounds[gl_LocalInvocationIndex] = index < primitive_count ? primitives[index].bounds : ivec4(1, 1, 0, 0);
+    barrier();
+    uint chunk_size = min(64u, primitive_count - chunk);
+    for (uint i = 0u; i < chunk_size; i++) {
+      ivec4 bounds = shared_bounds[i];
+      if (bounds.x > tile_end.x || bounds.z < tile_start.x || bounds.y > tile_end.y || bounds.w < tile_start.y) {
+        continue;
+      }
+      if (!inside_vram || p.x < bounds.x || p.x > bounds.z || p.y < bounds.y || p.y > bounds.w) {
+        continue;
+      }
+      Primitive primitive = primitives[chunk + i];
+      ivec3 color;
+      ivec2 texture_position;
+      if (!coverage(primitive, p, color, texture_position)) {
+        continue;
+      }
+      modified = shade(primitive, p, color, texture_position, pixel) || modified;
+    }
+    barrier();
+  }
+  if (modified) {
+    imageStore(vram, p, uvec4(pixel, 0u, 0u, 0u));
+  }
+}
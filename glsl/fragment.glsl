@@ -1,7 +1,8 @@
 #version 450 core
 
 uniform sampler2D frame_buffer_texture;
-uniform uint draw_transparent_texture_blend;
+uniform sampler2DArray texture_cache;
+uniform uint subtractive_blend_pass;
 
 in vec3 color;
 flat in uint fragment_transparent;
@@ -10,13 +11,21 @@ flat in uint fragment_texture_blend_mode;
 flat in uvec2 fragment_texture_page;
 flat in uint fragment_texture_depth_shift;
 flat in uvec2 fragment_clut;
+flat in int fragment_texture_cache_layer;
+flat in uint fragment_semi_transparency;
 
-out vec4 fragment_color;
+layout(location = 0, index = 0) out vec4 fragment_color;
+layout(location = 0, index = 1) out vec4 background_factor;
 
 const uint BLEND_MODE_NO_TEXTURE = 0U;
 const uint BLEND_MODE_RAW_TEXTURE = 1U;
 const uint BLEND_MODE_TEXTURE_BLEND = 2U;
 
+const uint SEMI_TRANSPARENCY_HALF = 0U;
+const uint SEMI_TRANSPARENCY_ADD = 1U;
+const uint SEMI_TRANSPARENCY_SUBTRACT = 2U;
+const uint SEMI_TRANSPARENCY_QUARTER = 3U;
+
 int ps_color(vec4 color) {
   int a = int(floor(color.a + 0.5));
   int r = int(floor(color.r * 31. + 0.5));
@@ -34,22 +43,60 @@ vec4 get_pixel_from_vram(uint x, uint y) {
   return texelFetch(frame_buffer_texture, ivec2(x & 0x3ffU, y & 0x1ffU), 0);
 }
 
+// Blending is set to F*1 + B*background_factor (or B*background_factor - F*1 on the
+// subtractive pass), so the foreground is weighted here
+void blend(vec4 foreground, bool semi_transparent) {
+    bool subtractive = semi_transparent && fragment_semi_transparency == SEMI_TRANSPARENCY_SUBTRACT;
+    if (subtractive != (subtractive_blend_pass != 0U)) {
+        discard;
+    }
+    if (!semi_transparent) {
+        fragment_color = foreground;
+        background_factor = vec4(0.);
+        return;
+    }
+    switch (fragment_semi_transparency) {
+        case SEMI_TRANSPARENCY_HALF: {
+            fragment_color = vec4(foreground.rgb * .5, foreground.a);
+            background_factor = vec4(.5);
+            break;
+        }
+        case SEMI_TRANSPARENCY_QUARTER: {
+            fragment_color = vec4(foreground.rgb * .25, foreground.a);
+            background_factor = vec4(1.);
+            break;
+        }
+        default: {
+            fragment_color = foreground;
+            background_factor = vec4(1.);
+            break;
+        }
+    }
+}
+
 void main() {
     if (fragment_texture_blend_mode == BLEND_MODE_NO_TEXTURE) {
-        fragment_color = vec4(color, .0);
+        blend(vec4(color, .0), fragment_transparent != 0U);
     } else {
         uint pixel_per_hw = 1U << fragment_texture_depth_shift;
 
         uint texel_x = uint(fragment_texture_point.x) & 0xffU;
         uint texel_y = uint(fragment_texture_point.y) & 0xffU;
 
-        uint texel_x_pix = texel_x / pixel_per_hw;
+        vec4 texel;
+
+        if (fragment_texture_cache_layer >= 0) {
+            // Paletted page already decoded by the texture cache
+            texel = texelFetch(texture_cache, ivec3(texel_x, texel_y, fragment_texture_cache_layer), 0);
+        } else {
+            uint texel_x_pix = texel_x / pixel_per_hw;
 
-        texel_x_pix += fragment_texture_page.x;
-        texel_y += fragment_texture_page.y;
-        vec4 texel = get_pixel_from_vram(texel_x_pix, texel_y);
+            texel_x_pix += fragment_texture_page.x;
+            texel_y += fragment_texture_page.y;
+            texel = get_pixel_from_vram(texel_x_pix, texel_y);
+        }
 
-        if (fragment_texture_depth_shift > 0) {
+        if (fragment_texture_cache_layer < 0 && fragment_texture_depth_shift > 0) {
             uint align = texel_x & ((1U << fragment_texture_depth_shift) - 1U);
             uint bpp = 16U >> fragment_texture_depth_shift;
             uint shift = (align * bpp);
@@ -72,10 +119,6 @@ void main() {
         uint transparency_flag = uint(floor(texel.a + 0.5));
         uint texel_semi_transparent = transparency_flag & fragment_transparent;
 
-        if (texel_semi_transparent != draw_transparent_texture_blend) {
-            discard;
-        }
-
         vec4 out_color;
 
         if (fragment_texture_blend_mode == BLEND_MODE_RAW_TEXTURE) {
@@ -84,6 +127,6 @@ void main() {
           out_color = vec4(color * 2. * texel.rgb, texel.a);
         }
 
-        fragment_color = out_color;
+        blend(out_color, texel_semi_transparent != 0U);
     }
 }
@@ -0,0 +1,45 @@
+#version 450 core
+
+in ivec2 rectangle_point;
+in ivec2 rectangle_size;
+in uvec3 rectangle_color;
+in uint transparent;
+in ivec2 texture_point;
+in uint texture_blend_mode;
+in uvec2 texture_page;
+in uint texture_depth_shift;
+in uvec2 clut;
+in int texture_cache_layer;
+in uint semi_transparency;
+
+out vec3 color;
+flat out uint fragment_transparent;
+out vec2 fragment_texture_point;
+flat out uint fragment_texture_blend_mode;
+flat out uvec2 fragment_texture_page;
+flat out uint fragment_texture_depth_shift;
+flat out uvec2 fragment_clut;
+flat out int fragment_texture_cache_layer;
+flat out uint fragment_semi_transparency;
+
+uniform ivec2 offset;
+
+void main() {
+    // Drawn as a triangle strip: top left, top right, bottom left, bottom right
+    ivec2 corner = ivec2(gl_VertexID & 1, gl_VertexID >> 1);
+    ivec2 position = rectangle_point + corner * rectangle_size + offset;
+
+    float x_pos = (float(position.x) / 512) - 1.0;
+    float y_pos = 1.0 - (float(position.y) / 256);
+
+    gl_Position.xyzw = vec4(x_pos, y_pos, 0.0, 1.0);
+    color = vec3(float(rectangle_color.r) / 255, float(rectangle_color.g) / 255, float(rectangle_color.b) / 255);
+    fragment_texture_point = vec2(texture_point + corner * rectangle_size);
+    fragment_texture_blend_mode = texture_blend_mode;
+    fragment_texture_page = texture_page;
+    fragment_texture_depth_shift = texture_depth_shift;
+    fragment_clut = clut;
+    fragment_texture_cache_layer = texture_cache_layer;
+    fragment_transparent = transparent;
+    fragment_semi_transparency = semi_transparency;
+}
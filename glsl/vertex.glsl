@@ -8,6 +8,8 @@ in uint texture_blend_mode;
 in uvec2 texture_page;
 in uint texture_depth_shift;
 in uvec2 clut;
+in int texture_cache_layer;
+in uint semi_transparency;
 
 out vec3 color;
 flat out uint fragment_transparent;
@@ -16,6 +18,8 @@ flat out uint fragment_texture_blend_mode;
 flat out uvec2 fragment_texture_page;
 flat out uint fragment_texture_depth_shift;
 flat out uvec2 fragment_clut;
+flat out int fragment_texture_cache_layer;
+flat out uint fragment_semi_transparency;
 
 uniform ivec2 offset;
 
@@ -33,5 +37,7 @@ void main() {
     fragment_texture_page = texture_page;
     fragment_texture_depth_shift = texture_depth_shift;
     fragment_clut = clut;
+    fragment_texture_cache_layer = texture_cache_layer;
     fragment_transparent = transparent;
+    fragment_semi_transparency = semi_transparency;
 }
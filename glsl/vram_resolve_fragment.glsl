@@ -0,0 +1,12 @@
+#version 450 core
+
+uniform usampler2D vram;
+
+in vec2 fragment_texture_position;
+
+out vec4 fragment_color;
+
+void main() {
+  uint pixel = texelFetch(vram, ivec2(fragment_texture_position), 0).r;
+  fragment_color = vec4(float(pixel & 0x1fu) / 31.0, float((pixel >> 5) & 0x1fu) / 31.0, float((pixel >> 10) & 0x1fu) / 31.0, float(pixel >> 15));
+}
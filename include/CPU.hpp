@@ -15,6 +15,10 @@ struct LoadSlot {
     uint32_t previousValue;
 };
 
+// Longest run of GTE commands handed over at once, and NOPs allowed between two of them
+const unsigned int CPU_GTE_SEQUENCE_MAXIMUM_COMMANDS = 3;
+const unsigned int CPU_GTE_SEQUENCE_MAXIMUM_NOPS = 2;
+
 /*
 CPU Register Summary
 Name       Alias    Common Usage
@@ -49,6 +53,7 @@ class CPU {
     bool logBiosFunctionCalls;
     std::unique_ptr<GTE> &gte;
     std::unique_ptr<InterruptController> &interruptController;
+    uint32_t fusedInstructions;
 
     void moveLoadDelaySlots();
     void loadDelaySlot(uint32_t registerIndex, uint32_t value);
@@ -60,6 +65,7 @@ class CPU {
     void decodeAndExecuteInstruction(Instruction instruction);
     void branch(uint32_t offset);
     void triggerException(ExceptionType exceptionType);
+    bool isInterruptPending() const;
 
     void operationLoadUpperImmediate(Instruction instruction);
     void operationBitwiseOrImmediate(Instruction instruction);
@@ -110,6 +116,7 @@ class CPU {
     void operationBitwiseExclusiveOrImmediate(Instruction instruction);
     void operationCoprocessor1(Instruction instruction);
     void operationCoprocessor2(Instruction instruction);
+    void executeCoprocessor2Commands(Instruction instruction);
     void operationCoprocessor3(Instruction instruction);
 
     void operationLoadWordLeft(Instruction instruction);
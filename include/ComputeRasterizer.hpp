@@ -0,0 +1,103 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "RendererProgram.hpp"
+#include "RendererBuffer.hpp"
+#include "GPUImageBuffer.hpp"
+#include "Texture.hpp"
+#include "Vertex.hpp"
+#include "Logger.hpp"
+
+const uint32_t COMPUTE_RASTERIZER_CAPACITY = 16*1024;
+const uint32_t COMPUTE_RASTERIZER_WORKGROUP_SIZE = 8;
+
+const GLuint COMPUTE_PRIMITIVE_LINE = 1;
+const GLuint COMPUTE_PRIMITIVE_TEXTURE_BLEND_MODE_SHIFT = 1;
+const GLuint COMPUTE_PRIMITIVE_TEXTURE_DEPTH_SHIFT_SHIFT = 3;
+const GLuint COMPUTE_PRIMITIVE_SEMI_TRANSPARENCY_MODE_SHIFT = 5;
+const GLuint COMPUTE_PRIMITIVE_SEMI_TRANSPARENT = 1 << 7;
+const GLuint COMPUTE_PRIMITIVE_DITHER = 1 << 8;
+const GLuint COMPUTE_PRIMITIVE_SET_MASK_BIT = 1 << 9;
+const GLuint COMPUTE_PRIMITIVE_CHECK_MASK_BIT = 1 << 10;
+
+/*
+Layout of a primitive in the shader storage buffer (std430), it has to be kept in sync with
+glsl/compute_rasterizer.glsl.
+*/
+struct ComputePrimitive {
+    // x, y, color (0xBBGGRR) and texture position (u | v << 16) of each vertex
+    GLint vertices[3][4];
+    // Bounding box already clipped to the drawing area, inclusive
+    GLint bounds[4];
+    // Flags, texture page (x | y << 16), CLUT (x | y << 16) and texture window
+    GLuint attributes[4];
+};
+
+/*
+Rasterizes primitives the way the GPU does, in a compute shader writing 16bit halfwords straight
+into an R16UI image that mirrors VRAM at native resolution. Blending, dithering, the mask bit and
+texture lookups (CLUT included) are all integer operations on the 15bit values, so no conversion
+to normalized colors happens until the image is resolved into the texture that gets displayed.
+Each invocation owns one VRAM pixel and walks the batch in submission order, which is what keeps
+overlapping semi-transparent primitives exact without any fixed function blending.
+*/
+class ComputeRasterizer {
+    Logger logger;
+    GLuint vramImage;
+    GLuint primitiveBuffer;
+    std::unique_ptr<RendererProgram> program;
+    GLint originUniform;
+    GLint primitiveCountUniform;
+    std::unique_ptr<RendererProgram> resolveProgram;
+    std::unique_ptr<RendererBuffer<Point2D>> resolveBuffer;
+    std::vector<ComputePrimitive> primitives;
+    GLint batchLeft;
+    GLint batchTop;
+    GLint batchRight;
+    GLint batchBottom;
+    GLint batchReadLeft;
+    GLint batchReadTop;
+    GLint batchReadRight;
+    GLint batchReadBottom;
+
+    Point2D drawingOffset;
+    Point2D drawingAreaTopLeft;
+    Dimensions drawingAreaSize;
+    GLuint semiTransparencyMode;
+    bool dithering;
+    bool setMaskBit;
+    bool checkMaskBit;
+    GLuint textureWindow;
+
+    GLuint flagsFor(const Vertex &vertex, bool opaque, bool shaded) const;
+    void packVertex(ComputePrimitive &primitive, uint32_t index, const Vertex &vertex) const;
+    bool clipToDrawingArea(ComputePrimitive &primitive, uint32_t count) const;
+    void pushPrimitive(ComputePrimitive &primitive);
+    bool overlapsBatchWrites(GLint left, GLint top, GLint right, GLint bottom) const;
+    void extendBatchReads(GLint left, GLint top, GLint right, GLint bottom);
+    void markTextureReads(const Vertex &vertex);
+    void pushTriangle(const Vertex &first, const Vertex &second, const Vertex &third, bool opaque, bool shaded);
+public:
+    ComputeRasterizer();
+    ~ComputeRasterizer();
+
+    uint32_t remainingCapacity() const;
+    bool isEmpty() const;
+    bool overlapsBatch(Point2D topLeft, Dimensions size) const;
+    bool conflictsWithBatch(const std::vector<Vertex> &vertices) const;
+    void pushLine(const Vertex &start, const Vertex &end, bool opaque);
+    void pushPolygon(const std::vector<Vertex> &vertices, bool opaque);
+    void setDrawingOffset(int16_t x, int16_t y);
+    void setDrawingArea(Point2D topLeft, Dimensions size);
+    void setSemiTransparencyMode(GLuint mode);
+    void setDithering(bool enabled);
+    void setMaskBitSetting(bool setMaskBit, bool checkMaskBit);
+    void setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY);
+    uint32_t flush();
+    void writeVRAM(std::unique_ptr<GPUImageBuffer> &imageBuffer, GLintptr unpackOffset);
+    void fillVRAM(Point2D topLeft, Dimensions size, uint16_t color);
+    std::vector<uint16_t> readVRAM();
+    void resolve(std::unique_ptr<Texture> &texture);
+};
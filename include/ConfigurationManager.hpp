@@ -3,6 +3,7 @@
 #include <yaml/Yaml.hpp>
 #include <filesystem>
 #include "Logger.hpp"
+#include "RendererBackend.hpp"
 
 class ConfigurationManager {
     static ConfigurationManager *instance;
@@ -12,6 +13,13 @@ class ConfigurationManager {
     std::string ctrllerName;
     bool resizeWindowToFitFramefuffer;
     bool showDebugInfoWindow;
+    bool useTextureCache;
+    uint32_t internalResolutionScale;
+    RendererBackend backend;
+    uint32_t softwareRendererThreadCount;
+    bool useAutoFrameSkip;
+    uint32_t maximumSkippedFrames;
+    bool useDisplayListCache;
 
     LogLevel bios;
     LogLevel cdrom;
@@ -36,6 +44,14 @@ public:
     std::string controllerName();
     bool shouldResizeWindowToFitFramebuffer();
     bool shouldShowDebugInfoWindow();
+    bool shouldUseTextureCache();
+    uint32_t internalResolution();
+    RendererBackend rendererBackend();
+    bool shouldUseOpenGL();
+    uint32_t softwareRendererThreads();
+    bool shouldUseAutoFrameSkip();
+    uint32_t maxSkippedFrames();
+    bool shouldUseDisplayListCache();
 
     LogLevel biosLogLevel();
     LogLevel cdromLogLevel();
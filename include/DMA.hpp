@@ -8,6 +8,7 @@
 #include "CDROM.hpp"
 #include "Logger.hpp"
 #include "DMAPort.hpp"
+#include "DisplayListCache.hpp"
 
 // 1F8010F0h - DPCR - DMA Control Register (R/W)
 // 0-2   DMA0, MDECin  Priority      (0..7; 0=Highest, 7=Lowest)
@@ -215,6 +216,8 @@ class DMA {
     DMAInterrupt interrupt;
     bool shouldTriggerInterrupt;
 
+    std::unique_ptr<DisplayListCache> displayListCache;
+
     Channel channels[7];
     Channel& channelForPort(DMAPort port);
 
@@ -229,6 +232,8 @@ class DMA {
     void execute(DMAPort port);
     void executeBlock(DMAPort port, Channel& channel);
     void executeLinkedList(DMAPort port, Channel& channel);
+    void executeLinkedListPacket(uint32_t address, uint32_t size);
+    void executeCachedLinkedListPacket(uint32_t address, uint32_t size);
 
     DMAPort portWithIndex(uint32_t index);
     std::string portDescription(DMAPort port);
@@ -4,13 +4,20 @@
 #include <imgui/imgui.h>
 #include <SDL2/SDL.h>
 #include <vector>
+#include <deque>
 #include <string>
+#include "RendererStatistics.hpp"
 
 class DebugInfoRenderer {
     std::unique_ptr<Window> &debugWindow;
     ImGuiIO *io;
     ImVec4 backgroundColor;
     std::vector<std::string> biosFunctionsLog;
+    std::deque<RendererStatistics> rendererStatisticsHistory;
+
+    void plotRendererStatistic(const char *label, uint64_t RendererStatistics::*counter);
+    void plotRendererStatistic(const char *label, uint64_t (RendererStatistics::*counter)() const);
+    void plotRendererStatistic(const char *label, std::vector<float> values);
 public:
     DebugInfoRenderer(std::unique_ptr<Window> &debugWindow);
     ~DebugInfoRenderer();
@@ -18,4 +25,5 @@ public:
     void update();
     void handleSDLEvent(SDL_Event event);
     void pushLog(std::string log);
+    void setRendererStatisticsHistory(std::deque<RendererStatistics> history);
 };
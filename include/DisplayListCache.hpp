@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "Vertex.hpp"
+#include "RAM.hpp"
+
+// Whole cache is dropped once it holds this many packets, games reuse far fewer between frames
+const uint32_t DISPLAY_LIST_CACHE_MAXIMUM_PACKETS = 16384;
+
+/*
+GPU registers read while decoding drawing commands. A packet decoded with different values would
+produce different primitives, so it's part of what has to match for a cached packet to be reused.
+*/
+struct DisplayListState {
+    uint8_t texturePageBaseX;
+    uint8_t texturePageBaseY;
+    uint8_t texturePageColors;
+    uint8_t semiTransparency;
+    uint16_t drawingAreaTop;
+    uint16_t drawingAreaLeft;
+    uint16_t drawingAreaBottom;
+    uint16_t drawingAreaRight;
+    int16_t drawingOffsetX;
+    int16_t drawingOffsetY;
+
+    bool operator==(const DisplayListState &other) const;
+};
+
+enum DisplayListCommandType {
+    DisplayListPolygon = 0,
+    DisplayListLine = 1,
+    DisplayListRectangle = 2,
+    DisplayListSemiTransparency = 3
+};
+
+/*
+One call the GPU made to the renderer while decoding a packet.
+*/
+struct DisplayListCommand {
+    DisplayListCommandType type;
+    std::vector<Vertex> vertices;
+    RectangleInstance rectangle;
+    bool opaque;
+    TextureBlendMode textureBlendMode;
+    uint8_t semiTransparency;
+
+    DisplayListCommand(DisplayListCommandType type, std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode);
+    DisplayListCommand(RectangleInstance rectangle);
+    DisplayListCommand(uint8_t semiTransparency);
+    ~DisplayListCommand();
+};
+
+/*
+A linked-list packet along with the renderer calls decoding it produced. Only packets made of
+drawing commands can be replayed, since any other command changes state the cache doesn't track.
+The others are kept without their commands, marked as not cacheable.
+*/
+struct DisplayListPacket {
+    uint32_t size;
+    uint64_t hash;
+    uint32_t firstPage;
+    uint32_t lastPage;
+    std::vector<uint32_t> pageGenerations;
+    DisplayListState state;
+    std::vector<DisplayListCommand> commands;
+    bool cacheable;
+};
+
+/*
+Memoizes the decoding of GPU linked-list packets by their address in RAM. A packet is reused when
+the GPU state matches and the pages it lives in haven't been written since it was recorded. When
+they were, the words are hashed, so packets rebuilt every frame with the same contents are still
+reused. The link to the next packet isn't part of the hash, ordering tables relink packets every
+frame. Packets found to be uncacheable are kept without their commands, so they are neither
+recorded nor hashed again until their words change.
+*/
+class DisplayListCache {
+    std::unordered_map<uint32_t, DisplayListPacket> packets;
+
+    uint64_t hashPacket(uint32_t address, uint32_t size, const RAM &ram) const;
+    void storePageGenerations(DisplayListPacket &packet, const RAM &ram) const;
+    bool arePageGenerationsCurrent(const DisplayListPacket &packet, const RAM &ram) const;
+    bool areWordsCurrent(DisplayListPacket &packet, uint32_t address, const RAM &ram) const;
+public:
+    DisplayListCache();
+    ~DisplayListCache();
+
+    const DisplayListPacket* find(uint32_t address, uint32_t size, const RAM &ram, const DisplayListState &state);
+    DisplayListPacket* record(uint32_t address, uint32_t size, const RAM &ram, const DisplayListState &state);
+    void discard(uint32_t address);
+};
@@ -52,6 +52,7 @@ class Emulator {
 
     bool showDebugInfoWindow;
     bool logBiosFunctionCalls;
+    bool headless;
 
     void checkBIOSFunctions();
     void checkTTY(char c);
@@ -67,6 +68,7 @@ public:
     void dumpRAM();
     void handleSDLEvent(SDL_Event event);
     bool shouldTerminate();
+    bool isHeadless();
     void toggleDebugInfoWindow();
     void toggleRenderPolygonOneByOne();
     void loadCDROMImageFile(std::filesystem::path filePath);
@@ -39,9 +39,14 @@ class EmulatorRunner {
     Emulator *emulator;
     bool runTests;
     bool loadExpansionROM;
+    bool headless;
+    bool recordGPU;
+    bool captureFrames;
     std::filesystem::path exeFile;
     std::filesystem::path binFile;
     std::filesystem::path romFile;
+    std::filesystem::path gpuRecordingFile;
+    std::filesystem::path frameCaptureFile;
     uint8_t header[TEST_HEADER_SIZE];
 
     void readHeader();
@@ -61,7 +66,12 @@ public:
     void setEmulator(Emulator *emulator);
     bool shouldRunTests();
     bool shouldLoadExpansionROM();
+    bool shouldRunHeadless();
+    bool shouldRecordGPU();
+    bool shouldCaptureFrames();
     std::filesystem::path romFilePath();
+    std::filesystem::path gpuRecordingFilePath();
+    std::filesystem::path frameCaptureFilePath();
     uint32_t programCounter();
     uint32_t globalPointer();
     uint32_t initialStackFramePointerBase();
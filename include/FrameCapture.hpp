@@ -0,0 +1,74 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <array>
+#include <deque>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include "Texture.hpp"
+#include "Logger.hpp"
+
+const uint32_t FRAME_CAPTURE_RING_SIZE = 3;
+const uint32_t FRAME_CAPTURE_FRAME_RATE = 60;
+
+enum FrameCaptureFormat {
+    FrameCaptureY4M = 0,
+    FrameCaptureRaw = 1,
+    FrameCapturePNG = 2
+};
+
+struct CapturedFrame {
+    uint32_t width;
+    uint32_t height;
+    // RGBA8, bottom row first as returned by glReadPixels
+    std::vector<uint8_t> pixels;
+};
+
+/*
+Captures the displayed area of every presented frame without stalling the emulation thread.
+Each frame is read back asynchronously into one of a ring of pixel buffer objects and is only
+mapped FRAME_CAPTURE_RING_SIZE frames later, when the transfer has long finished. Mapped frames
+are handed over to a writer thread that encodes them as a Y4M stream (.y4m), a raw RGB24 stream
+(.raw) or, for any other path, a directory of numbered PNG files.
+*/
+class FrameCapture {
+    Logger logger;
+    std::filesystem::path path;
+    FrameCaptureFormat format;
+
+    std::array<GLuint, FRAME_CAPTURE_RING_SIZE> pixelBuffers;
+    std::array<GLsizeiptr, FRAME_CAPTURE_RING_SIZE> pixelBufferSizes;
+    std::array<GLsync, FRAME_CAPTURE_RING_SIZE> fences;
+    std::array<uint32_t, FRAME_CAPTURE_RING_SIZE> widths;
+    std::array<uint32_t, FRAME_CAPTURE_RING_SIZE> heights;
+    uint32_t nextSlot;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<CapturedFrame> queue;
+    bool finished;
+
+    std::ofstream stream;
+    uint32_t streamWidth;
+    uint32_t streamHeight;
+    uint64_t framesWritten;
+    std::vector<uint8_t> encodeBuffer;
+
+    void drain(uint32_t slot);
+    void writerLoop();
+    void writeFrame(CapturedFrame &frame);
+    void writeStreamFrame(CapturedFrame &frame);
+    void writePNG(CapturedFrame &frame);
+public:
+    FrameCapture(std::filesystem::path path);
+    ~FrameCapture();
+
+    void capture(std::unique_ptr<Texture> &texture, GLint x, GLint y, GLsizei width, GLsizei height);
+    void capture(CapturedFrame frame);
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+
+// Stalls longer than this many frames (debugger, window drags) are forgotten instead of skipped
+const uint32_t FRAME_SKIP_STALL_FRAMES = 30;
+
+/*
+Decides at every vblank whether the frame should be presented. The host time between vblanks is
+compared against the frame budget, and the time lost on frames that went over it accumulates as
+lag. While the lag is larger than a whole frame, frames are skipped so the ones after them are
+cheaper and emulation catches up, never skipping more than the maximum in a row so the display
+keeps updating.
+*/
+class FrameSkipController {
+    bool enabled;
+    uint32_t maximumSkippedFrames;
+    std::chrono::steady_clock::duration frameBudget;
+    std::chrono::steady_clock::time_point lastFrame;
+    std::chrono::steady_clock::duration lag;
+    uint32_t consecutiveSkippedFrames;
+    bool started;
+public:
+    FrameSkipController(bool enabled, uint32_t maximumSkippedFrames, uint32_t frameRate);
+    ~FrameSkipController();
+
+    void setEnabled(bool enabled);
+    bool shouldSkipFrame();
+    bool shouldSkipFrame(std::chrono::steady_clock::time_point now);
+};
@@ -7,5 +7,6 @@ class Framebuffer {
     GLuint object;
 public:
     Framebuffer(std::unique_ptr<Texture> &texture);
+    Framebuffer(std::unique_ptr<Texture> &texture, GLenum target);
     ~Framebuffer();
 };
@@ -2,6 +2,10 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <vector>
+#include <deque>
+#include <initializer_list>
+#include <filesystem>
 #include "GPUInstructionBuffer.hpp"
 #include "Renderer.hpp"
 #include "GPUImageBuffer.hpp"
@@ -9,6 +13,9 @@
 #include "Logger.hpp"
 #include "InterruptController.hpp"
 #include "DebugInfoRenderer.hpp"
+#include "GPURecorder.hpp"
+#include "FrameSkipController.hpp"
+#include "DisplayListCache.hpp"
 
 enum TexturePageColors {
     T4Bit = 0,
@@ -149,6 +156,8 @@ GP1(07h) - Vertical Display range (on Screen)
     std::function<void(void)> gp0InstructionMethod;
 
     uint32_t gpuRead;
+    std::vector<uint16_t> vramReadBuffer;
+    uint32_t vramReadIndex;
 
     GP0Mode gp0Mode;
 
@@ -161,10 +170,24 @@ GP1(07h) - Vertical Display range (on Screen)
     uint32_t scanlineCounter;
 
     bool showDebugInfoWindow;
+    bool headless;
     std::unique_ptr<DebugInfoRenderer> &debugInfoRenderer;
 
     unsigned int frameCounter;
 
+    std::unique_ptr<GPURecorder> recorder;
+    std::unique_ptr<FrameSkipController> frameSkipController;
+    DisplayListPacket *displayListRecording;
+
+    bool isOutsideDrawingArea(int32_t left, int32_t top, int32_t right, int32_t bottom) const;
+    bool isPrimitiveDrawn(std::initializer_list<unsigned int> positionWords);
+    uint8_t drawnTriangles(unsigned int numberOfPoints, unsigned int wordsPerVertex);
+    void pushDrawnTriangles(std::vector<Vertex> vertices, uint8_t triangles, bool opaque, TextureBlendMode textureBlendMode);
+    void pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode);
+    void pushLine(std::vector<Vertex> vertices, bool opaque);
+    void pushRectangle(RectangleInstance rectangle);
+    void updateSemiTransparency(uint8_t mode);
+
     void operationGp0Nop();
     void operationGp0DrawMode();
     void operationGp0SetDrawingAreaTopLeft();
@@ -175,6 +198,7 @@ GP1(07h) - Vertical Display range (on Screen)
     void operationGp0ClearCache();
     void operationGp0CopyRectangleCPUToVRAM();
     void operationGp0CopyRectangleVRAMToCPU();
+    void operationGp0CopyRectangleVRAMToVRAM();
 
     void operationGp0MonochromeThreePointOpaque();
     void operationGp0MonochromeThreePointSemiTransparent();
@@ -250,7 +274,7 @@ GP1(07h) - Vertical Display range (on Screen)
     void operationGp1GetGPUInfo(uint32_t value);
 
     uint32_t statusRegister() const;
-    uint32_t readRegister() const;
+    uint32_t readRegister();
 
     void texturedQuad(Dimensions dimensions, bool opaque, TextureBlendMode textureBlendMode);
     void quad(Dimensions dimensions, bool opaque);
@@ -265,19 +289,32 @@ GP1(07h) - Vertical Display range (on Screen)
     TexturePageColors texturePageColorsWithValue(uint32_t value) const;
     uint8_t horizontalResolutionFromValues(uint8_t value1, uint8_t value2) const;
 
-    void render();
     void updateDrawingArea();
 public:
     GPU(LogLevel logLevel, std::unique_ptr<Window> &mainWindow, std::unique_ptr<InterruptController> &interruptController, std::unique_ptr<DebugInfoRenderer> &debugInfoRenderer);
     ~GPU();
     template <typename T>
-    inline T load(uint32_t offset) const;
+    inline T load(uint32_t offset);
     template <typename T>
     inline void store(uint32_t offset, T value);
 
     // TODO: should be private
     void executeGp0(uint32_t value);
+    bool isLoadingImage() const;
+    uint32_t loadImageWords(const uint8_t *data, uint32_t count);
+    bool canCacheDisplayList() const;
+    DisplayListState displayListState() const;
+    void startDisplayListRecording(DisplayListPacket *packet);
+    void stopDisplayListRecording();
+    void replayDisplayList(const DisplayListPacket &packet);
+    void countDisplayListPacket(RendererDisplayListPacket packet);
+    uint32_t loadWordFromReadBuffer();
     void step(uint32_t cycles);
+    void render();
+    void startRecording(std::filesystem::path filePath);
+    void startCapture(std::filesystem::path filePath);
+    RendererStatistics getRendererStatistics();
+    std::deque<RendererStatistics> getRendererStatisticsHistory();
     Dimensions getResolution();
     Point2D getDisplayAreaStart();
     Dimensions getDrawingAreaSize();
@@ -2,7 +2,7 @@
 #include "GPU.hpp"
 
 template <typename T>
-inline T GPU::load(uint32_t offset) const {
+inline T GPU::load(uint32_t offset) {
     static_assert(std::is_same<T, uint8_t>() || std::is_same<T, uint16_t>() || std::is_same<T, uint32_t>(), "Invalid type");
     if (sizeof(T) != 4) {
         logger.logError("Unsupported GPU read with size: %d", sizeof(T));
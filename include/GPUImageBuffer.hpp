@@ -4,7 +4,7 @@
 
 const uint32_t VRAM_WIDTH = 1024;
 const uint32_t VRAM_HEIGHT = 512;
-const uint32_t VRAM_SIZE = (VRAM_WIDTH * VRAM_HEIGHT) / sizeof(uint16_t);
+const uint32_t VRAM_SIZE = VRAM_WIDTH * VRAM_HEIGHT;
 
 class GPUImageBuffer {
     uint16_t destinationX;
@@ -21,6 +21,8 @@ public:
     std::pair<uint16_t, uint16_t> resolution();
     void reset(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
     void pushWord(uint32_t word);
+    void pushWords(const uint8_t *data, uint32_t count);
+    void pushHalfwords(const uint16_t *data, uint32_t count);
     bool isValid();
     uint16_t* bufferRef();
 };
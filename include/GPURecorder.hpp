@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include "Logger.hpp"
+
+const char GPU_RECORDING_MAGIC[] = "RUBYGPU";
+const uint8_t GPU_RECORDING_VERSION = 1;
+const uint32_t GPU_RECORDING_MAXIMUM_RUN_LENGTH = 4096;
+
+enum GPURecordType {
+    GPURecordGp0 = 0,
+    GPURecordGp1 = 1,
+    GPURecordVBlank = 2
+};
+
+/*
+Writes every word sent to GP0 and GP1 to a binary dump that ruby-gpu-replay can feed back into
+the GPU. The file starts with the 7 byte magic and a version byte, followed by records: a record
+type byte, and for GP0 and GP1 records a little endian word count and that many words. Consecutive
+words for the same port are grouped into a single record, vblank records carry no payload.
+*/
+class GPURecorder {
+    Logger logger;
+    std::ofstream file;
+    GPURecordType pendingType;
+    std::vector<uint32_t> pendingWords;
+
+    void writeWord(uint32_t value);
+    void flush();
+    void record(GPURecordType type, uint32_t value);
+public:
+    GPURecorder(std::filesystem::path filePath);
+    ~GPURecorder();
+
+    void recordGp0(uint32_t value);
+    void recordGp1(uint32_t value);
+    void recordVBlank();
+};
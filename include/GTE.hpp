@@ -3,6 +3,7 @@
 #include "Logger.hpp"
 #include "GTEInstruction.hpp"
 #include "GTEFlagRegister.hpp"
+#include "GTETripleVector.hpp"
 
 struct GTEVector3_16_t {
     int16_t x;
@@ -126,6 +127,16 @@ class GTE {
     int16_t zsf3; // cop2r61
     int16_t zsf4; // cop2r62
     GTEFlagRegister flag; // cop2r63
+    const GTETripleVectorKernels *tripleVectorKernels;
+
+    GTETripleVectorInput tripleVectorInput(bool shiftFraction, bool lm) const;
+    void storeTripleVectorColors(const GTETripleVectorOutput &output);
+    template <bool shiftFraction, bool lm>
+    void executeCommand(GTEInstruction instruction);
+    template <bool shiftFraction>
+    void projectVector(const GTEVector3_16_t &v, GTEFlagRegister &flags, GTEVector2_16_t &sxy, uint16_t &sz);
+    template <bool shiftFraction>
+    void perspectiveTransformationOnThreePointsDiscardingFlags();
 public:
     GTE(LogLevel logLevel);
     ~GTE();
@@ -135,27 +146,47 @@ public:
     void setControl(uint32_t index, uint32_t value);
     uint32_t getControl(uint32_t index);
     void execute(uint32_t value);
+    unsigned int executeSequence(const uint32_t *values, unsigned int count);
 
-    void squareVector(GTEInstruction instruction);
-    void normalClipping(GTEInstruction instruction);
-    void averageOfThreeZValues(GTEInstruction instruction);
-    void averageOfFourZValues(GTEInstruction instruction);
-    void outerProductOfTwoVectors(GTEInstruction instruction);
-    void generalPurposeInterpolationGPF(GTEInstruction instruction);
-    void generalPurposeInterpolationGPL(GTEInstruction instruction);
-    void perspectiveTransformation(GTEInstruction instruction, unsigned int index);
-    void perspectiveTransformationOnThreePoints(GTEInstruction instruction);
-    void normalColorNCS(GTEInstruction instruction, unsigned int index);
-    void normalColorNCT(GTEInstruction instruction);
-    void normalColorColorSingleVector(GTEInstruction instruction, unsigned int index);
-    void normalColorColorTripleVector(GTEInstruction instruction);
-    void colorColor(GTEInstruction instruction);
-    void depthCueingDPCS(GTEInstruction instruction, bool useFIFO);
-    void depthCueingDPCT(GTEInstruction instruction);
-    void interpolationOfVectorAndFarColorVector(GTEInstruction instruction);
-    void colorDepthQue(GTEInstruction instruction);
-    void normalColorDepthCueSingleVector(GTEInstruction instruction, unsigned int index);
-    void normalColorDepthCueTripleVector(GTEInstruction instruction);
-    void depthCueColorLight(GTEInstruction instruction);
+    template <bool shiftFraction, bool lm>
+    void squareVector();
+    void normalClipping();
+    void averageOfThreeZValues();
+    void averageOfFourZValues();
+    template <bool shiftFraction, bool lm>
+    void outerProductOfTwoVectors();
+    template <bool shiftFraction, bool lm>
+    void generalPurposeInterpolationGPF();
+    template <bool shiftFraction, bool lm>
+    void generalPurposeInterpolationGPL();
+    template <bool shiftFraction, bool lm>
+    void perspectiveTransformation(unsigned int index);
+    template <bool shiftFraction, bool lm>
+    void perspectiveTransformationOnThreePoints();
+    template <bool shiftFraction, bool lm>
+    void normalColorNCS(unsigned int index);
+    template <bool shiftFraction, bool lm>
+    void normalColorNCT();
+    template <bool shiftFraction, bool lm>
+    void normalColorColorSingleVector(unsigned int index);
+    template <bool shiftFraction, bool lm>
+    void normalColorColorTripleVector();
+    template <bool shiftFraction, bool lm>
+    void colorColor();
+    template <bool shiftFraction, bool lm>
+    void depthCueingDPCS(bool useFIFO);
+    template <bool shiftFraction, bool lm>
+    void depthCueingDPCT();
+    template <bool shiftFraction, bool lm>
+    void interpolationOfVectorAndFarColorVector();
+    template <bool shiftFraction, bool lm>
+    void colorDepthQue();
+    template <bool shiftFraction, bool lm>
+    void normalColorDepthCueSingleVector(unsigned int index);
+    template <bool shiftFraction, bool lm>
+    void normalColorDepthCueTripleVector();
+    template <bool shiftFraction, bool lm>
+    void depthCueColorLight();
+    template <bool shiftFraction, bool lm>
     void multiplyVectorByMatrixAndVectorAddition(GTEInstruction instruction);
 };
@@ -0,0 +1,22 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Only holds constant data, so the triple vector kernels can share it whatever they're built with
+const uint32_t GTE_UNR_TABLE_SIZE = 0x101;
+
+/*
+Initial reciprocal guesses of the GTE's Unsigned Newton-Raphson division, indexed by the top bits
+of the normalized divisor.
+unr_table[i] = max(0, (40000h / (i + 100h) + 1) / 2 - 101h)
+*/
+constexpr std::array<uint32_t, GTE_UNR_TABLE_SIZE> generateGTEUNRTable() {
+    std::array<uint32_t, GTE_UNR_TABLE_SIZE> table = {};
+    for (uint32_t i = 0; i < GTE_UNR_TABLE_SIZE; i++) {
+        int32_t value = (int32_t)((0x40000 / (i + 0x100) + 1) / 2) - 0x101;
+        table[i] = value > 0 ? value : 0;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, GTE_UNR_TABLE_SIZE> GTE_UNR_TABLE = generateGTEUNRTable();
@@ -54,16 +54,15 @@ union GTEFlagRegister {
 
     GTEFlagRegister() : _value(0) {};
 
-    void setMACNegative(unsigned int index);
-    void setMACPositive(unsigned int index);
-    void setIR(unsigned int index);
-    void setRGB(unsigned int index);
-    void setSXY2(unsigned int index);
-    int64_t calculateMAC(unsigned int index, int64_t value);
+    template <unsigned int index>
+    int64_t calculateMAC(int64_t value);
     int32_t calculateMAC0(int64_t value);
-    int16_t calculateIR(unsigned int index, int64_t value, bool lm);
+    template <unsigned int index, bool lm>
+    int16_t calculateIR(int64_t value);
     int16_t calculateIR0(int64_t value);
     uint16_t calculateSZ3(int64_t value);
-    uint8_t calculateRGB(unsigned int index, int value);
-    int16_t calculateSXY2(unsigned int index, int value);
+    template <unsigned int index>
+    uint8_t calculateRGB(int value);
+    template <unsigned int index>
+    int16_t calculateSXY2(int value);
 };
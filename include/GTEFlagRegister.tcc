@@ -0,0 +1,57 @@
+#pragma once
+#include <algorithm>
+#include "GTEFlagRegister.hpp"
+
+/*
+Saturation checks run for every component of every command, so bits are ORed in from the
+comparisons instead of branching on them. Bits for index 1 to 3 sit next to each other, index 1
+on the highest one.
+*/
+template <unsigned int index>
+inline int64_t GTEFlagRegister::calculateMAC(int64_t value) {
+    static_assert(index >= 1 && index <= 3, "Invalid MAC index");
+    _value |= ((uint32_t)(value > 0x7FFFFFFFFFF) << (31 - index)) | ((uint32_t)(value < -0x80000000000) << (28 - index));
+    return (value << 20) >> 20;
+}
+
+inline int32_t GTEFlagRegister::calculateMAC0(int64_t value) {
+    _value |= ((uint32_t)(value > 0x7FFFFFFF) << 16) | ((uint32_t)(value < -(int64_t)0x80000000) << 15);
+    return value;
+}
+
+template <unsigned int index, bool lm>
+inline int16_t GTEFlagRegister::calculateIR(int64_t value) {
+    static_assert(index >= 1 && index <= 3, "Invalid IR index");
+    const int64_t minimum = lm ? 0 : -0x8000;
+    int64_t saturated = std::min(std::max(value, minimum), (int64_t)0x7FFF);
+    _value |= (uint32_t)(saturated != value) << (25 - index);
+    return saturated;
+}
+
+inline int16_t GTEFlagRegister::calculateIR0(int64_t value) {
+    int64_t saturated = std::min(std::max(value, (int64_t)0), (int64_t)0x1000);
+    _value |= (uint32_t)(saturated != value) << 12;
+    return saturated;
+}
+
+inline uint16_t GTEFlagRegister::calculateSZ3(int64_t value) {
+    int64_t saturated = std::min(std::max(value, (int64_t)0), (int64_t)0xFFFF);
+    _value |= (uint32_t)(saturated != value) << 18;
+    return saturated;
+}
+
+template <unsigned int index>
+inline uint8_t GTEFlagRegister::calculateRGB(int value) {
+    static_assert(index >= 1 && index <= 3, "Invalid color index");
+    int saturated = std::min(std::max(value, 0), 0xFF);
+    _value |= (uint32_t)(saturated != value) << (22 - index);
+    return saturated;
+}
+
+template <unsigned int index>
+inline int16_t GTEFlagRegister::calculateSXY2(int value) {
+    static_assert(index >= 1 && index <= 2, "Invalid SXY2 index");
+    int saturated = std::min(std::max(value, -0x400), 0x3FF);
+    _value |= (uint32_t)(saturated != value) << (15 - index);
+    return saturated;
+}
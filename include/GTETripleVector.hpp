@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+
+// The triple vector kernels are built once per instruction set, so this header stays free of
+// GTE.hpp and anything else that could end up compiled with instructions the host does not support
+
+/*
+Registers read by RTPT, NCT, NCCT and NCDT. Vectors are laid out by component so each one loads
+straight into a register, lane n holding Vn and the fourth lane repeating V2.
+*/
+struct alignas(16) GTETripleVectorInput {
+    int32_t vx[4];
+    int32_t vy[4];
+    int32_t vz[4];
+    int32_t rotation[3][3];
+    int32_t translation[3];
+    int32_t light[3][3];
+    int32_t background[3];
+    int32_t lightColor[3][3];
+    int32_t farColor[3];
+    int32_t color[3];
+    int32_t ir0;
+    int32_t offsetX;
+    int32_t offsetY;
+    int32_t h;
+    int32_t dqa;
+    int32_t dqb;
+    uint32_t shiftFraction;
+    bool lm;
+};
+
+/*
+Results for each vector in the same lane order, along with the FLAG bits raised by any of them.
+*/
+struct alignas(16) GTETripleVectorOutput {
+    int32_t mac[3][4];
+    int32_t ir[3][4];
+    int32_t mac0[4];
+    int32_t ir0[4];
+    int32_t sx[4];
+    int32_t sy[4];
+    int32_t sz[4];
+    int32_t rgb[3][4];
+    uint32_t flags;
+};
+
+typedef void (*GTETripleVectorKernel)(const GTETripleVectorInput &input, GTETripleVectorOutput &output);
+
+struct GTETripleVectorKernels {
+    GTETripleVectorKernel perspectiveTransformation;
+    GTETripleVectorKernel normalColor;
+    GTETripleVectorKernel normalColorColor;
+    GTETripleVectorKernel normalColorDepthCue;
+};
+
+const GTETripleVectorKernels* gteTripleVectorKernelsSSE41();
+const GTETripleVectorKernels* gteTripleVectorKernelsAVX2();
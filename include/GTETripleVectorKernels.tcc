@@ -0,0 +1,203 @@
+#pragma once
+#include "GTETripleVector.hpp"
+#include "GTEDivision.hpp"
+
+/*
+The triple vector commands shared by every instruction set. Each translation unit that includes
+this file provides a Lanes type with static helpers over four 32bit lanes (Type) and four 64bit
+lanes (WideType), and gets its own internal copy of the kernels. They follow the scalar commands
+in GTE.cpp step by step, including where results get truncated to 32bit, so both give the same
+registers and flags. The fourth lane repeats V2, so any flag it raises V2 raised as well.
+*/
+const uint32_t GTE_FLAG_IR0 = 1 << 12;
+const uint32_t GTE_FLAG_SY2 = 1 << 13;
+const uint32_t GTE_FLAG_SX2 = 1 << 14;
+const uint32_t GTE_FLAG_DIVIDE_OVERFLOW = 1 << 17;
+const uint32_t GTE_FLAG_SZ3 = 1 << 18;
+const uint32_t GTE_LANES_MASK = 0xF;
+
+// Bits for index 1 to 3 sit next to each other, index 1 on the highest one
+static inline uint32_t gteFlagMACPositive(uint32_t index) { return 1 << (31 - index); }
+static inline uint32_t gteFlagMACNegative(uint32_t index) { return 1 << (28 - index); }
+static inline uint32_t gteFlagIR(uint32_t index) { return 1 << (25 - index); }
+static inline uint32_t gteFlagRGB(uint32_t index) { return 1 << (22 - index); }
+
+/*
+Keeps MAC1-3 to 44bit, flagging the side any lane overflowed on.
+*/
+template <typename Lanes>
+static inline typename Lanes::WideType gteCalculateMAC(typename Lanes::WideType value, uint32_t index, uint32_t &flags) {
+    typename Lanes::WideType truncated = Lanes::truncate44(value);
+    uint32_t overflow = ~Lanes::signBitsWide(Lanes::equalWide(truncated, value)) & GTE_LANES_MASK;
+    uint32_t negative = Lanes::signBitsWide(value);
+    flags |= (overflow & ~negative) != 0 ? gteFlagMACPositive(index) : 0;
+    flags |= (overflow & negative) != 0 ? gteFlagMACNegative(index) : 0;
+    return truncated;
+}
+
+template <typename Lanes>
+static inline typename Lanes::Type gteSaturate(typename Lanes::Type value, int32_t minimum, int32_t maximum, uint32_t flag, uint32_t &flags) {
+    typename Lanes::Type saturated = Lanes::min(Lanes::max(value, Lanes::set(minimum)), Lanes::set(maximum));
+    flags |= (~Lanes::signBits(Lanes::equal(saturated, value)) & GTE_LANES_MASK) != 0 ? flag : 0;
+    return saturated;
+}
+
+template <typename Lanes>
+static inline typename Lanes::Type gteCalculateIR(typename Lanes::Type value, uint32_t index, bool lm, uint32_t &flags) {
+    return gteSaturate<Lanes>(value, lm ? 0 : -0x8000, 0x7FFF, gteFlagIR(index), flags);
+}
+
+// Division by a power of two rounding towards zero, like C does
+template <typename Lanes, int shift>
+static inline typename Lanes::Type gteDivideTowardZero(typename Lanes::Type value) {
+    typename Lanes::Type bias = Lanes::bitAnd(Lanes::template shiftRight<31>(value), Lanes::set((1 << shift) - 1));
+    return Lanes::template shiftRight<shift>(Lanes::add(value, bias));
+}
+
+// A matrix element times 16bit values never leaves 32bit, the sums they take part of do
+template <typename Lanes>
+static inline typename Lanes::WideType gteProduct(int32_t element, typename Lanes::Type value) {
+    return Lanes::widen(Lanes::multiply(Lanes::set(element), value));
+}
+
+/*
+Light matrix times the vectors, then background color plus light color matrix times the result.
+Shared by NCT, NCCT and NCDT.
+*/
+template <typename Lanes>
+static inline void gteLightVectors(const GTETripleVectorInput &input, typename Lanes::Type mac[3], typename Lanes::Type ir[3], uint32_t &flags) {
+    uint32_t shift = input.shiftFraction * 12;
+    typename Lanes::Type vx = Lanes::load(input.vx);
+    typename Lanes::Type vy = Lanes::load(input.vy);
+    typename Lanes::Type vz = Lanes::load(input.vz);
+    for (uint32_t row = 0; row < 3; row++) {
+        typename Lanes::WideType sum = Lanes::addWide(gteProduct<Lanes>(input.light[row][0], vx), gteProduct<Lanes>(input.light[row][1], vy));
+        sum = Lanes::addWide(sum, gteProduct<Lanes>(input.light[row][2], vz));
+        mac[row] = Lanes::narrow(Lanes::shiftRightWide(gteCalculateMAC<Lanes>(sum, row + 1, flags), shift));
+    }
+    for (uint32_t row = 0; row < 3; row++) {
+        ir[row] = gteCalculateIR<Lanes>(mac[row], row + 1, input.lm, flags);
+    }
+    for (uint32_t row = 0; row < 3; row++) {
+        typename Lanes::WideType sum = Lanes::setWide((int64_t)input.background[row] * 0x1000);
+        sum = gteCalculateMAC<Lanes>(Lanes::addWide(sum, gteProduct<Lanes>(input.lightColor[row][0], ir[0])), row + 1, flags);
+        sum = gteCalculateMAC<Lanes>(Lanes::addWide(sum, gteProduct<Lanes>(input.lightColor[row][1], ir[1])), row + 1, flags);
+        sum = gteCalculateMAC<Lanes>(Lanes::addWide(sum, gteProduct<Lanes>(input.lightColor[row][2], ir[2])), row + 1, flags);
+        mac[row] = Lanes::narrow(Lanes::shiftRightWide(sum, shift));
+    }
+    for (uint32_t row = 0; row < 3; row++) {
+        ir[row] = gteCalculateIR<Lanes>(mac[row], row + 1, input.lm, flags);
+    }
+}
+
+template <typename Lanes>
+static inline void gteStoreColors(const typename Lanes::Type mac[3], const typename Lanes::Type ir[3], GTETripleVectorOutput &output, uint32_t flags) {
+    for (uint32_t row = 0; row < 3; row++) {
+        Lanes::store(output.mac[row], mac[row]);
+        Lanes::store(output.ir[row], ir[row]);
+        Lanes::store(output.rgb[row], gteSaturate<Lanes>(Lanes::template shiftRight<4>(mac[row]), 0, 0xFF, gteFlagRGB(row + 1), flags));
+    }
+    output.flags = flags;
+}
+
+template <typename Lanes>
+static void gtePerspectiveTransformation(const GTETripleVectorInput &input, GTETripleVectorOutput &output) {
+    uint32_t flags = 0;
+    uint32_t shift = input.shiftFraction * 12;
+    typename Lanes::Type vx = Lanes::load(input.vx);
+    typename Lanes::Type vy = Lanes::load(input.vy);
+    typename Lanes::Type vz = Lanes::load(input.vz);
+    typename Lanes::Type mac[3];
+    typename Lanes::Type ir[3];
+    for (uint32_t row = 0; row < 3; row++) {
+        typename Lanes::WideType sum = Lanes::addWide(Lanes::setWide((int64_t)input.translation[row] * 0x1000), gteProduct<Lanes>(input.rotation[row][0], vx));
+        sum = Lanes::addWide(sum, gteProduct<Lanes>(input.rotation[row][1], vy));
+        sum = Lanes::addWide(sum, gteProduct<Lanes>(input.rotation[row][2], vz));
+        mac[row] = Lanes::narrow(gteCalculateMAC<Lanes>(Lanes::shiftRightWide(sum, shift), row + 1, flags));
+    }
+    for (uint32_t row = 0; row < 3; row++) {
+        ir[row] = gteCalculateIR<Lanes>(mac[row], row + 1, false, flags);
+        Lanes::store(output.mac[row], mac[row]);
+        Lanes::store(output.ir[row], ir[row]);
+    }
+    typename Lanes::Type sz = gteSaturate<Lanes>(Lanes::shiftRightBy(mac[2], (1 - input.shiftFraction) * 12), 0, 0xFFFF, GTE_FLAG_SZ3, flags);
+    Lanes::store(output.sz, sz);
+
+    // Unsigned Newton-Raphson division, see divideUNR in GTE.cpp. Lanes that overflow go through it
+    // as well, with zero divisors swapped so they still land in the table
+    typename Lanes::Type h = Lanes::set(input.h);
+    typename Lanes::Type fits = Lanes::greaterThan(Lanes::add(sz, sz), h);
+    flags |= (~Lanes::signBits(fits) & GTE_LANES_MASK) != 0 ? GTE_FLAG_DIVIDE_OVERFLOW : 0;
+    typename Lanes::Type divisor = Lanes::select(Lanes::equal(sz, Lanes::set(0)), Lanes::set(1), sz);
+    typename Lanes::Type z = Lanes::leadingZeros16(divisor);
+    typename Lanes::Type n = Lanes::shiftLeftBy(h, z);
+    typename Lanes::Type d = Lanes::shiftLeftBy(divisor, z);
+    typename Lanes::Type index = Lanes::template shiftRight<7>(Lanes::subtract(d, Lanes::set(0x7FC0)));
+    typename Lanes::Type u = Lanes::add(Lanes::lookup(GTE_UNR_TABLE.data(), index), Lanes::set(0x101));
+    d = Lanes::template shiftRight<8>(Lanes::subtract(Lanes::set(0x2000080), Lanes::multiply(d, u)));
+    d = Lanes::template shiftRight<8>(Lanes::add(Lanes::set(0x80), Lanes::multiply(d, u)));
+    typename Lanes::WideType quotient = Lanes::addWide(Lanes::multiplyWide(Lanes::widen(n), Lanes::widen(d)), Lanes::setWide(0x8000));
+    // Quotients of lanes that fit are below 20000h plus rounding, so they survive the narrowing
+    typename Lanes::Type divide = Lanes::min(Lanes::narrow(Lanes::shiftRightWide(quotient, 16)), Lanes::set(0x1FFFF));
+    typename Lanes::Type result = Lanes::select(fits, divide, Lanes::set(0x1FFFF));
+
+    typename Lanes::Type sx = Lanes::add(Lanes::multiply(result, ir[0]), Lanes::set(input.offsetX));
+    typename Lanes::Type sy = Lanes::add(Lanes::multiply(result, ir[1]), Lanes::set(input.offsetY));
+    Lanes::store(output.sx, gteSaturate<Lanes>(gteDivideTowardZero<Lanes, 16>(sx), -0x400, 0x3FF, GTE_FLAG_SX2, flags));
+    Lanes::store(output.sy, gteSaturate<Lanes>(gteDivideTowardZero<Lanes, 16>(sy), -0x400, 0x3FF, GTE_FLAG_SY2, flags));
+    typename Lanes::Type mac0 = Lanes::add(Lanes::multiply(result, Lanes::set(input.dqa)), Lanes::set(input.dqb));
+    Lanes::store(output.mac0, mac0);
+    Lanes::store(output.ir0, gteSaturate<Lanes>(gteDivideTowardZero<Lanes, 12>(mac0), 0, 0x1000, GTE_FLAG_IR0, flags));
+    output.flags = flags;
+}
+
+template <typename Lanes>
+static void gteNormalColor(const GTETripleVectorInput &input, GTETripleVectorOutput &output) {
+    uint32_t flags = 0;
+    typename Lanes::Type mac[3];
+    typename Lanes::Type ir[3];
+    gteLightVectors<Lanes>(input, mac, ir, flags);
+    gteStoreColors<Lanes>(mac, ir, output, flags);
+}
+
+template <typename Lanes>
+static void gteNormalColorColor(const GTETripleVectorInput &input, GTETripleVectorOutput &output) {
+    uint32_t flags = 0;
+    uint32_t shift = input.shiftFraction * 12;
+    typename Lanes::Type mac[3];
+    typename Lanes::Type ir[3];
+    gteLightVectors<Lanes>(input, mac, ir, flags);
+    for (uint32_t row = 0; row < 3; row++) {
+        typename Lanes::Type product = Lanes::template shiftLeft<4>(Lanes::multiply(Lanes::set(input.color[row]), ir[row]));
+        mac[row] = Lanes::shiftRightBy(product, shift);
+    }
+    for (uint32_t row = 0; row < 3; row++) {
+        ir[row] = gteCalculateIR<Lanes>(mac[row], row + 1, input.lm, flags);
+    }
+    gteStoreColors<Lanes>(mac, ir, output, flags);
+}
+
+template <typename Lanes>
+static void gteNormalColorDepthCue(const GTETripleVectorInput &input, GTETripleVectorOutput &output) {
+    uint32_t flags = 0;
+    uint32_t shift = input.shiftFraction * 12;
+    typename Lanes::Type mac[3];
+    typename Lanes::Type ir[3];
+    typename Lanes::Type color[3];
+    gteLightVectors<Lanes>(input, mac, ir, flags);
+    for (uint32_t row = 0; row < 3; row++) {
+        color[row] = Lanes::template shiftLeft<4>(Lanes::multiply(Lanes::set(input.color[row]), ir[row]));
+        typename Lanes::WideType difference = Lanes::subtractWide(Lanes::setWide((int64_t)input.farColor[row] * 0x1000), Lanes::widen(color[row]));
+        mac[row] = Lanes::narrow(Lanes::shiftRightWide(gteCalculateMAC<Lanes>(difference, row + 1, flags), shift));
+    }
+    for (uint32_t row = 0; row < 3; row++) {
+        ir[row] = gteCalculateIR<Lanes>(mac[row], row + 1, false, flags);
+    }
+    for (uint32_t row = 0; row < 3; row++) {
+        mac[row] = Lanes::shiftRightBy(Lanes::add(Lanes::multiply(ir[row], Lanes::set(input.ir0)), color[row]), shift);
+    }
+    for (uint32_t row = 0; row < 3; row++) {
+        ir[row] = gteCalculateIR<Lanes>(mac[row], row + 1, input.lm, flags);
+    }
+    gteStoreColors<Lanes>(mac, ir, output, flags);
+}
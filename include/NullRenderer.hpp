@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <vector>
+#include <filesystem>
+#include "Renderer.hpp"
+#include "Window.hpp"
+#include "Logger.hpp"
+
+class GPU;
+
+/*
+Renderer that draws nothing, for measuring how much of the time goes into the rest of the
+emulator. Primitives are only counted, while uploads, fills and copies are kept in a host copy of
+VRAM so reads from GPUREAD still see what was written to it.
+*/
+class NullRenderer : public Renderer {
+    Logger logger;
+    std::unique_ptr<Window> &mainWindow;
+    std::vector<uint16_t> vram;
+    Point2D displayAreaStart;
+    Dimensions screenResolution;
+    bool resizeToFitFramebuffer;
+
+    void countPrimitive(RendererPrimitiveType type, bool opaque, TextureBlendMode textureBlendMode);
+    void writeImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) override;
+public:
+    NullRenderer(std::unique_ptr<Window> &mainWindow, GPU *gpu);
+    ~NullRenderer() override;
+
+    void pushLine(std::vector<Vertex> vertices, bool opaque) override;
+    void pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) override;
+    void pushRectangle(RectangleInstance rectangle) override;
+    void setDrawingOffset(int16_t x, int16_t y) override;
+    void setSemiTransparencyMode(uint8_t mode) override;
+    void setDithering(bool enabled) override;
+    void setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) override;
+    void setMaskBitSetting(bool setMaskBit, bool checkMaskBit) override;
+    void prepareFrame() override;
+    void renderFrame(RendererFlushReason reason) override;
+    void finalizeFrame() override;
+    void skipFrame() override;
+    void updateWindowTitle(std::string title) override;
+    void loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) override;
+    void fillRectangle(Point2D topLeft, Dimensions size, uint16_t color) override;
+    void copyRectangle(Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit) override;
+    std::vector<uint16_t> readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) override;
+    void resetMainWindow() override;
+    void setDisplayAreaSart(Point2D point) override;
+    void setScreenResolution(Dimensions dimensions) override;
+    void setDrawingArea(Point2D topLeft, Dimensions size) override;
+    void toggleRenderPolygonOneByOne() override;
+    void startCapture(std::filesystem::path filePath) override;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <filesystem>
+#include "Renderer.hpp"
+#include "RendererProgram.hpp"
+#include "RendererBuffer.hpp"
+#include "Vertex.hpp"
+#include "GPUImageBuffer.hpp"
+#include "Texture.hpp"
+#include "PixelUnpackBuffer.hpp"
+#include "TextureCache.hpp"
+#include "ComputeRasterizer.hpp"
+#include "FrameCapture.hpp"
+#include "Window.hpp"
+#include "Logger.hpp"
+
+class GPU;
+
+class OpenGLRenderer : public Renderer {
+    Logger logger;
+    GLuint offsetUniform;
+    GLuint subtractiveBlendPassUniform;
+    GLuint rectangleOffsetUniform;
+    GLuint rectangleSubtractiveBlendPassUniform;
+
+    std::vector<Vertex> vertices;
+    std::vector<RectangleInstance> rectangles;
+
+    std::unique_ptr<Window> &mainWindow;
+
+    std::unique_ptr<RendererProgram> program;
+    std::unique_ptr<RendererBuffer<Vertex>> buffer;
+    std::unique_ptr<RendererProgram> rectangleProgram;
+    std::unique_ptr<RendererBuffer<RectangleInstance>> rectangleBuffer;
+
+    std::unique_ptr<PixelUnpackBuffer> unpackBuffer;
+    std::unique_ptr<Texture> loadImageTexture;
+    std::unique_ptr<TextureCache> textureCache;
+    bool useTextureCache;
+    std::unique_ptr<RendererProgram> textureRendererProgram;
+    std::unique_ptr<RendererBuffer<Point2D>> textureBuffer;
+
+    std::unique_ptr<Texture> screenTexture;
+    std::unique_ptr<Texture> downsampleTexture;
+    std::unique_ptr<RendererProgram> screenRendererProgram;
+    std::unique_ptr<RendererBuffer<Pixel>> screenBuffer;
+
+    std::unique_ptr<ComputeRasterizer> computeRasterizer;
+
+    std::unique_ptr<FrameCapture> frameCapture;
+
+    GLenum mode;
+    bool resizeToFitFramebuffer;
+    uint32_t resolutionScale;
+    Point2D drawingOffset;
+    GLint batchLeft;
+    GLint batchTop;
+    GLint batchRight;
+    GLint batchBottom;
+    Point2D displayAreaStart;
+    Dimensions screenResolution;
+    Point2D drawingAreaTopLeft;
+    Dimensions drawingAreaSize;
+    bool renderPolygonOneByOne;
+    uint32_t orderingIndex;
+    GLuint semiTransparencyMode;
+    bool subtractiveBlending;
+
+    void checkRenderPolygonOneByOne();
+    void checkForceDraw(unsigned int verticesToRender, GLenum newMode);
+    void applyScissor();
+    void checkSubtractiveBlending(bool subtractive, GLint left, GLint top, GLint right, GLint bottom);
+    void checkSubtractiveBlending(const std::vector<Vertex> &vertices, bool opaque);
+    void insertVertices(std::vector<Vertex> vertices, bool opaque);
+    GLint textureCacheLayerFor(Point2D texturePage, Point2D clut, GLuint textureDepthShift, TextureBlendMode textureBlendMode);
+    void assignTextureCacheLayer(std::vector<Vertex> &vertices, TextureBlendMode textureBlendMode);
+    void drawBatch();
+    void writeImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) override;
+public:
+    OpenGLRenderer(std::unique_ptr<Window> &mainWindow, GPU *gpu);
+    ~OpenGLRenderer() override;
+
+    void pushLine(std::vector<Vertex> vertices, bool opaque) override;
+    void pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) override;
+    void pushRectangle(RectangleInstance rectangle) override;
+    void setDrawingOffset(int16_t x, int16_t y) override;
+    void setSemiTransparencyMode(uint8_t mode) override;
+    void setDithering(bool enabled) override;
+    void setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) override;
+    void setMaskBitSetting(bool setMaskBit, bool checkMaskBit) override;
+    void prepareFrame() override;
+    void renderFrame(RendererFlushReason reason) override;
+    void finalizeFrame() override;
+    void skipFrame() override;
+    void updateWindowTitle(std::string title) override;
+    void loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) override;
+    void fillRectangle(Point2D topLeft, Dimensions size, uint16_t color) override;
+    std::vector<uint16_t> readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) override;
+    void resetMainWindow() override;
+    void setDisplayAreaSart(Point2D point) override;
+    void setScreenResolution(Dimensions dimensions) override;
+    void setDrawingArea(Point2D topLeft, Dimensions size) override;
+    void toggleRenderPolygonOneByOne() override;
+    void startCapture(std::filesystem::path filePath) override;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <deque>
+#include "GPUImageBuffer.hpp"
+#include "Logger.hpp"
+
+// Room for two full VRAM uploads in flight
+const GLsizeiptr PIXEL_UNPACK_BUFFER_SIZE = 2 * VRAM_SIZE * sizeof(uint16_t);
+
+struct PixelUnpackRegion {
+    GLintptr start;
+    GLintptr end;
+    GLsync fence;
+};
+
+/*
+Ring of persistently mapped pixel unpack buffer storage for VRAM uploads. Image data is copied in
+once and texture uploads source it from there, so the driver can transfer it to the texture in the
+background instead of copying client memory before glTexSubImage2D returns. Every region is
+fenced once the uploads reading it have been issued, and it is only written again after the fence
+signals.
+*/
+class PixelUnpackBuffer {
+    Logger logger;
+    GLuint object;
+    uint8_t *mapping;
+    GLintptr head;
+    GLintptr pendingStart;
+    std::deque<PixelUnpackRegion> regions;
+
+    void waitForRegions(GLintptr start, GLintptr end);
+public:
+    PixelUnpackBuffer();
+    ~PixelUnpackBuffer();
+
+    GLintptr upload(const void *data, GLsizeiptr size);
+    void release();
+};
@@ -4,9 +4,12 @@
 #include <filesystem>
 
 const uint32_t RAM_SIZE = 2*1024*1024;
+const uint32_t RAM_PAGE_SIZE = 4*1024;
 
 class RAM {
     uint8_t data[RAM_SIZE];
+    // Bumped on every write to the page, so cached views of RAM can tell they went stale
+    uint32_t pageGenerations[RAM_SIZE / RAM_PAGE_SIZE];
 public:
     RAM();
     ~RAM();
@@ -16,6 +19,8 @@ public:
     template <typename T>
     inline void store(uint32_t offset, T value);
 
+    const uint8_t* dataRef() const;
+    uint32_t pageGeneration(uint32_t page) const;
     void receiveTransfer(std::filesystem::path filePath, uint32_t origin, uint32_t size, uint32_t destination);
     void dump();
 };
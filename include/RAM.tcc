@@ -17,4 +17,5 @@ inline void RAM::store(uint32_t offset, T value) {
     for (uint8_t i = 0; i < sizeof(T); i++) {
         data[offset + i] = ((uint8_t)(((uint32_t)value) >> (i * 8)));
     }
+    pageGenerations[offset / RAM_PAGE_SIZE]++;
 }
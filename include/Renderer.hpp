@@ -1,67 +1,78 @@
 #pragma once
-#include <SDL2/SDL.h>
 #include <string>
 #include <memory>
 #include <vector>
-#include "RendererProgram.hpp"
-#include "RendererBuffer.hpp"
+#include <deque>
+#include <filesystem>
 #include "Vertex.hpp"
 #include "GPUImageBuffer.hpp"
-#include "Texture.hpp"
-#include "Window.hpp"
-#include "Logger.hpp"
+#include "RendererStatistics.hpp"
+#include "RendererBackend.hpp"
 
 class GPU;
+class Window;
 
+/*
+Interface between the GPU and the backend that draws into VRAM and presents it. Primitives are
+pushed with their vertices in VRAM coordinates before the drawing offset is applied, the backend
+decides how they are batched as long as they end up drawn in submission order. Fills are
+rectangles already aligned by the GPU that never wrap around VRAM, they are applied directly and
+only have to wait for pending primitives that draw to or are textured from the same area. Copies
+between two areas of VRAM honor the mask bit settings like the GPU does, and go through a readback
+and a write unless the backend has a faster way.
+Statistics are collected here so every backend reports them the same way, along with whether
+anything touched the presented part of VRAM since the last present, so unchanged frames don't have
+to be shown again.
+*/
 class Renderer {
-    Logger logger;
-    GLuint offsetUniform;
-    GLuint drawTransparentTextureBlendUniform;
+protected:
+    RendererStatistics frameStatistics;
+    RendererStatistics totalStatistics;
+    std::deque<RendererStatistics> statisticsHistory;
+    Point2D presentedAreaStart;
+    Dimensions presentedAreaSize;
+    bool presentedAreaDirty;
+    std::unique_ptr<GPUImageBuffer> copyBuffer;
 
-    std::vector<Vertex> opaqueVertices;
-    std::vector<Vertex> transparentVertices;
-
-    std::unique_ptr<Window> &mainWindow;
-
-    std::unique_ptr<RendererProgram> program;
-    std::unique_ptr<RendererBuffer<Vertex>> buffer;
-
-    std::unique_ptr<Texture> loadImageTexture;
-    std::unique_ptr<RendererProgram> textureRendererProgram;
-    std::unique_ptr<RendererBuffer<Point2D>> textureBuffer;
-
-    std::unique_ptr<Texture> screenTexture;
-    std::unique_ptr<RendererProgram> screenRendererProgram;
-    std::unique_ptr<RendererBuffer<Pixel>> screenBuffer;
+    virtual void writeImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) = 0;
+    void endFrameStatistics();
+    void setPresentedArea(Point2D displayAreaStart, Dimensions screenResolution, bool wholeVRAM);
+    void markVRAMWritten(Point2D topLeft, Dimensions size);
+    bool takePresentedAreaDirty();
+public:
+    Renderer();
+    virtual ~Renderer();
 
-    GLenum mode;
-    bool resizeToFitFramebuffer;
-    Point2D displayAreaStart;
-    Dimensions screenResolution;
-    Point2D drawingAreaTopLeft;
-    Dimensions drawingAreaSize;
-    bool renderPolygonOneByOne;
-    uint32_t orderingIndex;
+    static std::unique_ptr<Renderer> forBackend(RendererBackend backend, std::unique_ptr<Window> &mainWindow, GPU *gpu);
+    static std::vector<uint16_t> readVRAMRectangle(const uint16_t *vram, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+    static void copyVRAMRectangle(uint16_t *vram, Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit);
 
-    void checkRenderPolygonOneByOne();
-    void checkForceDraw(unsigned int verticesToRender, GLenum newMode);
-    void applyScissor();
-    void insertVertices(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode);
-public:
-    Renderer(std::unique_ptr<Window> &mainWindow, GPU *gpu);
-    ~Renderer();
+    virtual void pushLine(std::vector<Vertex> vertices, bool opaque) = 0;
+    virtual void pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) = 0;
+    virtual void pushRectangle(RectangleInstance rectangle) = 0;
+    virtual void setDrawingOffset(int16_t x, int16_t y) = 0;
+    virtual void setSemiTransparencyMode(uint8_t mode) = 0;
+    virtual void setDithering(bool enabled) = 0;
+    virtual void setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) = 0;
+    virtual void setMaskBitSetting(bool setMaskBit, bool checkMaskBit) = 0;
+    virtual void prepareFrame() = 0;
+    virtual void renderFrame(RendererFlushReason reason) = 0;
+    virtual void finalizeFrame() = 0;
+    virtual void skipFrame() = 0;
+    virtual void updateWindowTitle(std::string title) = 0;
+    virtual void loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) = 0;
+    virtual void fillRectangle(Point2D topLeft, Dimensions size, uint16_t color) = 0;
+    virtual void copyRectangle(Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit);
+    virtual std::vector<uint16_t> readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) = 0;
+    virtual void resetMainWindow() = 0;
+    virtual void setDisplayAreaSart(Point2D point) = 0;
+    virtual void setScreenResolution(Dimensions dimensions) = 0;
+    virtual void setDrawingArea(Point2D topLeft, Dimensions size) = 0;
+    virtual void toggleRenderPolygonOneByOne() = 0;
+    virtual void startCapture(std::filesystem::path filePath) = 0;
 
-    void pushLine(std::vector<Vertex> vertices, bool opaque);
-    void pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode);
-    void setDrawingOffset(int16_t x, int16_t y);
-    void prepareFrame();
-    void renderFrame();
-    void finalizeFrame();
-    void updateWindowTitle(std::string title);
-    void loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer);
-    void resetMainWindow();
-    void setDisplayAreaSart(Point2D point);
-    void setScreenResolution(Dimensions dimensions);
-    void setDrawingArea(Point2D topLeft, Dimensions size);
-    void toggleRenderPolygonOneByOne();
+    void countDisplayListPacket(RendererDisplayListPacket packet);
+    RendererStatistics getFrameStatistics();
+    RendererStatistics getTotalStatistics();
+    std::deque<RendererStatistics> getStatisticsHistory();
 };
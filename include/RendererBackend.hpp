@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+/*
+Renderer implementations that can be selected with the renderer setting.
+*/
+enum RendererBackend : uint8_t {
+    RendererBackendOpenGL = 0,
+    RendererBackendCompute = 1,
+    RendererBackendSoftware = 2,
+    RendererBackendNull = 3
+};
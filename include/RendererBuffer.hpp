@@ -6,7 +6,15 @@
 #include "RendererProgram.hpp"
 
 const uint32_t RENDERER_BUFFER_SIZE = 64*1024;
+// Batches that can be queued on the GPU before filling the next one waits for the oldest
+const uint32_t RENDERER_BUFFER_REGIONS = 3;
 
+/*
+Vertex buffer that batches are written to through a persistent mapping. It is split in regions of
+capacity elements used in turn, one per draw, so the next batch can be filled while the GPU still
+reads the previous ones. A fence after each draw guards its region, and is only waited on when
+the ring comes back around to it.
+*/
 template <class T>
 class RendererBuffer {
     std::unique_ptr<VertexArrayObject> vao;
@@ -14,8 +22,13 @@ class RendererBuffer {
     std::unique_ptr<RendererProgram> &program;
     unsigned int capacity;
     unsigned int size;
+    T *mapping;
+    unsigned int region;
+    GLsync fences[RENDERER_BUFFER_REGIONS];
 
     void enableAttributes() const;
+    void waitForRegion();
+    void finishDraw();
 public:
     RendererBuffer(std::unique_ptr<RendererProgram> &program, unsigned int capacity);
     ~RendererBuffer();
@@ -23,6 +36,7 @@ public:
     void bind() const;
     void clean();
     void draw(GLenum mode);
+    void drawInstances(GLenum mode, GLsizei verticesPerInstance);
     void addData(std::vector<T> data);
     unsigned int remainingCapacity();
 };
@@ -2,15 +2,30 @@
 #include <glad/glad.h>
 #include <string>
 #include <vector>
+#include <utility>
+#include <filesystem>
+#include "Logger.hpp"
 
+/*
+Linked programs are cached on disk with glGetProgramBinary, keyed by a hash of the shader sources
+and the driver strings. A missing, stale or rejected binary falls back to compiling the sources
+and replaces the cached one.
+*/
 class RendererProgram {
+    Logger logger;
     GLuint program;
 
     std::string openShaderSource(std::string filePath) const;
-    GLuint compileShader(std::string filePath, GLenum shaderType) const;
+    GLuint compileShader(const std::string &source, GLenum shaderType) const;
     GLuint linkProgram(std::vector<GLuint> shaders) const;
+    void buildProgram(const std::vector<std::pair<GLenum, std::string>> &stages);
+    uint64_t programCacheKey(const std::vector<std::pair<GLenum, std::string>> &stages) const;
+    std::filesystem::path programCachePath(uint64_t key) const;
+    GLuint loadProgramBinary(uint64_t key) const;
+    void storeProgramBinary(uint64_t key) const;
 public:
     RendererProgram(std::string vertexShaderSrcPath, std::string fragmentShaderSrcPath);
+    RendererProgram(std::string computeShaderSrcPath);
     ~RendererProgram();
 
     void useProgram() const;
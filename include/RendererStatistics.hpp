@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <array>
+
+const uint32_t RENDERER_STATISTICS_HISTORY_SIZE = 120;
+
+enum RendererFlushReason {
+    RendererFlushReasonFrameEnd = 0,
+    RendererFlushReasonBufferFull,
+    RendererFlushReasonModeChange,
+    RendererFlushReasonDrawingArea,
+    RendererFlushReasonDrawingOffset,
+    RendererFlushReasonTextureCacheFull,
+    RendererFlushReasonVRAMRead,
+    RendererFlushReasonVRAMWrite,
+    RendererFlushReasonTextureRead,
+    RendererFlushReasonVRAMFill,
+    RendererFlushReasonPolygonOneByOne,
+    RendererFlushReasonSubtractiveBlending,
+    RendererFlushReasonCount
+};
+
+// How the display list cache handled a GPU linked-list packet
+enum RendererDisplayListPacket {
+    RendererDisplayListPacketHit = 0,
+    RendererDisplayListPacketMiss,
+    RendererDisplayListPacketUncacheable,
+    RendererDisplayListPacketCount
+};
+
+enum RendererPrimitiveType {
+    RendererPrimitiveTypeTriangle = 0,
+    RendererPrimitiveTypeQuad,
+    RendererPrimitiveTypeLine,
+    RendererPrimitiveTypeCount
+};
+
+/*
+Counters collected by the renderer, either for a single frame or accumulated over a whole run.
+Flushes only count batches that had something to draw.
+*/
+struct RendererStatistics {
+    std::array<uint64_t, RendererPrimitiveTypeCount> primitives;
+    uint64_t texturedPrimitives;
+    uint64_t semiTransparentPrimitives;
+    uint64_t verticesUploaded;
+    uint64_t bytesUploaded;
+    uint64_t drawCalls;
+    std::array<uint64_t, RendererFlushReasonCount> flushes;
+    uint64_t vramUploads;
+    uint64_t vramUploadBytes;
+    uint64_t vramFills;
+    uint64_t vramCopies;
+    uint64_t skippedFrames;
+    uint64_t unchangedFrames;
+    std::array<uint64_t, RendererDisplayListPacketCount> displayListPackets;
+
+    RendererStatistics();
+    uint64_t totalPrimitives() const;
+    uint64_t totalFlushes() const;
+    void add(const RendererStatistics &other);
+    static const char* flushReasonName(RendererFlushReason reason);
+    static const char* primitiveTypeName(RendererPrimitiveType type);
+    static const char* displayListPacketName(RendererDisplayListPacket packet);
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <array>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "GPUImageBuffer.hpp"
+#include "Vertex.hpp"
+#include "SoftwareSpan.hpp"
+#include "Logger.hpp"
+
+const uint32_t SOFTWARE_RASTERIZER_CAPACITY = 16*1024;
+const uint32_t SOFTWARE_RASTERIZER_MAX_WORKERS = 16;
+const int32_t SOFTWARE_RASTERIZER_BAND_HEIGHT = 16;
+// Batches covering fewer pixels than this are drawn on the calling thread alone
+const uint64_t SOFTWARE_RASTERIZER_PARALLEL_THRESHOLD = 8*1024;
+const int32_t SOFTWARE_RASTERIZER_TILE_WIDTH = 64;
+const int32_t SOFTWARE_RASTERIZER_TILE_HEIGHT = 32;
+
+// One bit per tile of VRAM, a halfword per row of tiles
+typedef std::array<uint16_t, VRAM_HEIGHT / SOFTWARE_RASTERIZER_TILE_HEIGHT> SoftwareTileMask;
+
+/*
+A primitive already offset, clipped and set up, ready to be rasterized over any range of rows.
+Lines only use the first two vertices, with their start color in base and the difference to
+their end color in the first row of delta.
+*/
+struct SoftwarePrimitive {
+    bool line;
+    SoftwareSpan span;
+    int32_t x[3], y[3];
+    int32_t left, top, right, bottom;
+    int64_t area;
+    int64_t edgeStepX[3];
+    int64_t edgeBias[3];
+    // r, g, b, u and v of the first vertex, and relative to it for the other two
+    int64_t base[5];
+    int64_t delta[2][5];
+};
+
+/*
+Draws primitives on the CPU into a host copy of VRAM, following the same rules as the compute
+rasterizer: integer edge functions with a top-left fill rule, the GPU dither matrix, texture
+windows, CLUT lookups, the mask bit and the four 15bit semi-transparency modes. Triangles are
+walked row by row, each row is clipped analytically against the three edges and then shaded by
+a span loop that is picked once at startup, AVX2 or SSE4.1 when the host supports them.
+
+Primitives are batched until flushed. The rows of VRAM are split in bands of
+SOFTWARE_RASTERIZER_BAND_HEIGHT rows dealt round robin to the workers, each worker walks the
+whole batch in submission order but only draws the rows of its own bands, so every pixel is
+still written by a single thread in the same order as if the batch was drawn by one. Texture
+reads are the exception since they can cross bands, so the tiles of VRAM a batch draws to and
+reads textures from are tracked and a primitive that would make a band depend on another one
+has to go into a new batch, see conflictsWithBatch.
+*/
+class SoftwareRasterizer {
+    Logger logger;
+    std::vector<uint16_t> vram;
+    SoftwareSpanKernel kernel;
+
+    Point2D drawingOffset;
+    Point2D drawingAreaTopLeft;
+    Dimensions drawingAreaSize;
+    uint32_t semiTransparencyMode;
+    bool dithering;
+    bool setMaskBit;
+    bool checkMaskBit;
+    uint8_t textureWindowMaskX;
+    uint8_t textureWindowMaskY;
+    uint8_t textureWindowOffsetX;
+    uint8_t textureWindowOffsetY;
+
+    std::vector<SoftwarePrimitive> primitives;
+    int32_t batchTop;
+    int32_t batchBottom;
+    SoftwareTileMask batchWrites;
+    SoftwareTileMask batchReads;
+    uint64_t batchPixels;
+    bool batchSerial;
+
+    uint32_t workerCount;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workFinished;
+    uint64_t generation;
+    uint32_t activeWorkers;
+    uint32_t pendingWorkers;
+    bool stopping;
+
+    SoftwareSpan spanFor(const Vertex &vertex, bool opaque, bool shaded);
+    void markWrites(SoftwareTileMask &tiles, const int32_t *x, const int32_t *y, uint32_t count) const;
+    void pushPrimitive(SoftwarePrimitive &primitive);
+    void pushTriangle(const Vertex &first, const Vertex &second, const Vertex &third, bool opaque, bool shaded);
+    void rasterizeTriangle(const SoftwarePrimitive &primitive, int32_t top, int32_t bottom) const;
+    void rasterizeLine(const SoftwarePrimitive &primitive, int32_t top, int32_t bottom) const;
+    void rasterizeBands(uint32_t worker, uint32_t stride) const;
+    void workerLoop(uint32_t worker);
+public:
+    SoftwareRasterizer(uint32_t workerCount);
+    ~SoftwareRasterizer();
+
+    const char* kernelName() const;
+    uint32_t getWorkerCount() const;
+    uint32_t remainingCapacity() const;
+    bool isEmpty() const;
+    bool conflictsWithBatch(const std::vector<Vertex> &vertices) const;
+    bool conflictsWithBatch(Point2D topLeft, Dimensions size) const;
+    uint32_t flush();
+    void pushLine(const Vertex &start, const Vertex &end, bool opaque);
+    void pushPolygon(const std::vector<Vertex> &vertices, bool opaque);
+    void setDrawingOffset(int16_t x, int16_t y);
+    void setDrawingArea(Point2D topLeft, Dimensions size);
+    void setSemiTransparencyMode(uint32_t mode);
+    void setDithering(bool enabled);
+    void setMaskBitSetting(bool setMaskBit, bool checkMaskBit);
+    void setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY);
+    void writeVRAM(std::unique_ptr<GPUImageBuffer> &imageBuffer);
+    void fillVRAM(Point2D topLeft, Dimensions size, uint16_t color);
+    void copyVRAM(Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit);
+    std::vector<uint16_t> readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) const;
+    const uint16_t* vramRef() const;
+};
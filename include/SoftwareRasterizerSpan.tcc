@@ -0,0 +1,171 @@
+#pragma once
+#include "SoftwareSpan.hpp"
+
+/*
+The span loop shared by every instruction set. Each translation unit that includes this file
+provides a Lanes type wrapping its vector register (a plain int32_t for the scalar build) with
+static helpers over 32bit lanes, and gets its own internal copy of the loop.
+
+24bit to 15bit Dither Pattern
+The dither pattern is added to the lower 3bit of the 8bit color values, prior to
+stripping the lower 3bit
+  -4  +0  -3  +1   ;\Dither offsets for first two scanlines
+  +2  -2  +3  -1   ;/
+  -3  +1  -4  +0   ;\Dither offsets for next two scanlines
+  +3  -1  +2  -2   ;/(same as above, but shifted two pixels horizontally)
+*/
+static const int32_t SOFTWARE_SPAN_DITHER_TABLE[4][4] = {
+    { -4, 0, -3, 1 },
+    { 2, -2, 3, -1 },
+    { -3, 1, -4, 0 },
+    { 3, -1, 2, -2 }
+};
+
+static inline uint16_t softwareSpanVRAMAt(const uint16_t *vram, int32_t x, int32_t y) {
+    return vram[(y & (SOFTWARE_SPAN_VRAM_HEIGHT - 1)) * SOFTWARE_SPAN_VRAM_WIDTH + (x & (SOFTWARE_SPAN_VRAM_WIDTH - 1))];
+}
+
+static inline int32_t softwareSpanTexelAt(const SoftwareSpan &span, int32_t u, int32_t v) {
+    u &= 0xff;
+    v &= 0xff;
+    // Texel = (Texel AND (NOT (Mask*8))) OR ((Offset AND Mask)*8)
+    u = (u & ~(span.textureWindowMaskX * 8)) | ((span.textureWindowOffsetX & span.textureWindowMaskX) * 8);
+    v = (v & ~(span.textureWindowMaskY * 8)) | ((span.textureWindowOffsetY & span.textureWindowMaskY) * 8);
+    uint32_t depthShift = span.textureDepthShift;
+    if (depthShift == 0) {
+        return softwareSpanVRAMAt(span.vram, span.texturePageX + u, span.texturePageY + v);
+    }
+    uint32_t halfword = softwareSpanVRAMAt(span.vram, span.texturePageX + (u >> depthShift), span.texturePageY + v);
+    uint32_t bitsPerPixel = 16 >> depthShift;
+    uint32_t alignMask = (1 << depthShift) - 1;
+    uint32_t index = (halfword >> ((u & alignMask) * bitsPerPixel)) & ((1 << bitsPerPixel) - 1);
+    return softwareSpanVRAMAt(span.vram, span.clutX + index, span.clutY);
+}
+
+template <typename Lanes>
+static inline typename Lanes::Type softwareSpanInterpolate(int32_t start, int32_t step, typename Lanes::Type index) {
+    return Lanes::template shiftRight<16>(Lanes::add(Lanes::set(start), Lanes::multiply(index, Lanes::set(step))));
+}
+
+template <typename Lanes>
+static inline typename Lanes::Type softwareSpanClampColor(typename Lanes::Type value) {
+    return Lanes::template shiftRight<3>(Lanes::min(Lanes::max(value, Lanes::set(0)), Lanes::set(255)));
+}
+
+template <typename Lanes>
+static inline typename Lanes::Type softwareSpanBlend(typename Lanes::Type background, typename Lanes::Type foreground, uint32_t mode) {
+    switch (mode) {
+        case 0: {
+            return Lanes::template shiftRight<1>(Lanes::add(background, foreground));
+        }
+        case 1: {
+            return Lanes::min(Lanes::add(background, foreground), Lanes::set(31));
+        }
+        case 2: {
+            return Lanes::max(Lanes::subtract(background, foreground), Lanes::set(0));
+        }
+        default: {
+            return Lanes::min(Lanes::add(background, Lanes::template shiftRight<2>(foreground)), Lanes::set(31));
+        }
+    }
+}
+
+/*
+Shades Lanes::WIDTH pixels at a time. Texels are fetched one lane at a time since their address
+depends on the CLUT and texture window, everything else (interpolation, dithering, modulation,
+blending and the mask bit) is done on all lanes at once. The last partial chunk goes through a
+small buffer so that no lane ever touches VRAM outside of the span.
+*/
+template <typename Lanes>
+static void shadeSpanLanes(const SoftwareSpan &span) {
+    typedef typename Lanes::Type Vector;
+    const int32_t width = Lanes::WIDTH;
+    alignas(32) int32_t lanesU[Lanes::WIDTH];
+    alignas(32) int32_t lanesV[Lanes::WIDTH];
+    alignas(32) int32_t lanesTexel[Lanes::WIDTH];
+    alignas(32) int32_t lanesDither[Lanes::WIDTH];
+    uint16_t tail[Lanes::WIDTH];
+    uint16_t *row = span.vram + span.y * SOFTWARE_SPAN_VRAM_WIDTH;
+    const int32_t *ditherRow = SOFTWARE_SPAN_DITHER_TABLE[span.y & 3];
+    const bool textured = span.textureBlendMode != 0;
+    const bool rawTexture = span.textureBlendMode == 1;
+    const Vector zero = Lanes::set(0);
+    const Vector colorMask = Lanes::set(0x1f);
+    const Vector maskBit = Lanes::set(0x8000);
+    for (int32_t i = 0; i < span.length; i += width) {
+        int32_t x = span.x + i;
+        int32_t count = span.length - i < width ? span.length - i : width;
+        uint16_t *pixels = row + x;
+        if (count < width) {
+            for (int32_t lane = 0; lane < width; lane++) {
+                tail[lane] = lane < count ? pixels[lane] : 0;
+            }
+            pixels = tail;
+        }
+        Vector index = Lanes::add(Lanes::ramp(), Lanes::set(i));
+        Vector background = Lanes::loadPixels(pixels);
+        Vector dither = zero;
+        if (span.dither) {
+            for (int32_t lane = 0; lane < width; lane++) {
+                lanesDither[lane] = ditherRow[(x + lane) & 3];
+            }
+            dither = Lanes::load(lanesDither);
+        }
+        Vector red = softwareSpanInterpolate<Lanes>(span.r, span.stepR, index);
+        Vector green = softwareSpanInterpolate<Lanes>(span.g, span.stepG, index);
+        Vector blue = softwareSpanInterpolate<Lanes>(span.b, span.stepB, index);
+        Vector keep = zero;
+        Vector mask = zero;
+        Vector semiTransparent = span.semiTransparent ? Lanes::set(-1) : zero;
+        if (!textured) {
+            red = softwareSpanClampColor<Lanes>(Lanes::add(red, dither));
+            green = softwareSpanClampColor<Lanes>(Lanes::add(green, dither));
+            blue = softwareSpanClampColor<Lanes>(Lanes::add(blue, dither));
+        } else {
+            Lanes::store(lanesU, softwareSpanInterpolate<Lanes>(span.u, span.stepU, index));
+            Lanes::store(lanesV, softwareSpanInterpolate<Lanes>(span.v, span.stepV, index));
+            for (int32_t lane = 0; lane < width; lane++) {
+                lanesTexel[lane] = softwareSpanTexelAt(span, lanesU[lane], lanesV[lane]);
+            }
+            Vector texel = Lanes::load(lanesTexel);
+            // Texel 0000h is fully transparent
+            keep = Lanes::equal(texel, zero);
+            Vector texelRed = Lanes::bitAnd(texel, colorMask);
+            Vector texelGreen = Lanes::bitAnd(Lanes::template shiftRight<5>(texel), colorMask);
+            Vector texelBlue = Lanes::bitAnd(Lanes::template shiftRight<10>(texel), colorMask);
+            if (rawTexture) {
+                red = texelRed;
+                green = texelGreen;
+                blue = texelBlue;
+            } else {
+                red = softwareSpanClampColor<Lanes>(Lanes::add(Lanes::template shiftRight<7>(Lanes::multiply(Lanes::template shiftLeft<3>(texelRed), red)), dither));
+                green = softwareSpanClampColor<Lanes>(Lanes::add(Lanes::template shiftRight<7>(Lanes::multiply(Lanes::template shiftLeft<3>(texelGreen), green)), dither));
+                blue = softwareSpanClampColor<Lanes>(Lanes::add(Lanes::template shiftRight<7>(Lanes::multiply(Lanes::template shiftLeft<3>(texelBlue), blue)), dither));
+            }
+            mask = Lanes::bitAnd(texel, maskBit);
+            // Textured primitives are only semi-transparent where the texel has bit 15 set
+            semiTransparent = Lanes::bitAnd(semiTransparent, Lanes::equal(mask, maskBit));
+        }
+        if (span.semiTransparent) {
+            Vector backgroundRed = Lanes::bitAnd(background, colorMask);
+            Vector backgroundGreen = Lanes::bitAnd(Lanes::template shiftRight<5>(background), colorMask);
+            Vector backgroundBlue = Lanes::bitAnd(Lanes::template shiftRight<10>(background), colorMask);
+            red = Lanes::select(semiTransparent, softwareSpanBlend<Lanes>(backgroundRed, red, span.semiTransparencyMode), red);
+            green = Lanes::select(semiTransparent, softwareSpanBlend<Lanes>(backgroundGreen, green, span.semiTransparencyMode), green);
+            blue = Lanes::select(semiTransparent, softwareSpanBlend<Lanes>(backgroundBlue, blue, span.semiTransparencyMode), blue);
+        }
+        if (span.setMaskBit) {
+            mask = maskBit;
+        }
+        if (span.checkMaskBit) {
+            keep = Lanes::bitOr(keep, Lanes::equal(Lanes::bitAnd(background, maskBit), maskBit));
+        }
+        Vector pixel = Lanes::bitOr(Lanes::bitOr(red, Lanes::template shiftLeft<5>(green)), Lanes::bitOr(Lanes::template shiftLeft<10>(blue), mask));
+        Lanes::storePixels(pixels, Lanes::select(keep, background, pixel));
+        if (count < width) {
+            for (int32_t lane = 0; lane < count; lane++) {
+                row[x + lane] = tail[lane];
+            }
+        }
+    }
+}
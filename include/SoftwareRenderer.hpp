@@ -0,0 +1,67 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <filesystem>
+#include "Renderer.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "FrameCapture.hpp"
+#include "Window.hpp"
+#include "Logger.hpp"
+
+class GPU;
+
+/*
+Renderer for hosts without a usable OpenGL driver. Primitives are batched and drawn by the
+SoftwareRasterizer into a host copy of VRAM on a pool of threads, which is uploaded every frame
+into a streaming SDL texture (15bit, same layout as VRAM) and presented with SDL's 2D renderer.
+*/
+class SoftwareRenderer : public Renderer {
+    Logger logger;
+    std::unique_ptr<Window> &mainWindow;
+    std::unique_ptr<SoftwareRasterizer> rasterizer;
+    std::unique_ptr<FrameCapture> frameCapture;
+
+    SDL_Renderer *sdlRenderer;
+    SDL_Texture *sdlTexture;
+
+    bool resizeToFitFramebuffer;
+    Point2D displayAreaStart;
+    Dimensions screenResolution;
+    Point2D drawingAreaTopLeft;
+    Dimensions drawingAreaSize;
+    bool renderPolygonOneByOne;
+
+    void checkRenderPolygonOneByOne();
+    void captureFrame();
+    void presentFrame();
+    void writeImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) override;
+public:
+    SoftwareRenderer(std::unique_ptr<Window> &mainWindow, GPU *gpu);
+    ~SoftwareRenderer() override;
+
+    void pushLine(std::vector<Vertex> vertices, bool opaque) override;
+    void pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) override;
+    void pushRectangle(RectangleInstance rectangle) override;
+    void setDrawingOffset(int16_t x, int16_t y) override;
+    void setSemiTransparencyMode(uint8_t mode) override;
+    void setDithering(bool enabled) override;
+    void setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) override;
+    void setMaskBitSetting(bool setMaskBit, bool checkMaskBit) override;
+    void prepareFrame() override;
+    void renderFrame(RendererFlushReason reason) override;
+    void finalizeFrame() override;
+    void skipFrame() override;
+    void updateWindowTitle(std::string title) override;
+    void loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) override;
+    void fillRectangle(Point2D topLeft, Dimensions size, uint16_t color) override;
+    void copyRectangle(Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit) override;
+    std::vector<uint16_t> readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) override;
+    void resetMainWindow() override;
+    void setDisplayAreaSart(Point2D point) override;
+    void setScreenResolution(Dimensions dimensions) override;
+    void setDrawingArea(Point2D topLeft, Dimensions size) override;
+    void toggleRenderPolygonOneByOne() override;
+    void startCapture(std::filesystem::path filePath) override;
+};
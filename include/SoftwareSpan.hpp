@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+// The span loops are built once per instruction set, so this header stays free of anything
+// that could end up compiled with instructions the host does not support
+const int32_t SOFTWARE_SPAN_VRAM_WIDTH = 1024;
+const int32_t SOFTWARE_SPAN_VRAM_HEIGHT = 512;
+
+/*
+Everything the span loops need to shade one row of a primitive. Interpolated values are 16.16
+fixed point, given at the first pixel of the span along with their per pixel step.
+*/
+struct SoftwareSpan {
+    uint16_t *vram;
+    int32_t x;
+    int32_t y;
+    int32_t length;
+    int32_t r, g, b, u, v;
+    int32_t stepR, stepG, stepB, stepU, stepV;
+    uint32_t textureBlendMode;
+    uint32_t textureDepthShift;
+    int32_t texturePageX, texturePageY;
+    int32_t clutX, clutY;
+    int32_t textureWindowMaskX, textureWindowMaskY;
+    int32_t textureWindowOffsetX, textureWindowOffsetY;
+    uint32_t semiTransparencyMode;
+    bool semiTransparent;
+    bool dither;
+    bool setMaskBit;
+    bool checkMaskBit;
+};
+
+typedef void (*SoftwareSpanKernel)(const SoftwareSpan &span);
+
+void shadeSpanScalar(const SoftwareSpan &span);
+SoftwareSpanKernel softwareSpanKernelSSE41();
+SoftwareSpanKernel softwareSpanKernelAVX2();
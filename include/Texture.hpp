@@ -18,5 +18,5 @@ public:
     GLsizei getWidth();
     GLsizei getHeight();
     void bind(GLenum texture);
-    void setImageFromBuffer(std::unique_ptr<GPUImageBuffer> &imageBuffer);
+    void setImageFromBuffer(std::unique_ptr<GPUImageBuffer> &imageBuffer, GLintptr unpackOffset);
 };
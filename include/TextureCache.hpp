@@ -0,0 +1,51 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory>
+#include <array>
+#include <vector>
+#include "GPUImageBuffer.hpp"
+#include "Vertex.hpp"
+#include "Logger.hpp"
+
+const uint32_t TEXTURE_CACHE_PAGE_SIZE = 256;
+const uint32_t TEXTURE_CACHE_CAPACITY = 64;
+
+struct TextureCacheEntry {
+    Point2D texturePage;
+    Point2D clut;
+    GLuint textureDepthShift;
+    bool valid;
+    uint64_t lastUsed;
+    uint64_t lastBatch;
+
+    TextureCacheEntry();
+    bool matches(Point2D texturePage, Point2D clut, GLuint textureDepthShift) const;
+    bool overlaps(uint16_t x, uint16_t y, uint16_t width, uint16_t height) const;
+};
+
+/*
+Paletted (4bit and 8bit) texture pages decoded into RGBA5551 layers of a texture array, keyed by
+texture page, CLUT and color depth. The cache keeps a shadow copy of the VRAM contents uploaded
+through GP0(A0h), which is the only source the fragment shader samples textures from, and uses
+it both to decode pages and to invalidate the layers touched by later uploads.
+*/
+class TextureCache {
+    Logger logger;
+    GLuint object;
+    std::vector<uint16_t> vram;
+    std::vector<uint16_t> decodeBuffer;
+    std::array<TextureCacheEntry, TEXTURE_CACHE_CAPACITY> entries;
+    uint64_t useCounter;
+    uint64_t batch;
+
+    void decode(GLint layer);
+public:
+    TextureCache();
+    ~TextureCache();
+
+    void bind(GLenum texture);
+    void nextBatch();
+    GLint layerFor(Point2D texturePage, Point2D clut, GLuint textureDepthShift);
+    void writeVRAM(std::unique_ptr<GPUImageBuffer> &imageBuffer);
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <glad/glad.h>
+#include <vector>
 
 union Dimensions {
     struct {
@@ -18,6 +19,7 @@ struct Point2D {
     Point2D();
     Point2D(GLshort x, GLshort y);
     Point2D(uint32_t position);
+    static Point2D forVertexPosition(uint32_t position);
     static Point2D forTexturePosition(uint16_t position);
     static Point2D forTexturePage(uint32_t texturePage);
     static Point2D forClut(uint16_t clutData);
@@ -43,6 +45,9 @@ enum TextureBlendMode {
     TextureBlendModeTextureBlend
 };
 
+// GP0(E1h).5-6 Semi Transparency (0=B/2+F/2, 1=B+F, 2=B-F, 3=B+F/4)
+const GLuint SEMI_TRANSPARENCY_SUBTRACT = 2;
+
 struct Vertex {
     Point3D point;
     Color color;
@@ -52,12 +57,38 @@ struct Vertex {
     Point2D texturePage;
     GLuint textureDepthShift;
     Point2D clut;
+    GLint textureCacheLayer;
+    GLuint semiTransparency;
 
     Vertex(Point3D point, Color color, GLuint opaque);
     Vertex(Point3D point, Color color, GLuint opaque, Point2D texturePosition, TextureBlendMode textureBlendMode, Point2D texturePage, GLuint textureDepthShift, Point2D clut);
     ~Vertex();
 };
 
+/*
+GP0 rectangles and sprites as a single record, expanded into their four corners in the vertex
+shader instead of uploading two triangles of full vertices.
+*/
+struct RectangleInstance {
+    Point2D point;
+    Point2D size;
+    Point2D texturePosition;
+    Point2D texturePage;
+    Point2D clut;
+    Color color;
+    GLubyte transparent;
+    GLubyte textureBlendMode;
+    GLubyte textureDepthShift;
+    GLubyte semiTransparency;
+    GLint textureCacheLayer;
+
+    RectangleInstance(Point2D point, Dimensions size, Color color, GLuint opaque);
+    RectangleInstance(Point2D point, Dimensions size, Color color, GLuint opaque, Point2D texturePosition, TextureBlendMode textureBlendMode, Point2D texturePage, GLuint textureDepthShift, Point2D clut);
+    ~RectangleInstance();
+
+    std::vector<Vertex> vertices() const;
+};
+
 struct Pixel {
     GLfloat pointX;
     GLfloat pointY;
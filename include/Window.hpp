@@ -2,6 +2,7 @@
 #include <SDL2/SDL.h>
 #include <string>
 #include <cstdint>
+#include <glad/glad.h>
 #include <Vertex.hpp>
 #include "Logger.hpp"
 
@@ -15,15 +16,28 @@ class Window {
     SDL_Window *window;
     uint32_t windowID;
     bool hidden;
+    bool exposed;
+    bool headless;
+    bool openGL;
+    void *eglDisplay;
+    void *eglSurface;
+    void *eglContext;
+
+    void setupHeadlessContext();
 public:
-    Window(bool mainWindow, std::string title, uint32_t width, uint32_t height, bool hidden);
+    Window(bool mainWindow, std::string title, uint32_t width, uint32_t height, bool hidden, bool openGL);
+    Window(std::string title, uint32_t width, uint32_t height, bool openGL);
     ~Window();
 
     SDL_Window* getWindowRef();
     SDL_GLContext getGLContext();
+    GLADloadproc getProcAddressLoader();
+    bool isHeadless();
+    bool hasOpenGLContext();
     void makeCurrent();
     Dimensions getDimensions();
     void handleSDLEvent(SDL_Event event);
     bool isHidden();
     void toggleHidden();
+    bool takeExposed();
 };
@@ -20,7 +20,8 @@ CPU::CPU(LogLevel logLevel, unique_ptr<Interconnect> &interconnect, unique_ptr<C
              currentInstruction(Instruction(0x0)),
              logBiosFunctionCalls(logBiosFunctionCalls),
              gte(gte),
-             interruptController(interruptController)
+             interruptController(interruptController),
+             fusedInstructions(0)
 {
     fill_n(registers, 32, 0);
 }
@@ -109,7 +110,25 @@ void CPU::handleInterrupts() {
     }
 }
 
+/*
+Whether handleInterrupts would take an interrupt right now, counting requests the interrupt
+controller raised since CAUSE was last updated.
+*/
+bool CPU::isInterruptPending() const {
+    uint32_t interruptPending = cop0->cause.interruptPending;
+    if (interruptController->areInterruptsPending()) {
+        interruptPending |= 0x4;
+    }
+    return (interruptPending & cop0->status.interrurptMask) && cop0->status.currentInterruptEnable;
+}
+
 bool CPU::executeNextInstruction() {
+    // Steps for instructions a fused GTE sequence already ran
+    if (fusedInstructions > 0) {
+        fusedInstructions--;
+        return true;
+    }
+
     if (cop0->breakPointControl & (1 << 24) && programCounter == cop0->breakPointOnExecute) {
         cop0->breakPointControl  &= ~(1 << 24);
         return false;
@@ -1118,7 +1137,7 @@ void CPU::operationCoprocessor2(Instruction instruction) {
             break;
         }
         case 0x10: {
-            gte->execute(instruction.value);
+            executeCoprocessor2Commands(instruction);
             break;
         }
         default: {
@@ -1127,6 +1146,52 @@ void CPU::operationCoprocessor2(Instruction instruction) {
     }
 }
 
+/*
+Hands the GTE command over along with the ones right after it, allowing the couple of NOPs the
+PsyQ GTE macros put in between, so the GTE can fuse sequences like RTPT, NCLIP, AVSZ3. The
+instructions it ran ahead of time then take up the following steps without doing anything, so
+the rest of the system is stepped the same. Never looks ahead from a delay slot, while the
+program counter is being watched, or while an interrupt is pending, so its handler sees the GTE
+and EPC as the commands run one at a time would leave them.
+*/
+void CPU::executeCoprocessor2Commands(Instruction instruction) {
+    Debugger *debugger = Debugger::getInstance();
+    if (isBranching || debugger->isAttached() || (cop0->breakPointControl & (1 << 24)) || isInterruptPending()) {
+        gte->execute(instruction.value);
+        return;
+    }
+    uint32_t commands[CPU_GTE_SEQUENCE_MAXIMUM_COMMANDS] = { instruction.value };
+    uint32_t addresses[CPU_GTE_SEQUENCE_MAXIMUM_COMMANDS] = { programCounter };
+    unsigned int count = 1;
+    unsigned int nops = 0;
+    uint32_t address = programCounter + 4;
+    while (count < CPU_GTE_SEQUENCE_MAXIMUM_COMMANDS) {
+        Instruction next = Instruction(load<uint32_t>(address));
+        if (next.value == 0 && nops < CPU_GTE_SEQUENCE_MAXIMUM_NOPS) {
+            nops++;
+            address += 4;
+            continue;
+        }
+        if (next.funct != 0b010010 || (next.copcode() & 0x10) == 0) {
+            break;
+        }
+        commands[count] = next.value;
+        addresses[count] = address;
+        count++;
+        nops = 0;
+        address += 4;
+    }
+    unsigned int executed = gte->executeSequence(commands, count);
+    if (executed == 1) {
+        return;
+    }
+    fusedInstructions = (addresses[executed - 1] - programCounter) / 4;
+    for (uint32_t i = 0; i < fusedInstructions; i++) {
+        moveLoadDelaySlots();
+    }
+    programCounter = addresses[executed - 1];
+}
+
 void CPU::operationCoprocessor3(Instruction instruction) {
     // TODO: unused
     (void)instruction;
@@ -1421,6 +1486,9 @@ void CPU::triggerException(ExceptionType exceptionType) {
     programCounter = handlerAddress;
     isBranching = false;
     runningException = true;
+    // An interrupt raised after a fused GTE sequence is taken once all of it retired, with EPC past
+    // its last command, and the handler starts right away
+    fusedInstructions = 0;
 }
 
 void CPU::operationLoadWordCoprocessor0(Instruction instruction) {
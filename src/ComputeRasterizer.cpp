@@ -0,0 +1,378 @@
+#include "ComputeRasterizer.hpp"
+#include <algorithm>
+#include "RendererDebugger.hpp"
+#include "Framebuffer.hpp"
+
+using namespace std;
+
+ComputeRasterizer::ComputeRasterizer() : logger(LogLevel::NoLog), primitives(), batchLeft(VRAM_WIDTH), batchTop(VRAM_HEIGHT), batchRight(-1), batchBottom(-1), batchReadLeft(VRAM_WIDTH), batchReadTop(VRAM_HEIGHT), batchReadRight(-1), batchReadBottom(-1), drawingOffset(), drawingAreaTopLeft(), drawingAreaSize({}), semiTransparencyMode(0), dithering(false), setMaskBit(false), checkMaskBit(false), textureWindow(0) {
+    glGenTextures(1, &vramImage);
+    glBindTexture(GL_TEXTURE_2D, vramImage);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16UI, VRAM_WIDTH, VRAM_HEIGHT);
+    // Integer textures are incomplete with linear filtering, even when only fetched from
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    vector<uint16_t> blank = vector<uint16_t>(VRAM_WIDTH * VRAM_HEIGHT, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, VRAM_WIDTH, VRAM_HEIGHT, GL_RED_INTEGER, GL_UNSIGNED_SHORT, blank.data());
+
+    glGenBuffers(1, &primitiveBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, primitiveBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ComputePrimitive) * COMPUTE_RASTERIZER_CAPACITY, nullptr, GL_DYNAMIC_DRAW);
+
+    program = make_unique<RendererProgram>("./glsl/compute_rasterizer.glsl");
+    originUniform = program->findProgramUniform("origin");
+    primitiveCountUniform = program->findProgramUniform("primitive_count");
+
+    resolveProgram = make_unique<RendererProgram>("./glsl/texture_load_vertex.glsl", "./glsl/vram_resolve_fragment.glsl");
+    resolveProgram->useProgram();
+    GLuint vramUniform = resolveProgram->findProgramUniform("vram");
+    glUniform1i(vramUniform, 0);
+    resolveBuffer = make_unique<RendererBuffer<Point2D>>(resolveProgram, 4);
+
+    primitives.reserve(COMPUTE_RASTERIZER_CAPACITY);
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+ComputeRasterizer::~ComputeRasterizer() {
+    glDeleteBuffers(1, &primitiveBuffer);
+    glDeleteTextures(1, &vramImage);
+}
+
+uint32_t ComputeRasterizer::remainingCapacity() const {
+    return COMPUTE_RASTERIZER_CAPACITY - primitives.size();
+}
+
+bool ComputeRasterizer::isEmpty() const {
+    return primitives.empty();
+}
+
+/*
+Whether the rectangle intersects what the pending batch draws to or is textured from.
+*/
+bool ComputeRasterizer::overlapsBatch(Point2D topLeft, Dimensions size) const {
+    GLint left = topLeft.x;
+    GLint top = topLeft.y;
+    GLint right = left + size.width - 1;
+    GLint bottom = top + size.height - 1;
+    bool writes = left <= batchRight && right >= batchLeft && top <= batchBottom && bottom >= batchTop;
+    bool reads = left <= batchReadRight && right >= batchReadLeft && top <= batchReadBottom && bottom >= batchReadTop;
+    return writes || reads;
+}
+
+/*
+Dithering applies to shaded and texture blended primitives only. Whether a primitive was sent
+with per-vertex colors is not part of the vertex, so one with identical colors at every vertex
+is treated as flat shaded.
+*/
+GLuint ComputeRasterizer::flagsFor(const Vertex &vertex, bool opaque, bool shaded) const {
+    GLuint flags = 0;
+    flags |= vertex.textureBlendMode << COMPUTE_PRIMITIVE_TEXTURE_BLEND_MODE_SHIFT;
+    flags |= vertex.textureDepthShift << COMPUTE_PRIMITIVE_TEXTURE_DEPTH_SHIFT_SHIFT;
+    flags |= semiTransparencyMode << COMPUTE_PRIMITIVE_SEMI_TRANSPARENCY_MODE_SHIFT;
+    if (!opaque) {
+        flags |= COMPUTE_PRIMITIVE_SEMI_TRANSPARENT;
+    }
+    if (dithering && (shaded || vertex.textureBlendMode == TextureBlendMode::TextureBlendModeTextureBlend)) {
+        flags |= COMPUTE_PRIMITIVE_DITHER;
+    }
+    if (setMaskBit) {
+        flags |= COMPUTE_PRIMITIVE_SET_MASK_BIT;
+    }
+    if (checkMaskBit) {
+        flags |= COMPUTE_PRIMITIVE_CHECK_MASK_BIT;
+    }
+    return flags;
+}
+
+void ComputeRasterizer::packVertex(ComputePrimitive &primitive, uint32_t index, const Vertex &vertex) const {
+    primitive.vertices[index][0] = vertex.point.x + drawingOffset.x;
+    primitive.vertices[index][1] = vertex.point.y + drawingOffset.y;
+    primitive.vertices[index][2] = vertex.color.r | (vertex.color.g << 8) | (vertex.color.b << 16);
+    primitive.vertices[index][3] = (vertex.texturePosition.x & 0xffff) | ((vertex.texturePosition.y & 0xffff) << 16);
+}
+
+/*
+Returns false when nothing is left to draw once the bounding box is clipped to the drawing area.
+*/
+bool ComputeRasterizer::clipToDrawingArea(ComputePrimitive &primitive, uint32_t count) const {
+    GLint left = primitive.vertices[0][0];
+    GLint right = left;
+    GLint top = primitive.vertices[0][1];
+    GLint bottom = top;
+    for (uint32_t i = 1; i < count; i++) {
+        left = min(left, primitive.vertices[i][0]);
+        right = max(right, primitive.vertices[i][0]);
+        top = min(top, primitive.vertices[i][1]);
+        bottom = max(bottom, primitive.vertices[i][1]);
+    }
+    primitive.bounds[0] = max(left, (GLint)drawingAreaTopLeft.x);
+    primitive.bounds[1] = max(top, (GLint)drawingAreaTopLeft.y);
+    primitive.bounds[2] = min({right, (GLint)drawingAreaTopLeft.x + (GLint)drawingAreaSize.width, (GLint)VRAM_WIDTH - 1});
+    primitive.bounds[3] = min({bottom, (GLint)drawingAreaTopLeft.y + (GLint)drawingAreaSize.height, (GLint)VRAM_HEIGHT - 1});
+    return primitive.bounds[0] <= primitive.bounds[2] && primitive.bounds[1] <= primitive.bounds[3];
+}
+
+void ComputeRasterizer::pushPrimitive(ComputePrimitive &primitive) {
+    batchLeft = min(batchLeft, primitive.bounds[0]);
+    batchTop = min(batchTop, primitive.bounds[1]);
+    batchRight = max(batchRight, primitive.bounds[2]);
+    batchBottom = max(batchBottom, primitive.bounds[3]);
+    primitives.push_back(primitive);
+}
+
+/*
+Areas crossing the edge of VRAM wrap around, the bounds just grow to cover it whole.
+*/
+static void wrapToVRAM(GLint &left, GLint &top, GLint &right, GLint &bottom) {
+    if (right >= (GLint)VRAM_WIDTH) {
+        left = 0;
+        right = VRAM_WIDTH - 1;
+    }
+    if (bottom >= (GLint)VRAM_HEIGHT) {
+        top = 0;
+        bottom = VRAM_HEIGHT - 1;
+    }
+}
+
+bool ComputeRasterizer::overlapsBatchWrites(GLint left, GLint top, GLint right, GLint bottom) const {
+    wrapToVRAM(left, top, right, bottom);
+    return left <= batchRight && right >= batchLeft && top <= batchBottom && bottom >= batchTop;
+}
+
+void ComputeRasterizer::extendBatchReads(GLint left, GLint top, GLint right, GLint bottom) {
+    wrapToVRAM(left, top, right, bottom);
+    batchReadLeft = min(batchReadLeft, left);
+    batchReadTop = min(batchReadTop, top);
+    batchReadRight = max(batchReadRight, right);
+    batchReadBottom = max(batchReadBottom, bottom);
+}
+
+/*
+Textured primitives may read anywhere in their texture page and their CLUT.
+*/
+void ComputeRasterizer::markTextureReads(const Vertex &vertex) {
+    if (vertex.textureBlendMode == TextureBlendMode::TextureBlendModeNoTexture) {
+        return;
+    }
+    GLint pageX = vertex.texturePage.x & (VRAM_WIDTH - 1);
+    GLint pageY = vertex.texturePage.y & (VRAM_HEIGHT - 1);
+    extendBatchReads(pageX, pageY, pageX + (256 >> vertex.textureDepthShift) - 1, pageY + 255);
+    if (vertex.textureDepthShift == 0) {
+        return;
+    }
+    GLint clutX = vertex.clut.x & (VRAM_WIDTH - 1);
+    GLint clutY = vertex.clut.y & (VRAM_HEIGHT - 1);
+    extendBatchReads(clutX, clutY, clutX + (1 << (16 >> vertex.textureDepthShift)) - 1, clutY);
+}
+
+/*
+Whether the primitive has to go into a new batch. Invocations only keep to submission order for
+their own pixel, so a primitive textured from pixels the batch draws to, or drawing to pixels the
+batch is textured from, would read whatever the other invocations got to first.
+*/
+bool ComputeRasterizer::conflictsWithBatch(const std::vector<Vertex> &vertices) const {
+    if (primitives.empty()) {
+        return false;
+    }
+    GLint left = VRAM_WIDTH;
+    GLint top = VRAM_HEIGHT;
+    GLint right = -1;
+    GLint bottom = -1;
+    for (const Vertex &vertex : vertices) {
+        left = min(left, vertex.point.x + drawingOffset.x);
+        top = min(top, vertex.point.y + drawingOffset.y);
+        right = max(right, vertex.point.x + drawingOffset.x);
+        bottom = max(bottom, vertex.point.y + drawingOffset.y);
+    }
+    if (left <= batchReadRight && right >= batchReadLeft && top <= batchReadBottom && bottom >= batchReadTop) {
+        return true;
+    }
+    const Vertex &vertex = vertices.front();
+    if (vertex.textureBlendMode == TextureBlendMode::TextureBlendModeNoTexture) {
+        return false;
+    }
+    GLint pageX = vertex.texturePage.x & (VRAM_WIDTH - 1);
+    GLint pageY = vertex.texturePage.y & (VRAM_HEIGHT - 1);
+    if (overlapsBatchWrites(pageX, pageY, pageX + (256 >> vertex.textureDepthShift) - 1, pageY + 255)) {
+        return true;
+    }
+    if (vertex.textureDepthShift == 0) {
+        return false;
+    }
+    GLint clutX = vertex.clut.x & (VRAM_WIDTH - 1);
+    GLint clutY = vertex.clut.y & (VRAM_HEIGHT - 1);
+    return overlapsBatchWrites(clutX, clutY, clutX + (1 << (16 >> vertex.textureDepthShift)) - 1, clutY);
+}
+
+void ComputeRasterizer::pushTriangle(const Vertex &first, const Vertex &second, const Vertex &third, bool opaque, bool shaded) {
+    ComputePrimitive primitive = {};
+    packVertex(primitive, 0, first);
+    packVertex(primitive, 1, second);
+    packVertex(primitive, 2, third);
+    if (!clipToDrawingArea(primitive, 3)) {
+        return;
+    }
+    primitive.attributes[0] = flagsFor(first, opaque, shaded);
+    primitive.attributes[1] = (first.texturePage.x & 0xffff) | ((first.texturePage.y & 0xffff) << 16);
+    primitive.attributes[2] = (first.clut.x & 0xffff) | ((first.clut.y & 0xffff) << 16);
+    primitive.attributes[3] = textureWindow;
+    markTextureReads(first);
+    pushPrimitive(primitive);
+}
+
+void ComputeRasterizer::pushLine(const Vertex &start, const Vertex &end, bool opaque) {
+    ComputePrimitive primitive = {};
+    packVertex(primitive, 0, start);
+    packVertex(primitive, 1, end);
+    if (!clipToDrawingArea(primitive, 2)) {
+        return;
+    }
+    bool shaded = primitive.vertices[0][2] != primitive.vertices[1][2];
+    primitive.attributes[0] = flagsFor(start, opaque, shaded) | COMPUTE_PRIMITIVE_LINE;
+    pushPrimitive(primitive);
+}
+
+void ComputeRasterizer::pushPolygon(const std::vector<Vertex> &vertices, bool opaque) {
+    bool shaded = false;
+    for (auto& vertex : vertices) {
+        const Color &color = vertices.front().color;
+        shaded = shaded || vertex.color.r != color.r || vertex.color.g != color.g || vertex.color.b != color.b;
+    }
+    pushTriangle(vertices[0], vertices[1], vertices[2], opaque, shaded);
+    if (vertices.size() == 4) {
+        pushTriangle(vertices[1], vertices[2], vertices[3], opaque, shaded);
+    }
+}
+
+void ComputeRasterizer::setDrawingOffset(int16_t x, int16_t y) {
+    drawingOffset = Point2D(x, y);
+}
+
+void ComputeRasterizer::setDrawingArea(Point2D topLeft, Dimensions size) {
+    drawingAreaTopLeft = topLeft;
+    drawingAreaSize = size;
+}
+
+void ComputeRasterizer::setSemiTransparencyMode(GLuint mode) {
+    semiTransparencyMode = mode;
+}
+
+void ComputeRasterizer::setDithering(bool enabled) {
+    dithering = enabled;
+}
+
+void ComputeRasterizer::setMaskBitSetting(bool setMaskBit, bool checkMaskBit) {
+    this->setMaskBit = setMaskBit;
+    this->checkMaskBit = checkMaskBit;
+}
+
+void ComputeRasterizer::setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) {
+    textureWindow = (maskX & 0x1f) | ((maskY & 0x1f) << 5) | ((offsetX & 0x1f) << 10) | ((offsetY & 0x1f) << 15);
+}
+
+/*
+Draws the pending primitives with a single dispatch covering their combined bounding box and
+returns the number of primitives drawn.
+*/
+uint32_t ComputeRasterizer::flush() {
+    uint32_t count = primitives.size();
+    if (count == 0) {
+        return 0;
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, primitiveBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(ComputePrimitive), primitives.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, primitiveBuffer);
+    glBindImageTexture(0, vramImage, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R16UI);
+
+    program->useProgram();
+    glUniform2i(originUniform, batchLeft, batchTop);
+    glUniform1ui(primitiveCountUniform, count);
+    GLuint groupsX = (batchRight - batchLeft + COMPUTE_RASTERIZER_WORKGROUP_SIZE) / COMPUTE_RASTERIZER_WORKGROUP_SIZE;
+    GLuint groupsY = (batchBottom - batchTop + COMPUTE_RASTERIZER_WORKGROUP_SIZE) / COMPUTE_RASTERIZER_WORKGROUP_SIZE;
+    glDispatchCompute(groupsX, groupsY, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    primitives.clear();
+    batchLeft = VRAM_WIDTH;
+    batchTop = VRAM_HEIGHT;
+    batchRight = -1;
+    batchBottom = -1;
+    batchReadLeft = VRAM_WIDTH;
+    batchReadTop = VRAM_HEIGHT;
+    batchReadRight = -1;
+    batchReadBottom = -1;
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+    return count;
+}
+
+/*
+Uploads wrap around VRAM, so they are split in up to four rectangles that each fit in the image.
+The pixels are read from the bound pixel unpack buffer, starting at unpackOffset.
+*/
+void ComputeRasterizer::writeVRAM(std::unique_ptr<GPUImageBuffer> &imageBuffer, GLintptr unpackOffset) {
+    uint16_t x, y, width, height;
+    tie(x, y) = imageBuffer->destination();
+    tie(width, height) = imageBuffer->resolution();
+    x &= VRAM_WIDTH - 1;
+    y &= VRAM_HEIGHT - 1;
+    glBindTexture(GL_TEXTURE_2D, vramImage);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+    for (uint32_t row = 0; row < height; row += VRAM_HEIGHT - ((y + row) & (VRAM_HEIGHT - 1))) {
+        uint32_t rowStart = (y + row) & (VRAM_HEIGHT - 1);
+        uint32_t rows = min((uint32_t)height - row, VRAM_HEIGHT - rowStart);
+        for (uint32_t column = 0; column < width; column += VRAM_WIDTH - ((x + column) & (VRAM_WIDTH - 1))) {
+            uint32_t columnStart = (x + column) & (VRAM_WIDTH - 1);
+            uint32_t columns = min((uint32_t)width - column, VRAM_WIDTH - columnStart);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, row);
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, column);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, columnStart, rowStart, columns, rows, GL_RED_INTEGER, GL_UNSIGNED_SHORT, (const void *)unpackOffset);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+/*
+Fills a rectangle that fits in VRAM.
+*/
+void ComputeRasterizer::fillVRAM(Point2D topLeft, Dimensions size, uint16_t color) {
+    glClearTexSubImage(vramImage, 0, topLeft.x, topLeft.y, 0, size.width, size.height, 1, GL_RED_INTEGER, GL_UNSIGNED_SHORT, &color);
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+/*
+Returns the whole VRAM, top row first.
+*/
+std::vector<uint16_t> ComputeRasterizer::readVRAM() {
+    vector<uint16_t> vram = vector<uint16_t>(VRAM_WIDTH * VRAM_HEIGHT);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, vramImage);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_SHORT, vram.data());
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+    return vram;
+}
+
+/*
+Converts VRAM into the texture the display and frame capture read from, which is stored upside
+down and scaled by the internal resolution.
+*/
+void ComputeRasterizer::resolve(std::unique_ptr<Texture> &texture) {
+    glDisable(GL_SCISSOR_TEST);
+    glDisable(GL_BLEND);
+    Framebuffer framebuffer = Framebuffer(texture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, vramImage);
+    vector<Point2D> data = { {0, 0}, {(GLshort)VRAM_WIDTH, 0}, {0, (GLshort)VRAM_HEIGHT}, {(GLshort)VRAM_WIDTH, (GLshort)VRAM_HEIGHT} };
+    resolveBuffer->addData(data);
+    resolveBuffer->draw(GL_TRIANGLE_STRIP);
+    glEnable(GL_SCISSOR_TEST);
+}
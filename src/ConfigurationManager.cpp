@@ -1,11 +1,12 @@
 #include "ConfigurationManager.hpp"
 #include <fstream>
+#include <algorithm>
 
 using namespace std;
 
 const string configurationFile = "config.yaml";
 
-ConfigurationManager::ConfigurationManager() : logger(LogLevel::Warning, "", false), filePath(filesystem::current_path() / configurationFile), ctrllerName(""), resizeWindowToFitFramefuffer(false), showDebugInfoWindow(false),  bios(NoLog), cdrom(NoLog), interconnect(NoLog), cpu(NoLog), gpu(NoLog), opengl(NoLog), dma(NoLog), controller(NoLog), interrupt(NoLog), trace(false) {}
+ConfigurationManager::ConfigurationManager() : logger(LogLevel::Warning, "", false), filePath(filesystem::current_path() / configurationFile), ctrllerName(""), resizeWindowToFitFramefuffer(false), showDebugInfoWindow(false), useTextureCache(true), internalResolutionScale(1), backend(RendererBackendOpenGL), softwareRendererThreadCount(0), useAutoFrameSkip(false), maximumSkippedFrames(3), useDisplayListCache(false), bios(NoLog), cdrom(NoLog), interconnect(NoLog), cpu(NoLog), gpu(NoLog), opengl(NoLog), dma(NoLog), controller(NoLog), interrupt(NoLog), trace(false) {}
 
 ConfigurationManager* ConfigurationManager::instance = nullptr;
 
@@ -42,6 +43,13 @@ void ConfigurationManager::setupConfigurationFile() {
     configurationRef["controllerName"] = "Sony Interactive Entertainment Controller";
     configurationRef["debugInfoWindow"] = "false";
     configurationRef["showFramebuffer"] = "false";
+    configurationRef["textureCache"] = "true";
+    configurationRef["internalResolution"] = "1";
+    configurationRef["renderer"] = "opengl";
+    configurationRef["softwareRendererThreads"] = "0";
+    configurationRef["frameSkip"] = "off";
+    configurationRef["maxSkippedFrames"] = "3";
+    configurationRef["displayListCache"] = "false";
     Yaml::Serialize(configuration, filePath.string().c_str());
 }
 
@@ -51,6 +59,48 @@ void ConfigurationManager::loadConfiguration() {
     ctrllerName = configuration["controllerName"].As<string>();
     resizeWindowToFitFramefuffer = configuration["showFramebuffer"].As<bool>();
     showDebugInfoWindow = configuration["debugInfoWindow"].As<bool>();
+    useTextureCache = configuration["textureCache"].As<bool>(true);
+    int resolution = configuration["internalResolution"].As<int>(1);
+    if (resolution < 1 || resolution > 8) {
+        logger.logWarning("Unsupported internal resolution: %dx, valid values are 1 to 8", resolution);
+        resolution = clamp(resolution, 1, 8);
+    }
+    internalResolutionScale = resolution;
+    string renderer = configuration["renderer"].As<string>("opengl");
+    if (renderer == "compute") {
+        backend = RendererBackendCompute;
+    } else if (renderer == "software") {
+        backend = RendererBackendSoftware;
+    } else if (renderer == "null") {
+        backend = RendererBackendNull;
+    } else {
+        if (renderer != "opengl") {
+            logger.logWarning("Unsupported renderer: %s, valid values are opengl, compute, software and null", renderer.c_str());
+        }
+        backend = RendererBackendOpenGL;
+    }
+    // Configurations written before the compute rasterizer became a renderer select it this way
+    if (backend == RendererBackendOpenGL && configuration["rasterizer"].As<string>("opengl") == "compute") {
+        backend = RendererBackendCompute;
+    }
+    int threads = configuration["softwareRendererThreads"].As<int>(0);
+    if (threads < 0 || threads > 16) {
+        logger.logWarning("Unsupported software renderer threads: %d, valid values are 0 (one per core) to 16", threads);
+        threads = clamp(threads, 0, 16);
+    }
+    softwareRendererThreadCount = threads;
+    string frameSkip = configuration["frameSkip"].As<string>("off");
+    if (frameSkip != "off" && frameSkip != "auto") {
+        logger.logWarning("Unsupported frame skip: %s, valid values are off and auto", frameSkip.c_str());
+    }
+    useAutoFrameSkip = frameSkip == "auto";
+    int skippedFrames = configuration["maxSkippedFrames"].As<int>(3);
+    if (skippedFrames < 1 || skippedFrames > 8) {
+        logger.logWarning("Unsupported maximum skipped frames: %d, valid values are 1 to 8", skippedFrames);
+        skippedFrames = clamp(skippedFrames, 1, 8);
+    }
+    maximumSkippedFrames = skippedFrames;
+    useDisplayListCache = configuration["displayListCache"].As<bool>(false);
     bios = logLevelWithValue(configuration["log"]["bios"].As<string>());
     cdrom = logLevelWithValue(configuration["log"]["cdrom"].As<string>());
     interconnect = logLevelWithValue(configuration["log"]["interconnect"].As<string>());
@@ -80,6 +130,41 @@ bool ConfigurationManager::shouldShowDebugInfoWindow() {
     return showDebugInfoWindow;
 }
 
+bool ConfigurationManager::shouldUseTextureCache() {
+    return useTextureCache;
+}
+
+uint32_t ConfigurationManager::internalResolution() {
+    return internalResolutionScale;
+}
+
+RendererBackend ConfigurationManager::rendererBackend() {
+    return backend;
+}
+
+/*
+Whether the selected renderer needs an OpenGL context, the others draw without one.
+*/
+bool ConfigurationManager::shouldUseOpenGL() {
+    return backend == RendererBackendOpenGL || backend == RendererBackendCompute;
+}
+
+uint32_t ConfigurationManager::softwareRendererThreads() {
+    return softwareRendererThreadCount;
+}
+
+bool ConfigurationManager::shouldUseAutoFrameSkip() {
+    return useAutoFrameSkip;
+}
+
+uint32_t ConfigurationManager::maxSkippedFrames() {
+    return maximumSkippedFrames;
+}
+
+bool ConfigurationManager::shouldUseDisplayListCache() {
+    return useDisplayListCache;
+}
+
 LogLevel ConfigurationManager::biosLogLevel() {
     return bios;
 }
@@ -1,13 +1,18 @@
 #include "DMA.hpp"
 #include "RAM.tcc"
+#include "ConfigurationManager.hpp"
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
-DMA::DMA(LogLevel logLevel, unique_ptr<RAM> &ram, unique_ptr<GPU> &gpu, unique_ptr<CDROM> &cdrom, std::unique_ptr<InterruptController> &interruptController) : logger(logLevel, "  DMA: "), ram(ram), gpu(gpu), cdrom(cdrom), interruptController(interruptController) {
+DMA::DMA(LogLevel logLevel, unique_ptr<RAM> &ram, unique_ptr<GPU> &gpu, unique_ptr<CDROM> &cdrom, std::unique_ptr<InterruptController> &interruptController) : logger(logLevel, "  DMA: "), ram(ram), gpu(gpu), cdrom(cdrom), interruptController(interruptController), displayListCache() {
     for (int i = 0; i < 7; i++) {
         channels[i] = Channel(logLevel, DMAPort(i));
     }
+    if (ConfigurationManager::getInstance()->shouldUseDisplayListCache()) {
+        displayListCache = make_unique<DisplayListCache>();
+    }
 }
 
 DMA::~DMA() {
@@ -109,12 +114,12 @@ void DMA::executeLinkedList(DMAPort port, Channel& channel) {
     logger.logWarning("LinkedList for port: %s with base address: %#x", portDescription(port).c_str(), address);
     while (true) {
         uint32_t header = ram->load<uint32_t>(address);
-        uint32_t remainingTransferSize = header >> 24;
-        while (remainingTransferSize > 0) {
-            address = (address + 4) & 0x1ffffc;
-            uint32_t command = ram->load<uint32_t>(address);
-            gpu->executeGp0(command);
-            remainingTransferSize -= 1;
+        uint32_t size = header >> 24;
+        // Packets wrapping around the end of RAM are rare enough to always be decoded
+        if (displayListCache && size > 0 && address + size * 4 < RAM_SIZE && gpu->canCacheDisplayList()) {
+            executeCachedLinkedListPacket(address, size);
+        } else {
+            executeLinkedListPacket(address, size);
         }
         if ((header & 0x800000) != 0) {
             break;
@@ -125,6 +130,41 @@ void DMA::executeLinkedList(DMAPort port, Channel& channel) {
     return;
 }
 
+void DMA::executeLinkedListPacket(uint32_t address, uint32_t size) {
+    for (uint32_t i = 1; i <= size; i++) {
+        gpu->executeGp0(ram->load<uint32_t>((address + i * 4) & 0x1ffffc));
+    }
+}
+
+/*
+Replays the renderer calls recorded the last time the packet was decoded when neither its words
+nor the GPU state they depend on changed, decoding and recording it otherwise. Packets already
+known to be uncacheable are decoded as they would be without the cache.
+*/
+void DMA::executeCachedLinkedListPacket(uint32_t address, uint32_t size) {
+    DisplayListState state = gpu->displayListState();
+    const DisplayListPacket *packet = displayListCache->find(address, size, *ram, state);
+    if (packet && !packet->cacheable) {
+        gpu->countDisplayListPacket(RendererDisplayListPacket::RendererDisplayListPacketUncacheable);
+        executeLinkedListPacket(address, size);
+        return;
+    }
+    if (packet) {
+        gpu->countDisplayListPacket(RendererDisplayListPacket::RendererDisplayListPacketHit);
+        gpu->replayDisplayList(*packet);
+        return;
+    }
+    gpu->countDisplayListPacket(RendererDisplayListPacket::RendererDisplayListPacketMiss);
+    DisplayListPacket *recording = displayListCache->record(address, size, *ram, state);
+    gpu->startDisplayListRecording(recording);
+    executeLinkedListPacket(address, size);
+    gpu->stopDisplayListRecording();
+    // Only what's needed to tell the words didn't change is kept
+    if (!recording->cacheable) {
+        recording->commands.clear();
+    }
+}
+
 void DMA::executeBlock(DMAPort port, Channel& channel) {
     int8_t step = 4;
     if (channel.step() == Step::Decrement) {
@@ -144,6 +184,14 @@ void DMA::executeBlock(DMAPort port, Channel& channel) {
                 uint32_t source = ram->load<uint32_t>(currentAddress);
                 switch (port) {
                     case DMAPort::GPUP: {
+                        // Image data is handed over in runs of contiguous words, up to the end of RAM
+                        if (step > 0 && gpu->isLoadingImage()) {
+                            uint32_t words = min(remainingTransferSize, (RAM_SIZE - currentAddress) / 4);
+                            uint32_t consumed = gpu->loadImageWords(ram->dataRef() + currentAddress, words);
+                            address += (consumed - 1) * 4;
+                            remainingTransferSize -= consumed - 1;
+                            break;
+                        }
                         gpu->executeGp0(source);
                         break;
                     }
@@ -184,6 +232,10 @@ void DMA::executeBlock(DMAPort port, Channel& channel) {
                         source = cdrom->loadWordFromReadBuffer();
                         break;
                     }
+                    case DMAPort::GPUP: {
+                        source = gpu->loadWordFromReadBuffer();
+                        break;
+                    }
                     default: {
                         logger.logError("Unhandled DMA block transfer to RAM from source port: %s", portDescription(port).c_str());
                         break;
@@ -7,7 +7,7 @@
 
 using namespace std;
 
-DebugInfoRenderer::DebugInfoRenderer(std::unique_ptr<Window> &debugWindow) : debugWindow(debugWindow), backgroundColor(ImVec4(255/255.0f, 182/255.0f, 193/255.0f, 1.00f)), biosFunctionsLog() {
+DebugInfoRenderer::DebugInfoRenderer(std::unique_ptr<Window> &debugWindow) : debugWindow(debugWindow), backgroundColor(ImVec4(255/255.0f, 182/255.0f, 193/255.0f, 1.00f)), biosFunctionsLog(), rendererStatisticsHistory() {
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     io = &ImGui::GetIO(); (void)io;
@@ -44,6 +44,51 @@ void DebugInfoRenderer::update() {
         }
         ImGui::End();
     }
+    {
+        ImVec2 rendererWindowSize = ImVec2(static_cast<float>((windowDimensions.width / 3) - 10), static_cast<float>(windowDimensions.height - 20));
+        ImGui::SetNextWindowPos(ImVec2(static_cast<float>((windowDimensions.width / 3) * 2), 10), ImGuiCond_Always);
+        ImGui::SetNextWindowSize(rendererWindowSize, ImGuiCond_Always);
+        ImGui::Begin("Renderer", NULL, ImGuiWindowFlags_NoResize);
+        if (!rendererStatisticsHistory.empty()) {
+            const RendererStatistics &statistics = rendererStatisticsHistory.back();
+            ImGui::Text("Last frame");
+            for (uint32_t i = 0; i < RendererPrimitiveTypeCount; i++) {
+                ImGui::Text("  %s: %lu", RendererStatistics::primitiveTypeName(RendererPrimitiveType(i)), (unsigned long)statistics.primitives[i]);
+            }
+            ImGui::Text("  Textured: %lu", (unsigned long)statistics.texturedPrimitives);
+            ImGui::Text("  Semi-transparent: %lu", (unsigned long)statistics.semiTransparentPrimitives);
+            ImGui::Text("  Vertices uploaded: %lu", (unsigned long)statistics.verticesUploaded);
+            ImGui::Text("  Bytes uploaded: %lu", (unsigned long)statistics.bytesUploaded);
+            ImGui::Text("  Draw calls: %lu", (unsigned long)statistics.drawCalls);
+            ImGui::Text("  Flushes: %lu", (unsigned long)statistics.totalFlushes());
+            for (uint32_t i = 0; i < RendererFlushReasonCount; i++) {
+                ImGui::Text("    %s: %lu", RendererStatistics::flushReasonName(RendererFlushReason(i)), (unsigned long)statistics.flushes[i]);
+            }
+            ImGui::Text("  VRAM uploads: %lu (%lu bytes)", (unsigned long)statistics.vramUploads, (unsigned long)statistics.vramUploadBytes);
+            ImGui::Text("  VRAM fills: %lu", (unsigned long)statistics.vramFills);
+            ImGui::Text("  VRAM copies: %lu", (unsigned long)statistics.vramCopies);
+            ImGui::Text("  Display list packets");
+            for (uint32_t i = 0; i < RendererDisplayListPacketCount; i++) {
+                ImGui::Text("    %s: %lu", RendererStatistics::displayListPacketName(RendererDisplayListPacket(i)), (unsigned long)statistics.displayListPackets[i]);
+            }
+            uint64_t skippedFrames = 0;
+            uint64_t unchangedFrames = 0;
+            for (const RendererStatistics &frameStatistics : rendererStatisticsHistory) {
+                skippedFrames += frameStatistics.skippedFrames;
+                unchangedFrames += frameStatistics.unchangedFrames;
+            }
+            ImGui::Text("Skipped frames: %lu of the last %lu", (unsigned long)skippedFrames, (unsigned long)rendererStatisticsHistory.size());
+            ImGui::Text("Unchanged frames: %lu of the last %lu", (unsigned long)unchangedFrames, (unsigned long)rendererStatisticsHistory.size());
+            ImGui::Separator();
+            plotRendererStatistic("Primitives", &RendererStatistics::totalPrimitives);
+            plotRendererStatistic("Vertices", &RendererStatistics::verticesUploaded);
+            plotRendererStatistic("Draw calls", &RendererStatistics::drawCalls);
+            plotRendererStatistic("Flushes", &RendererStatistics::totalFlushes);
+            plotRendererStatistic("VRAM uploads", &RendererStatistics::vramUploads);
+            plotRendererStatistic("Skipped frames", &RendererStatistics::skippedFrames);
+        }
+        ImGui::End();
+    }
     ImGui::Render();
     glViewport(0, 0, (int)io->DisplaySize.x, (int)io->DisplaySize.y);
     glClearColor(backgroundColor.x, backgroundColor.y, backgroundColor.z, backgroundColor.w);
@@ -59,3 +104,30 @@ void DebugInfoRenderer::handleSDLEvent(SDL_Event event) {
 void DebugInfoRenderer::pushLog(std::string log) {
     biosFunctionsLog.push_back(log);
 }
+
+void DebugInfoRenderer::setRendererStatisticsHistory(std::deque<RendererStatistics> history) {
+    rendererStatisticsHistory = history;
+}
+
+void DebugInfoRenderer::plotRendererStatistic(const char *label, uint64_t RendererStatistics::*counter) {
+    vector<float> values;
+    for (const RendererStatistics &statistics : rendererStatisticsHistory) {
+        values.push_back(static_cast<float>(statistics.*counter));
+    }
+    plotRendererStatistic(label, values);
+}
+
+void DebugInfoRenderer::plotRendererStatistic(const char *label, uint64_t (RendererStatistics::*counter)() const) {
+    vector<float> values;
+    for (const RendererStatistics &statistics : rendererStatisticsHistory) {
+        values.push_back(static_cast<float>((statistics.*counter)()));
+    }
+    plotRendererStatistic(label, values);
+}
+
+void DebugInfoRenderer::plotRendererStatistic(const char *label, std::vector<float> values) {
+    string overlay = to_string(static_cast<uint64_t>(values.back()));
+    string plotIdentifier = string("##") + label;
+    ImGui::Text("%s", label);
+    ImGui::PlotLines(plotIdentifier.c_str(), values.data(), values.size(), 0, overlay.c_str(), 0.0f, FLT_MAX, ImVec2(ImGui::GetWindowContentRegionWidth(), 40));
+}
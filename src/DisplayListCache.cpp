@@ -0,0 +1,117 @@
+#include "DisplayListCache.hpp"
+#include "RAM.tcc"
+
+using namespace std;
+
+bool DisplayListState::operator==(const DisplayListState &other) const {
+    return texturePageBaseX == other.texturePageBaseX &&
+        texturePageBaseY == other.texturePageBaseY &&
+        texturePageColors == other.texturePageColors &&
+        semiTransparency == other.semiTransparency &&
+        drawingAreaTop == other.drawingAreaTop &&
+        drawingAreaLeft == other.drawingAreaLeft &&
+        drawingAreaBottom == other.drawingAreaBottom &&
+        drawingAreaRight == other.drawingAreaRight &&
+        drawingOffsetX == other.drawingOffsetX &&
+        drawingOffsetY == other.drawingOffsetY;
+}
+
+DisplayListCommand::DisplayListCommand(DisplayListCommandType type, vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) : type(type), vertices(vertices), rectangle(Point2D(), Dimensions(0), Color(0), false), opaque(opaque), textureBlendMode(textureBlendMode), semiTransparency(0) {}
+
+DisplayListCommand::DisplayListCommand(RectangleInstance rectangle) : type(DisplayListRectangle), vertices(), rectangle(rectangle), opaque(false), textureBlendMode(TextureBlendModeNoTexture), semiTransparency(0) {}
+
+DisplayListCommand::DisplayListCommand(uint8_t semiTransparency) : type(DisplayListSemiTransparency), vertices(), rectangle(Point2D(), Dimensions(0), Color(0), false), opaque(false), textureBlendMode(TextureBlendModeNoTexture), semiTransparency(semiTransparency) {}
+
+DisplayListCommand::~DisplayListCommand() {}
+
+DisplayListCache::DisplayListCache() : packets() {}
+
+DisplayListCache::~DisplayListCache() {}
+
+/*
+FNV-1a over the packet size and its command words, leaving out the link to the next packet.
+*/
+uint64_t DisplayListCache::hashPacket(uint32_t address, uint32_t size, const RAM &ram) const {
+    uint64_t hash = 0xcbf29ce484222325;
+    hash = (hash ^ size) * 0x100000001b3;
+    for (uint32_t i = 1; i <= size; i++) {
+        hash = (hash ^ ram.load<uint32_t>(address + i * 4)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+void DisplayListCache::storePageGenerations(DisplayListPacket &packet, const RAM &ram) const {
+    packet.pageGenerations.clear();
+    for (uint32_t page = packet.firstPage; page <= packet.lastPage; page++) {
+        packet.pageGenerations.push_back(ram.pageGeneration(page));
+    }
+}
+
+bool DisplayListCache::arePageGenerationsCurrent(const DisplayListPacket &packet, const RAM &ram) const {
+    for (uint32_t page = packet.firstPage; page <= packet.lastPage; page++) {
+        if (packet.pageGenerations[page - packet.firstPage] != ram.pageGeneration(page)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+Whether the packet still holds the words it was recorded from. They are only hashed when one of its
+pages was written since.
+*/
+bool DisplayListCache::areWordsCurrent(DisplayListPacket &packet, uint32_t address, const RAM &ram) const {
+    if (arePageGenerationsCurrent(packet, ram)) {
+        return true;
+    }
+    if (hashPacket(address, packet.size, ram) != packet.hash) {
+        return false;
+    }
+    storePageGenerations(packet, ram);
+    return true;
+}
+
+/*
+Returns the packet at the address when it can be replayed instead of decoded, or when it's known to
+be uncacheable, which the caller tells apart through cacheable. Returns nullptr when it has to be
+decoded and recorded. Uncacheable packets don't depend on the GPU state, only on their words.
+Packets wrapping around the end of RAM are never cached, so the caller must check for that first.
+*/
+const DisplayListPacket* DisplayListCache::find(uint32_t address, uint32_t size, const RAM &ram, const DisplayListState &state) {
+    auto iterator = packets.find(address);
+    if (iterator == packets.end()) {
+        return nullptr;
+    }
+    DisplayListPacket &packet = iterator->second;
+    if (packet.size != size || (packet.cacheable && !(packet.state == state))) {
+        return nullptr;
+    }
+    if (!areWordsCurrent(packet, address, ram)) {
+        return nullptr;
+    }
+    return &packet;
+}
+
+/*
+Starts a fresh entry for the packet at the address, replacing any previous one, for the GPU to
+fill in while it decodes the words.
+*/
+DisplayListPacket* DisplayListCache::record(uint32_t address, uint32_t size, const RAM &ram, const DisplayListState &state) {
+    if (packets.size() >= DISPLAY_LIST_CACHE_MAXIMUM_PACKETS && packets.find(address) == packets.end()) {
+        packets.clear();
+    }
+    DisplayListPacket &packet = packets[address];
+    packet.size = size;
+    packet.hash = hashPacket(address, size, ram);
+    packet.firstPage = address / RAM_PAGE_SIZE;
+    packet.lastPage = (address + size * 4) / RAM_PAGE_SIZE;
+    storePageGenerations(packet, ram);
+    packet.state = state;
+    packet.commands.clear();
+    packet.cacheable = true;
+    return &packet;
+}
+
+void DisplayListCache::discard(uint32_t address) {
+    packets.erase(address);
+}
@@ -11,24 +11,44 @@ const uint32_t SCREEN_WIDTH = 1024;
 const uint32_t SCREEN_HEIGHT = 768;
 
 Emulator::Emulator() : logger(LogLevel::NoLog), ttyBuffer() {
+    EmulatorRunner *emulatorRunner = EmulatorRunner::getInstance();
+    headless = emulatorRunner->shouldRunHeadless();
     setupSDL();
     uint32_t screenHeight = SCREEN_HEIGHT;
     ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
     if (configurationManager->shouldResizeWindowToFitFramebuffer()) {
         screenHeight = 512;
     }
-    showDebugInfoWindow = configurationManager->shouldShowDebugInfoWindow();
-    debugWindow = make_unique<Window>(false, EmulatorName + " - dbginfo", SCREEN_WIDTH, SCREEN_HEIGHT, !showDebugInfoWindow);
-    mainWindow = make_unique<Window>(true, EmulatorName, SCREEN_WIDTH, screenHeight, false);
+    // The software and null renderers don't need OpenGL at all, which also leaves out the debug window
+    bool openGL = configurationManager->shouldUseOpenGL();
+    showDebugInfoWindow = configurationManager->shouldShowDebugInfoWindow() && !headless && openGL;
+    if (headless) {
+        mainWindow = make_unique<Window>(EmulatorName, SCREEN_WIDTH, screenHeight, openGL);
+    } else {
+        if (openGL) {
+            debugWindow = make_unique<Window>(false, EmulatorName + " - dbginfo", SCREEN_WIDTH, SCREEN_HEIGHT, !showDebugInfoWindow, true);
+        }
+        mainWindow = make_unique<Window>(true, EmulatorName, SCREEN_WIDTH, screenHeight, false, openGL);
+    }
     mainWindow->makeCurrent();
-    setupOpenGL();
-    debugInfoRenderer = make_unique<DebugInfoRenderer>(debugWindow);
+    if (openGL) {
+        setupOpenGL();
+    }
+    if (!headless && openGL) {
+        debugInfoRenderer = make_unique<DebugInfoRenderer>(debugWindow);
+    }
     cop0 = make_unique<COP0>();
     bios = make_unique<BIOS>(configurationManager->biosLogLevel());
     ram = make_unique<RAM>();
     scratchpad = make_unique<Scratchpad>();
     interruptController = make_unique<InterruptController>(configurationManager->interruptLogLevel());
     gpu = make_unique<GPU>(configurationManager->gpuLogLevel(), mainWindow, interruptController, debugInfoRenderer);
+    if (emulatorRunner->shouldRecordGPU()) {
+        gpu->startRecording(emulatorRunner->gpuRecordingFilePath());
+    }
+    if (emulatorRunner->shouldCaptureFrames()) {
+        gpu->startCapture(emulatorRunner->frameCaptureFilePath());
+    }
     LogLevel cdromLogLevel = configurationManager->cdromLogLevel();
     cdrom = make_unique<CDROM>(cdromLogLevel, interruptController);
     dma = make_unique<DMA>(configurationManager->dmaLogLevel(), ram, gpu, cdrom, interruptController);
@@ -86,7 +106,11 @@ void Emulator::dumpRAM() {
 }
 
 void Emulator::setupSDL() {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) != 0) {
+    Uint32 flags = SDL_INIT_JOYSTICK;
+    if (!headless) {
+        flags |= SDL_INIT_VIDEO;
+    }
+    if (SDL_Init(flags) != 0) {
         logger.logError("Error initializing SDL: %s", SDL_GetError());
     }
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
@@ -95,7 +119,7 @@ void Emulator::setupSDL() {
 }
 
 void Emulator::setupOpenGL() {
-    if (!gladLoadGLLoader((GLADloadproc) SDL_GL_GetProcAddress)) {
+    if (!gladLoadGLLoader(mainWindow->getProcAddressLoader())) {
         logger.logError("Failed to initialize the OpenGL context.");
     }
 }
@@ -119,6 +143,10 @@ void Emulator::toggleDebugInfoWindow() {
     debugWindow->toggleHidden();
 }
 
+bool Emulator::isHeadless() {
+    return headless;
+}
+
 void Emulator::toggleRenderPolygonOneByOne() {
     gpu->toggleRenderPolygonOneByOne();
 }
@@ -5,7 +5,7 @@
 
 using namespace std;
 
-EmulatorRunner::EmulatorRunner() : logger(LogLevel::NoLog), emulator(nullptr), runTests(false), loadExpansionROM(false), exeFile(), binFile(), romFile(), header() {}
+EmulatorRunner::EmulatorRunner() : logger(LogLevel::NoLog), emulator(nullptr), runTests(false), loadExpansionROM(false), headless(false), recordGPU(false), captureFrames(false), exeFile(), binFile(), romFile(), gpuRecordingFile(), frameCaptureFile(), header() {}
 
 EmulatorRunner* EmulatorRunner::instance = nullptr;
 
@@ -67,6 +67,28 @@ void EmulatorRunner::configure(int argc, char* argv[]) {
         }
         argumentFound = true;
     }
+    if (checkOption(argv, argv + argc, "--headless")) {
+        headless = true;
+        argumentFound = true;
+    }
+    if (checkOption(argv, argv + argc, "--record-gpu")) {
+        char *path = getOptionValue(argv, argv + argc, "--record-gpu");
+        if (path == NULL) {
+            logger.logError("Incorrect argument passed. See README.md for usage.");
+        }
+        recordGPU = true;
+        gpuRecordingFile = filesystem::current_path() / string(path);
+        argumentFound = true;
+    }
+    if (checkOption(argv, argv + argc, "--capture")) {
+        char *path = getOptionValue(argv, argv + argc, "--capture");
+        if (path == NULL) {
+            logger.logError("Incorrect argument passed. See README.md for usage.");
+        }
+        captureFrames = true;
+        frameCaptureFile = filesystem::current_path() / string(path);
+        argumentFound = true;
+    }
     if (!argumentFound) {
         logger.logError("Incorrect argument passed. See README.md for usage.");
     }
@@ -107,10 +129,30 @@ bool EmulatorRunner::shouldLoadExpansionROM() {
     return loadExpansionROM;
 }
 
+bool EmulatorRunner::shouldRunHeadless() {
+    return headless;
+}
+
+bool EmulatorRunner::shouldRecordGPU() {
+    return recordGPU;
+}
+
+bool EmulatorRunner::shouldCaptureFrames() {
+    return captureFrames;
+}
+
 std::filesystem::path EmulatorRunner::romFilePath() {
     return romFile;
 }
 
+std::filesystem::path EmulatorRunner::gpuRecordingFilePath() {
+    return gpuRecordingFile;
+}
+
+std::filesystem::path EmulatorRunner::frameCaptureFilePath() {
+    return frameCaptureFile;
+}
+
 uint32_t EmulatorRunner::programCounter() {
     return loadWord(0x10);
 }
@@ -0,0 +1,297 @@
+#include "FrameCapture.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include "Framebuffer.hpp"
+#include "RendererDebugger.hpp"
+
+using namespace std;
+
+const uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+const uint32_t DEFLATE_STORED_BLOCK_SIZE = 0xffff;
+
+static void appendBigEndian(vector<uint8_t> &data, uint32_t value) {
+    data.push_back((value >> 24) & 0xff);
+    data.push_back((value >> 16) & 0xff);
+    data.push_back((value >> 8) & 0xff);
+    data.push_back(value & 0xff);
+}
+
+static uint32_t crc32(const uint8_t *data, size_t length) {
+    static array<uint32_t, 256> table = []() {
+        array<uint32_t, 256> table = {};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                value = (value & 1) ? (0xedb88320 ^ (value >> 1)) : (value >> 1);
+            }
+            table[i] = value;
+        }
+        return table;
+    }();
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffff;
+}
+
+static void writeChunk(ofstream &file, const char *type, const vector<uint8_t> &data) {
+    vector<uint8_t> chunk = vector<uint8_t>(type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    vector<uint8_t> header;
+    appendBigEndian(header, data.size());
+    vector<uint8_t> footer;
+    appendBigEndian(footer, crc32(chunk.data(), chunk.size()));
+    file.write(reinterpret_cast<const char *>(header.data()), header.size());
+    file.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+    file.write(reinterpret_cast<const char *>(footer.data()), footer.size());
+}
+
+FrameCapture::FrameCapture(std::filesystem::path path) : logger(LogLevel::Warning), path(path), pixelBuffers(), pixelBufferSizes(), fences(), widths(), heights(), nextSlot(0), queue(), finished(false), streamWidth(0), streamHeight(0), framesWritten(0), encodeBuffer() {
+    string extension = path.extension().string();
+    transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".y4m") {
+        format = FrameCaptureFormat::FrameCaptureY4M;
+    } else if (extension == ".raw") {
+        format = FrameCaptureFormat::FrameCaptureRaw;
+    } else {
+        format = FrameCaptureFormat::FrameCapturePNG;
+    }
+    if (format == FrameCaptureFormat::FrameCapturePNG) {
+        filesystem::create_directories(path);
+    } else {
+        stream = ofstream(path, ios::out|ios::binary|ios::trunc);
+        if (!stream.is_open()) {
+            logger.logError("Unable to open frame capture file: %s", path.string().c_str());
+        }
+    }
+    fences.fill(nullptr);
+    writer = thread(&FrameCapture::writerLoop, this);
+}
+
+FrameCapture::~FrameCapture() {
+    for (uint32_t i = 0; i < FRAME_CAPTURE_RING_SIZE; i++) {
+        uint32_t slot = (nextSlot + i) % FRAME_CAPTURE_RING_SIZE;
+        if (fences[slot] != nullptr) {
+            drain(slot);
+        }
+    }
+    {
+        lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    condition.notify_one();
+    writer.join();
+    if (pixelBuffers[0] != 0) {
+        glDeleteBuffers(FRAME_CAPTURE_RING_SIZE, pixelBuffers.data());
+    }
+    if (stream.is_open()) {
+        stream.close();
+    }
+}
+
+/*
+Queues the readback of the given rectangle of the texture. The oldest slot of the ring is
+drained first, so the frame that was queued FRAME_CAPTURE_RING_SIZE frames ago gets mapped now.
+Pixel buffers are only created on the first readback, renderers without OpenGL never need them.
+*/
+void FrameCapture::capture(std::unique_ptr<Texture> &texture, GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (pixelBuffers[0] == 0) {
+        glGenBuffers(FRAME_CAPTURE_RING_SIZE, pixelBuffers.data());
+    }
+    uint32_t slot = nextSlot;
+    nextSlot = (nextSlot + 1) % FRAME_CAPTURE_RING_SIZE;
+    if (fences[slot] != nullptr) {
+        drain(slot);
+    }
+    x = clamp(x, 0, texture->getWidth());
+    y = clamp(y, 0, texture->getHeight());
+    width = min(width, texture->getWidth() - x);
+    height = min(height, texture->getHeight() - y);
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    GLsizeiptr size = ((GLsizeiptr)width) * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[slot]);
+    if (pixelBufferSizes[slot] < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        pixelBufferSizes[slot] = size;
+    }
+    {
+        Framebuffer framebuffer = Framebuffer(texture, GL_READ_FRAMEBUFFER);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    widths[slot] = width;
+    heights[slot] = height;
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+void FrameCapture::drain(uint32_t slot) {
+    while (true) {
+        GLenum result = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 10000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            break;
+        }
+    }
+    glDeleteSync(fences[slot]);
+    fences[slot] = nullptr;
+    CapturedFrame frame = { widths[slot], heights[slot], vector<uint8_t>(((size_t)widths[slot]) * heights[slot] * 4) };
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[slot]);
+    void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame.pixels.size(), GL_MAP_READ_BIT);
+    memcpy(frame.pixels.data(), data, frame.pixels.size());
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture(move(frame));
+}
+
+/*
+Hands a frame that is already in memory over to the writer thread.
+*/
+void FrameCapture::capture(CapturedFrame frame) {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        queue.push_back(move(frame));
+    }
+    condition.notify_one();
+}
+
+void FrameCapture::writerLoop() {
+    while (true) {
+        unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() {
+            return finished || !queue.empty();
+        });
+        if (queue.empty()) {
+            return;
+        }
+        CapturedFrame frame = move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        writeFrame(frame);
+    }
+}
+
+void FrameCapture::writeFrame(CapturedFrame &frame) {
+    switch (format) {
+        case FrameCaptureFormat::FrameCaptureY4M:
+        case FrameCaptureFormat::FrameCaptureRaw: {
+            writeStreamFrame(frame);
+            break;
+        }
+        case FrameCaptureFormat::FrameCapturePNG: {
+            writePNG(frame);
+            break;
+        }
+    }
+    framesWritten++;
+}
+
+/*
+Y4M and raw streams need every frame to have the same size, so frames are cropped or padded
+with black to the size of the first one when the display resolution changes mid-capture.
+Y4M frames are converted to BT.601 limited range YCbCr 4:4:4, raw frames are RGB24.
+*/
+void FrameCapture::writeStreamFrame(CapturedFrame &frame) {
+    if (framesWritten == 0) {
+        streamWidth = frame.width;
+        streamHeight = frame.height;
+        if (format == FrameCaptureFormat::FrameCaptureY4M) {
+            stream << "YUV4MPEG2 W" << streamWidth << " H" << streamHeight << " F" << FRAME_CAPTURE_FRAME_RATE << ":1 Ip A1:1 C444\n";
+        } else {
+            logger.logWarning("Capturing raw RGB24 frames of %dx%d", streamWidth, streamHeight);
+        }
+    }
+    size_t planeSize = ((size_t)streamWidth) * streamHeight;
+    encodeBuffer.assign(planeSize * 3, 0);
+    if (format == FrameCaptureFormat::FrameCaptureY4M) {
+        fill(encodeBuffer.begin(), encodeBuffer.begin() + planeSize, 16);
+        fill(encodeBuffer.begin() + planeSize, encodeBuffer.end(), 128);
+    }
+    uint32_t width = min(streamWidth, frame.width);
+    uint32_t height = min(streamHeight, frame.height);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t *row = &frame.pixels[((size_t)(frame.height - 1 - y)) * frame.width * 4];
+        for (uint32_t x = 0; x < width; x++) {
+            int32_t r = row[x * 4];
+            int32_t g = row[x * 4 + 1];
+            int32_t b = row[x * 4 + 2];
+            size_t index = ((size_t)y) * streamWidth + x;
+            if (format == FrameCaptureFormat::FrameCaptureY4M) {
+                encodeBuffer[index] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+                encodeBuffer[planeSize + index] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+                encodeBuffer[planeSize * 2 + index] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+            } else {
+                encodeBuffer[index * 3] = r;
+                encodeBuffer[index * 3 + 1] = g;
+                encodeBuffer[index * 3 + 2] = b;
+            }
+        }
+    }
+    if (format == FrameCaptureFormat::FrameCaptureY4M) {
+        stream << "FRAME\n";
+    }
+    stream.write(reinterpret_cast<const char *>(encodeBuffer.data()), encodeBuffer.size());
+}
+
+/*
+PNG files are written with stored (uncompressed) deflate blocks, which keeps the encoder cheap
+and dependency free at the cost of file size.
+*/
+void FrameCapture::writePNG(CapturedFrame &frame) {
+    encodeBuffer.clear();
+    encodeBuffer.reserve(((size_t)frame.width * 3 + 1) * frame.height);
+    for (uint32_t y = 0; y < frame.height; y++) {
+        const uint8_t *row = &frame.pixels[((size_t)(frame.height - 1 - y)) * frame.width * 4];
+        // Filter type: none
+        encodeBuffer.push_back(0);
+        for (uint32_t x = 0; x < frame.width; x++) {
+            encodeBuffer.insert(encodeBuffer.end(), row + x * 4, row + x * 4 + 3);
+        }
+    }
+
+    vector<uint8_t> header;
+    appendBigEndian(header, frame.width);
+    appendBigEndian(header, frame.height);
+    // 8 bit depth, truecolor, deflate, adaptive filtering, no interlace
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });
+
+    vector<uint8_t> data = { 0x78, 0x01 };
+    data.reserve(encodeBuffer.size() + (encodeBuffer.size() / DEFLATE_STORED_BLOCK_SIZE + 1) * 5 + 6);
+    size_t offset = 0;
+    do {
+        uint32_t length = min((size_t)DEFLATE_STORED_BLOCK_SIZE, encodeBuffer.size() - offset);
+        bool last = offset + length == encodeBuffer.size();
+        data.push_back(last ? 1 : 0);
+        data.push_back(length & 0xff);
+        data.push_back((length >> 8) & 0xff);
+        data.push_back(~length & 0xff);
+        data.push_back((~length >> 8) & 0xff);
+        data.insert(data.end(), encodeBuffer.begin() + offset, encodeBuffer.begin() + offset + length);
+        offset += length;
+    } while (offset < encodeBuffer.size());
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (uint8_t value : encodeBuffer) {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(data, (b << 16) | a);
+
+    stringstream fileName = stringstream();
+    fileName << "frame_" << setfill('0') << setw(6) << framesWritten << ".png";
+    ofstream file = ofstream(path / fileName.str(), ios::out|ios::binary|ios::trunc);
+    if (!file.is_open()) {
+        logger.logError("Unable to open frame capture file: %s", (path / fileName.str()).string().c_str());
+    }
+    file.write(reinterpret_cast<const char *>(PNG_SIGNATURE), sizeof(PNG_SIGNATURE));
+    writeChunk(file, "IHDR", header);
+    writeChunk(file, "IDAT", data);
+    writeChunk(file, "IEND", {});
+    file.close();
+}
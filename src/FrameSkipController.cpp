@@ -0,0 +1,47 @@
+#include "FrameSkipController.hpp"
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+FrameSkipController::FrameSkipController(bool enabled, uint32_t maximumSkippedFrames, uint32_t frameRate) : enabled(enabled), maximumSkippedFrames(maximumSkippedFrames), frameBudget(duration_cast<steady_clock::duration>(duration<double>(1.0 / frameRate))), lastFrame(), lag(steady_clock::duration::zero()), consecutiveSkippedFrames(0), started(false) {}
+
+FrameSkipController::~FrameSkipController() {}
+
+void FrameSkipController::setEnabled(bool enabled) {
+    this->enabled = enabled;
+    lag = steady_clock::duration::zero();
+    consecutiveSkippedFrames = 0;
+    started = false;
+}
+
+bool FrameSkipController::shouldSkipFrame() {
+    return shouldSkipFrame(steady_clock::now());
+}
+
+bool FrameSkipController::shouldSkipFrame(steady_clock::time_point now) {
+    if (!enabled) {
+        return false;
+    }
+    if (!started) {
+        started = true;
+        lastFrame = now;
+        return false;
+    }
+    steady_clock::duration elapsed = now - lastFrame;
+    lastFrame = now;
+    if (elapsed > frameBudget * FRAME_SKIP_STALL_FRAMES) {
+        lag = steady_clock::duration::zero();
+        consecutiveSkippedFrames = 0;
+        return false;
+    }
+    // Frames that finish early can only pay back lag, never bank time for later ones. A skip needs
+    // more than a whole frame of lag, so the cap leaves room for one above the maximum skipped.
+    lag = clamp(lag + elapsed - frameBudget, steady_clock::duration::zero(), frameBudget * (maximumSkippedFrames + 1));
+    if (lag > frameBudget && consecutiveSkippedFrames < maximumSkippedFrames) {
+        consecutiveSkippedFrames++;
+        return true;
+    }
+    consecutiveSkippedFrames = 0;
+    return false;
+}
@@ -1,9 +1,15 @@
 #include "Framebuffer.hpp"
 
-Framebuffer::Framebuffer(std::unique_ptr<Texture> &texture) {
+Framebuffer::Framebuffer(std::unique_ptr<Texture> &texture) : Framebuffer(texture, GL_FRAMEBUFFER) {}
+
+Framebuffer::Framebuffer(std::unique_ptr<Texture> &texture, GLenum target) {
     glGenFramebuffers(1, &object);
-    glBindFramebuffer(GL_FRAMEBUFFER, object);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->getID(), 0);
+    glBindFramebuffer(target, object);
+    glFramebufferTexture2D(target, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->getID(), 0);
+    if (target == GL_READ_FRAMEBUFFER) {
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        return;
+    }
     glDrawBuffer(GL_COLOR_ATTACHMENT0);
     glViewport(0, 0, texture->getWidth(), texture->getHeight());
 }
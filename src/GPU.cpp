@@ -4,6 +4,8 @@
 #include "ConfigurationManager.hpp"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <climits>
 
 using namespace std;
 
@@ -50,17 +52,27 @@ GPU::GPU(LogLevel logLevel, std::unique_ptr<Window> &mainWindow, std::unique_ptr
              gp0WordsRemaining(0),
              gp0WordsRead(0),
              gp0InstructionMethod(nullptr),
+             vramReadBuffer(),
+             vramReadIndex(0),
              gp0Mode(GP0Mode::Command),
              imageBuffer(make_unique<GPUImageBuffer>()),
              interruptController(interruptController),
              videoSystemClocksScanlineCounter(0),
              scanlineCounter(0),
              debugInfoRenderer(debugInfoRenderer),
-             frameCounter(0)
+             frameCounter(0),
+             recorder(),
+             frameSkipController(),
+             displayListRecording(nullptr)
 {
-    renderer = make_unique<Renderer>(mainWindow, this);
     ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
-    showDebugInfoWindow = configurationManager->shouldShowDebugInfoWindow();
+    renderer = Renderer::forBackend(configurationManager->rendererBackend(), mainWindow, this);
+    headless = mainWindow->isHeadless();
+    // The debug window draws with OpenGL, so it is not available to the software renderer
+    showDebugInfoWindow = configurationManager->shouldShowDebugInfoWindow() && !headless && mainWindow->hasOpenGLContext();
+    // Headless runs aren't paced, so there is no target speed to hold
+    bool autoFrameSkip = configurationManager->shouldUseAutoFrameSkip() && !headless;
+    frameSkipController = make_unique<FrameSkipController>(autoFrameSkip, configurationManager->maxSkippedFrames(), FrameRateTarget);
 }
 
 GPU::~GPU() {
@@ -117,10 +129,17 @@ uint32_t GPU::statusRegister() const {
 }
 
 void GPU::executeGp0(uint32_t value) {
+    if (recorder) {
+        recorder->recordGp0(value);
+    }
     if (gp0WordsRemaining == 0) {
         gp0WordsRead = 0;
         uint32_t opCode = (value >> 24) & 0xff;
         logger.logMessage("GP0 [W] with opcode: %#x (%#x)", opCode, value);
+        // Only drawing commands can be replayed, anything else changes state or VRAM directly
+        if (displayListRecording && opCode != 0x00 && (opCode < 0x20 || opCode > 0x7f)) {
+            displayListRecording->cacheable = false;
+        }
         switch (opCode) {
             case 0x00: {
                 gp0WordsRemaining = 1;
@@ -507,6 +526,13 @@ void GPU::executeGp0(uint32_t value) {
                 };
                 break;
             }
+            case 0x80: {
+                gp0WordsRemaining = 4;
+                gp0InstructionMethod = [&]() {
+                    this->operationGp0CopyRectangleVRAMToVRAM();
+                };
+                break;
+            }
             case 0xa0: {
                 gp0WordsRemaining = 3;
                 gp0InstructionMethod = [&]() {
@@ -590,6 +616,98 @@ void GPU::executeGp0(uint32_t value) {
     }
 }
 
+bool GPU::isLoadingImage() const {
+    return gp0Mode == GP0Mode::ImageLoad && gp0WordsRemaining > 0;
+}
+
+/*
+Takes the words of the image being loaded straight from a block of memory, stored little endian
+as in RAM, instead of one executeGp0 call per word. Returns how many of them were consumed, which
+stops at the end of the image.
+*/
+uint32_t GPU::loadImageWords(const uint8_t *data, uint32_t count) {
+    uint32_t words = min(count, (uint32_t)gp0WordsRemaining);
+    if (recorder) {
+        for (uint32_t i = 0; i < words; i++) {
+            const uint8_t *word = &data[i * 4];
+            recorder->recordGp0(word[0] | (word[1] << 8) | (word[2] << 16) | (((uint32_t)word[3]) << 24));
+        }
+    }
+    imageBuffer->pushWords(data, words);
+    gp0WordsRemaining -= words;
+    if (gp0WordsRemaining == 0) {
+        renderer->loadImage(imageBuffer);
+        gp0Mode = GP0Mode::Command;
+    }
+    return words;
+}
+
+/*
+Packets can only be recorded or replayed between commands, and not while GP0 is being recorded,
+since replaying skips the words.
+*/
+bool GPU::canCacheDisplayList() const {
+    return gp0WordsRemaining == 0 && gp0Mode == GP0Mode::Command && !recorder;
+}
+
+DisplayListState GPU::displayListState() const {
+    return {
+        texturePageBaseX,
+        texturePageBaseY,
+        (uint8_t)texturePageColors,
+        semiTransparency,
+        drawingAreaTop,
+        drawingAreaLeft,
+        drawingAreaBottom,
+        drawingAreaRight,
+        drawingOffsetX,
+        drawingOffsetY,
+    };
+}
+
+void GPU::startDisplayListRecording(DisplayListPacket *packet) {
+    displayListRecording = packet;
+}
+
+/*
+A packet that ends in the middle of a command leaves state behind for the next one, so it can't
+be replayed on its own.
+*/
+void GPU::stopDisplayListRecording() {
+    if (gp0WordsRemaining != 0 || gp0Mode != GP0Mode::Command) {
+        displayListRecording->cacheable = false;
+    }
+    displayListRecording = nullptr;
+}
+
+void GPU::replayDisplayList(const DisplayListPacket &packet) {
+    for (const DisplayListCommand &command : packet.commands) {
+        switch (command.type) {
+            case DisplayListPolygon: {
+                renderer->pushPolygon(command.vertices, command.opaque, command.textureBlendMode);
+                break;
+            }
+            case DisplayListLine: {
+                renderer->pushLine(command.vertices, command.opaque);
+                break;
+            }
+            case DisplayListRectangle: {
+                renderer->pushRectangle(command.rectangle);
+                break;
+            }
+            case DisplayListSemiTransparency: {
+                semiTransparency = command.semiTransparency;
+                renderer->setSemiTransparencyMode(command.semiTransparency);
+                break;
+            }
+        }
+    }
+}
+
+void GPU::countDisplayListPacket(RendererDisplayListPacket packet) {
+    renderer->countDisplayListPacket(packet);
+}
+
 void GPU::step(uint32_t cycles) {
     uint32_t videoSystemClockStep = cycles*11/7;
     videoSystemClocksScanlineCounter += videoSystemClockStep;
@@ -599,6 +717,9 @@ void GPU::step(uint32_t cycles) {
     }
     if (scanlineCounter >= ScanlinesPerFrame) {
         scanlineCounter = 0;
+        if (recorder) {
+            recorder->recordVBlank();
+        }
         render();
         interruptController->trigger(VBLANK);
     }
@@ -608,20 +729,87 @@ void GPU::render() {
     frameCounter++;
     logger.logMessage("Rendering frame: %ld", frameCounter);
     renderer->prepareFrame();
-    renderer->renderFrame();
+    renderer->renderFrame(RendererFlushReason::RendererFlushReasonFrameEnd);
+    // Skipped frames are still drawn into VRAM, only presenting them is left out
+    if (frameSkipController->shouldSkipFrame()) {
+        renderer->skipFrame();
+        return;
+    }
     renderer->finalizeFrame();
     if (showDebugInfoWindow) {
+        debugInfoRenderer->setRendererStatisticsHistory(renderer->getStatisticsHistory());
         debugInfoRenderer->update();
         // This application makes most of the OpenGL work on the main window, so after
         // we are doine with the debug window we forget about it until the next time to update
         renderer->resetMainWindow();
     }
+    if (headless) {
+        return;
+    }
     stringstream title = stringstream();
     title << EmulatorName;
     title << " - " << dec << frameCounter << " frames";
     renderer->updateWindowTitle(title.str());
 }
 
+/*
+Starts recording GP0 and GP1 words to the given file. The current VRAM contents and register
+state are written first, as the GP0/GP1 commands that restore them, so that a replay doesn't
+depend on what happened before the recording started.
+*/
+void GPU::startRecording(std::filesystem::path filePath) {
+    if (gp0WordsRemaining != 0) {
+        logger.logError("Unable to start recording in the middle of a GP0 command");
+    }
+    recorder = make_unique<GPURecorder>(filePath);
+    uint8_t horizontalResolutionValue1 = (horizontalResolution >> 1) & 3;
+    uint8_t horizontalResolutionValue2 = horizontalResolution & 1;
+    recorder->recordGp1((0x08 << 24) | horizontalResolutionValue1 | (((uint32_t)verticalResolution) << 2) | (((uint32_t)videoMode) << 3) | (((uint32_t)displayAreaColorDepth) << 4) | (((uint32_t)verticalInterlaceEnable) << 5) | (horizontalResolutionValue2 << 6));
+    recorder->recordGp1((0x05 << 24) | displayVRAMStartX | (((uint32_t)displayVRAMStartY) << 10));
+    recorder->recordGp1((0x06 << 24) | displayHorizontalStart | (((uint32_t)displayHorizontalEnd) << 12));
+    recorder->recordGp1((0x07 << 24) | displayLineStart | (((uint32_t)displayLineEnd) << 10));
+    recorder->recordGp1((0x03 << 24) | ((uint32_t)displayDisable));
+    recorder->recordGp1((0x04 << 24) | ((uint32_t)dmaDirection));
+
+    vector<uint16_t> vram = renderer->readVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+    recorder->recordGp0(0xa0 << 24);
+    recorder->recordGp0(0);
+    recorder->recordGp0((VRAM_HEIGHT << 16) | VRAM_WIDTH);
+    for (uint32_t i = 0; i < vram.size(); i += 2) {
+        recorder->recordGp0(vram[i] | (((uint32_t)vram[i + 1]) << 16));
+    }
+
+    uint32_t drawMode = texturePageBaseX;
+    drawMode |= ((uint32_t)texturePageBaseY) << 4;
+    drawMode |= ((uint32_t)semiTransparency) << 5;
+    drawMode |= ((uint32_t)texturePageColors) << 7;
+    drawMode |= ((uint32_t)ditheringEnable) << 9;
+    drawMode |= ((uint32_t)allowDrawToDisplayArea) << 10;
+    drawMode |= ((uint32_t)textureDisable) << 11;
+    drawMode |= ((uint32_t)rectangleTextureFlipX) << 12;
+    drawMode |= ((uint32_t)rectangleTextureFlipY) << 13;
+    recorder->recordGp0((0xe1 << 24) | drawMode);
+    recorder->recordGp0((0xe2 << 24) | textureWindowMaskX | (((uint32_t)textureWindowMaskY) << 5) | (((uint32_t)textureWindowOffsetX) << 10) | (((uint32_t)textureWindowOffsetY) << 15));
+    recorder->recordGp0((0xe3 << 24) | drawingAreaLeft | (((uint32_t)drawingAreaTop) << 10));
+    recorder->recordGp0((0xe4 << 24) | drawingAreaRight | (((uint32_t)drawingAreaBottom) << 10));
+    recorder->recordGp0((0xe5 << 24) | (((uint32_t)drawingOffsetX) & 0x7ff) | ((((uint32_t)drawingOffsetY) & 0x7ff) << 11));
+    recorder->recordGp0((0xe6 << 24) | ((uint32_t)shouldSetMaskBit) | (((uint32_t)shouldPreserveMaskedPixels) << 1));
+}
+
+void GPU::startCapture(std::filesystem::path filePath) {
+    // Captures need every frame
+    frameSkipController->setEnabled(false);
+    renderer->startCapture(filePath);
+}
+
+RendererStatistics GPU::getRendererStatistics() {
+    return renderer->getTotalStatistics();
+}
+
+std::deque<RendererStatistics> GPU::getRendererStatisticsHistory() {
+    return renderer->getStatisticsHistory();
+}
+
 void GPU::updateDrawingArea() {
     Point2D topLeft = getDrawingAreaTopLeft();
     Dimensions size = getDrawingAreaSize();
@@ -676,6 +864,9 @@ void GPU::toggleRenderPolygonOneByOne() {
 }
 
 void GPU::executeGp1(uint32_t value) {
+    if (recorder) {
+        recorder->recordGp1(value);
+    }
     uint32_t opCode = (value >> 24) & 0xff;
     switch (opCode) {
         case 0x00: {
@@ -748,8 +939,10 @@ void GPU::operationGp0DrawMode() {
     texturePageBaseX = value & 0xf;
     texturePageBaseY = (value >> 4) & 1;
     semiTransparency = (value >> 5) & 3;
+    renderer->setSemiTransparencyMode(semiTransparency);
     texturePageColors = texturePageColorsWithValue((value >> 7) & 3);
     ditheringEnable = ((value >> 9) & 1) != 0;
+    renderer->setDithering(ditheringEnable);
     allowDrawToDisplayArea = ((value >> 10) & 1) != 0;
     textureDisable = ((value >> 11) & 1) != 0;
     rectangleTextureFlipX = ((value >> 12) & 1) != 0;
@@ -778,6 +971,7 @@ void GPU::operationGp1Reset(uint32_t value) {
     texturePageBaseX = 0;
     texturePageBaseY = 0;
     semiTransparency = 0;
+    renderer->setSemiTransparencyMode(semiTransparency);
     texturePageColors = TexturePageColors::T4Bit;
     textureWindowMaskX = 0;
     textureWindowMaskY = 0;
@@ -794,6 +988,9 @@ void GPU::operationGp1Reset(uint32_t value) {
     drawingAreaBottom = 0;
     shouldSetMaskBit = false;
     shouldPreserveMaskedPixels = false;
+    renderer->setDithering(ditheringEnable);
+    renderer->setTextureWindow(textureWindowMaskX, textureWindowMaskY, textureWindowOffsetX, textureWindowOffsetY);
+    renderer->setMaskBitSetting(shouldSetMaskBit, shouldPreserveMaskedPixels);
 
     dmaDirection = GPUDMADirection::Off;
 
@@ -815,11 +1012,23 @@ void GPU::operationGp1Reset(uint32_t value) {
     // TODO: invalidate GPU cache
 }
 
-uint32_t GPU::readRegister() const {
+uint32_t GPU::readRegister() {
+    if (vramReadIndex < vramReadBuffer.size()) {
+        uint32_t low = vramReadBuffer[vramReadIndex++];
+        uint32_t high = 0;
+        if (vramReadIndex < vramReadBuffer.size()) {
+            high = vramReadBuffer[vramReadIndex++];
+        }
+        gpuRead = (high << 16) | low;
+    }
     logger.logMessage("GPUREAD [R]: %#x", gpuRead);
     return gpuRead;
 }
 
+uint32_t GPU::loadWordFromReadBuffer() {
+    return readRegister();
+}
+
 /*
 GP1(08h) - Display mode
 0-1   Horizontal Resolution 1     (0=256, 1=320, 2=512, 3=640) ;GPUSTAT.17-18
@@ -925,6 +1134,7 @@ void GPU::operationGp0TextureWindowSetting() {
     textureWindowMaskY = ((value >> 5) & 0x1f);
     textureWindowOffsetX = ((value >> 10) & 0x1f);
     textureWindowOffsetY = ((value >> 15) & 0x1f);
+    renderer->setTextureWindow(textureWindowMaskX, textureWindowMaskY, textureWindowOffsetX, textureWindowOffsetY);
 }
 
 /*
@@ -938,6 +1148,7 @@ void GPU::operationGp0MaskBitSetting() {
     uint32_t value = gp0InstructionBuffer[0];
     shouldSetMaskBit = (value & 1) != 0;
     shouldPreserveMaskedPixels = (value & 2) != 0;
+    renderer->setMaskBitSetting(shouldSetMaskBit, shouldPreserveMaskedPixels);
 }
 
 /*
@@ -1013,6 +1224,28 @@ void GPU::operationGp1DisplayEnable(uint32_t value) {
     displayDisable = (value & 1) != 0;
 }
 
+/*
+GP0(80h) - Copy Rectangle (VRAM to VRAM)
+1st  Command           (Cc000000h)
+2nd  Source Coord      (YyyyXxxxh)  ;Xpos counted in halfwords
+3rd  Destination Coord (YyyyXxxxh)  ;Xpos counted in halfwords
+4th  Width+Height      (YsizXsizh)  ;Xsiz counted in halfwords
+*/
+void GPU::operationGp0CopyRectangleVRAMToVRAM() {
+    uint32_t source = gp0InstructionBuffer[1];
+    uint32_t destination = gp0InstructionBuffer[2];
+    uint32_t resolution = gp0InstructionBuffer[3];
+    uint16_t sourceX = source & 0x3ff;
+    uint16_t sourceY = (source >> 16) & 0x1ff;
+    uint16_t destinationX = destination & 0x3ff;
+    uint16_t destinationY = (destination >> 16) & 0x1ff;
+    uint16_t width = ((((resolution & 0xffff) - 1) & 0x3ff) + 1);
+    uint16_t height = ((((resolution >> 16) - 1) & 0x1ff) + 1);
+
+    logger.logMessage("GP0 Copy Rectangle VRAM to VRAM from: %d, %d to: %d, %d with resolution: %d x %d", sourceX, sourceY, destinationX, destinationY, width, height);
+    renderer->copyRectangle(Point2D(sourceX, sourceY), Point2D(destinationX, destinationY), Dimensions(width, height), shouldSetMaskBit, shouldPreserveMaskedPixels);
+}
+
 /*
 GP0(C0h) - Copy Rectangle (VRAM to CPU)
 1st  Command           (Cc000000h) ;\
@@ -1021,11 +1254,16 @@ GP0(C0h) - Copy Rectangle (VRAM to CPU)
 ...  Data              (...)       ;<--- read from GPUREAD port (or via DMA)
 */
 void GPU::operationGp0CopyRectangleVRAMToCPU() {
+    uint32_t position = gp0InstructionBuffer[1];
+    uint16_t x = position & 0x3ff;
+    uint16_t y = (position >> 16) & 0x1ff;
     uint32_t resolution = gp0InstructionBuffer[2];
-    uint32_t width = resolution & 0xffff;
-    uint32_t height = resolution >> 16;
+    uint16_t width = ((((resolution & 0xffff) - 1) & 0x3ff) + 1);
+    uint16_t height = ((((resolution >> 16) - 1) & 0x1ff) + 1);
 
-    logger.logWarning("Unhandled GP0 Copy Rectangle VRAM to CPU with with resolution: %d x %d", width, height);
+    logger.logMessage("GP0 Copy Rectangle VRAM to CPU at: %d, %d with resolution: %d x %d", x, y, width, height);
+    vramReadBuffer = renderer->readVRAM(x, y, width, height);
+    vramReadIndex = 0;
 }
 
 /*
@@ -1822,107 +2060,190 @@ GP0(02h) - Fill Rectangle in VRAM
 3rd  Width+Height      (YsizXsizh)  ;Xsiz counted in halfwords, steps of 10h
 */
 void GPU::operationGp0FillRectagleInVRAM() {
-    Color color = Color(gp0InstructionBuffer[0]);
-    Point3D point = Point3D(gp0InstructionBuffer[1]);
-    Dimensions dimentions = Dimensions(gp0InstructionBuffer[2]);
-    Vertex topLeft = Vertex(point, color, true);
-    uint32_t width = dimentions.width;
-    uint32_t height = dimentions.height;
-    Vertex topRight = Vertex(gp0InstructionBuffer[1], color, true);
-    topRight.point.x = topRight.point.x + width;
-    Vertex bottomLeft = Vertex(gp0InstructionBuffer[1], color, true);
-    bottomLeft.point.y = bottomLeft.point.y + height;
-    Vertex bottomRight = Vertex(gp0InstructionBuffer[1], color, true);
-    bottomRight.point.x = bottomRight.point.x + width;
-    bottomRight.point.y = bottomRight.point.y + height;
-    vector<Vertex> vertices = {
-        topLeft,
-        topRight,
-        bottomLeft,
-        bottomRight,
-    };
-    renderer->setDrawingOffset(0, 0);
-    renderer->pushPolygon(vertices, true, TextureBlendMode::TextureBlendModeNoTexture);
-    renderer->setDrawingOffset(drawingOffsetX, drawingOffsetY);
+    // Fills ignore the drawing offset, the drawing area and the mask bit settings, and write the
+    // color converted to 15bit with the mask bit cleared
+    uint32_t color = gp0InstructionBuffer[0];
+    uint16_t value = ((color >> 3) & 0x1f) | (((color >> 11) & 0x1f) << 5) | (((color >> 19) & 0x1f) << 10);
+    uint32_t x = gp0InstructionBuffer[1] & 0x3f0;
+    uint32_t y = (gp0InstructionBuffer[1] >> 16) & 0x1ff;
+    uint32_t width = ((gp0InstructionBuffer[2] & 0x3ff) + 0xf) & ~0xf;
+    uint32_t height = (gp0InstructionBuffer[2] >> 16) & 0x1ff;
+    // The area wraps around VRAM, so it is split in up to four rectangles that each fit in it
+    for (uint32_t row = 0; row < height;) {
+        uint32_t top = (y + row) & (VRAM_HEIGHT - 1);
+        uint32_t rows = min(height - row, VRAM_HEIGHT - top);
+        for (uint32_t column = 0; column < width;) {
+            uint32_t left = (x + column) & (VRAM_WIDTH - 1);
+            uint32_t columns = min(width - column, VRAM_WIDTH - left);
+            renderer->fillRectangle(Point2D(left, top), Dimensions(columns, rows), value);
+            column += columns;
+        }
+        row += rows;
+    }
     return;
 }
 
 void GPU::texturedQuad(Dimensions dimensions, bool opaque, TextureBlendMode textureBlendMode) {
+    // Sizes are limited to 1023x511, empty rectangles and ones outside the drawing area draw nothing
+    dimensions = Dimensions(dimensions.width & 0x3ff, dimensions.height & 0x1ff);
+    Point2D point = Point2D::forVertexPosition(gp0InstructionBuffer[1]);
+    if (dimensions.width == 0 || dimensions.height == 0 || isOutsideDrawingArea(point.x, point.y, point.x + dimensions.width - 1, point.y + dimensions.height - 1)) {
+        return;
+    }
     Color color = Color(gp0InstructionBuffer[0]);
-    Point3D point1 = Point3D(gp0InstructionBuffer[1]);
-    Point2D texturePoint1 = Point2D::forTexturePosition(gp0InstructionBuffer[2] & 0xffff);
-    Point3D point2 = Point3D(gp0InstructionBuffer[1]);
-    point2.x += dimensions.width;
-    Point2D texturePoint2 = Point2D::forTexturePosition(gp0InstructionBuffer[2] & 0xffff);
-    texturePoint2.x += dimensions.width;
-    Point3D point3 = Point3D(gp0InstructionBuffer[1]);
-    point3.y += dimensions.height;
-    Point2D texturePoint3 = Point2D::forTexturePosition(gp0InstructionBuffer[2] & 0xffff);
-    texturePoint3.y += dimensions.height;
-    Point3D point4 = Point3D(gp0InstructionBuffer[1]);
-    point4.x += dimensions.width;
-    point4.y += dimensions.height;
-    Point2D texturePoint4 = Point2D::forTexturePosition(gp0InstructionBuffer[2] & 0xffff);
-    texturePoint4.x += dimensions.width;
-    texturePoint4.y += dimensions.height;
+    Point2D texturePoint = Point2D::forTexturePosition(gp0InstructionBuffer[2] & 0xffff);
     uint16_t texturePageData = texturePageBaseY;
     texturePageData <<= 4;
     texturePageData |= texturePageBaseX;
     Point2D texturePage = Point2D::forTexturePage(texturePageData);
     GLuint textureDepthShift = 2 - texturePageColors;
     Point2D clut = Point2D::forClut(gp0InstructionBuffer[2] >> 16);
-    vector<Vertex> vertices = {
-        Vertex(point1, color, opaque, texturePoint1, textureBlendMode, texturePage, textureDepthShift, clut),
-        Vertex(point2, color, opaque, texturePoint2, textureBlendMode, texturePage, textureDepthShift, clut),
-        Vertex(point3, color, opaque, texturePoint3, textureBlendMode, texturePage, textureDepthShift, clut),
-        Vertex(point4, color, opaque, texturePoint4, textureBlendMode, texturePage, textureDepthShift, clut),
-    };
-    renderer->pushPolygon(vertices, opaque, textureBlendMode);
+    RectangleInstance rectangle = RectangleInstance(point, dimensions, color, opaque, texturePoint, textureBlendMode, texturePage, textureDepthShift, clut);
+    pushRectangle(rectangle);
     return;
 }
 
 void GPU::quad(Dimensions dimensions, bool opaque) {
+    dimensions = Dimensions(dimensions.width & 0x3ff, dimensions.height & 0x1ff);
+    Point2D point = Point2D::forVertexPosition(gp0InstructionBuffer[1]);
+    if (dimensions.width == 0 || dimensions.height == 0 || isOutsideDrawingArea(point.x, point.y, point.x + dimensions.width - 1, point.y + dimensions.height - 1)) {
+        return;
+    }
     Color color = Color(gp0InstructionBuffer[0]);
-    Point3D point = Point3D(gp0InstructionBuffer[1]);
-    Vertex topLeft = Vertex(point, color, opaque);
-    Vertex topRight = Vertex(point, color, opaque);
-    topRight.point.x += + dimensions.width;
-    Vertex bottomLeft = Vertex(point, color, opaque);
-    bottomLeft.point.y += dimensions.height;
-    Vertex bottomRight = Vertex(point, color, opaque);
-    bottomRight.point.x += dimensions.width;
-    bottomRight.point.y += dimensions.height;
-    vector<Vertex> vertices = {
-        topLeft,
-        topRight,
-        bottomLeft,
-        bottomRight,
-    };
-    renderer->pushPolygon(vertices, opaque, TextureBlendMode::TextureBlendModeNoTexture);
+    RectangleInstance rectangle = RectangleInstance(point, dimensions, color, opaque);
+    pushRectangle(rectangle);
     return;
 }
 
+/*
+Takes the bounding box of a primitive before the drawing offset is applied, edges included.
+*/
+bool GPU::isOutsideDrawingArea(int32_t left, int32_t top, int32_t right, int32_t bottom) const {
+    left += drawingOffsetX;
+    right += drawingOffsetX;
+    top += drawingOffsetY;
+    bottom += drawingOffsetY;
+    return right < drawingAreaLeft || left > drawingAreaRight || bottom < drawingAreaTop || top > drawingAreaBottom;
+}
+
+/*
+The GPU skips triangles and lines spanning 1024 or more pixels horizontally or 512 or more
+vertically, and nothing is ever drawn outside the drawing area, so neither kind of primitive is sent
+to the renderer. Positions are read straight from the GP0 words, before any vertex is built, and
+decoded as the same 11-bit signed values the vertices get.
+*/
+bool GPU::isPrimitiveDrawn(std::initializer_list<unsigned int> positionWords) {
+    int32_t left = INT32_MAX;
+    int32_t top = INT32_MAX;
+    int32_t right = INT32_MIN;
+    int32_t bottom = INT32_MIN;
+    for (unsigned int word : positionWords) {
+        Point2D point = Point2D::forVertexPosition(gp0InstructionBuffer[word]);
+        left = min(left, (int32_t)point.x);
+        top = min(top, (int32_t)point.y);
+        right = max(right, (int32_t)point.x);
+        bottom = max(bottom, (int32_t)point.y);
+    }
+    if (right - left >= (int32_t)VRAM_WIDTH || bottom - top >= (int32_t)VRAM_HEIGHT) {
+        return false;
+    }
+    return !isOutsideDrawingArea(left, top, right, bottom);
+}
+
+/*
+Quads are drawn as two triangles, the first three vertices and the last three, and the hardware
+checks each one on its own. Returns a mask with a bit per triangle that is drawn. Vertex positions
+are the second word of the command and repeat every wordsPerVertex words.
+*/
+uint8_t GPU::drawnTriangles(unsigned int numberOfPoints, unsigned int wordsPerVertex) {
+    uint8_t triangles = 0;
+    for (unsigned int triangle = 0; triangle + 2 < numberOfPoints; triangle++) {
+        unsigned int word = 1 + triangle * wordsPerVertex;
+        if (isPrimitiveDrawn({ word, word + wordsPerVertex, word + 2 * wordsPerVertex })) {
+            triangles |= 1 << triangle;
+        }
+    }
+    return triangles;
+}
+
+void GPU::pushDrawnTriangles(std::vector<Vertex> vertices, uint8_t triangles, bool opaque, TextureBlendMode textureBlendMode) {
+    if (vertices.size() == 4 && triangles == 0b01) {
+        vertices.pop_back();
+    } else if (vertices.size() == 4 && triangles == 0b10) {
+        vertices.erase(vertices.begin());
+    }
+    pushPolygon(vertices, opaque, textureBlendMode);
+}
+
+/*
+The renderer is only reached through these while decoding drawing commands, so a packet being
+recorded for the display list cache sees every call.
+*/
+void GPU::pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) {
+    if (displayListRecording) {
+        displayListRecording->commands.push_back(DisplayListCommand(DisplayListPolygon, vertices, opaque, textureBlendMode));
+    }
+    renderer->pushPolygon(vertices, opaque, textureBlendMode);
+}
+
+void GPU::pushLine(std::vector<Vertex> vertices, bool opaque) {
+    if (displayListRecording) {
+        displayListRecording->commands.push_back(DisplayListCommand(DisplayListLine, vertices, opaque, TextureBlendModeNoTexture));
+    }
+    renderer->pushLine(vertices, opaque);
+}
+
+void GPU::pushRectangle(RectangleInstance rectangle) {
+    if (displayListRecording) {
+        displayListRecording->commands.push_back(DisplayListCommand(rectangle));
+    }
+    renderer->pushRectangle(rectangle);
+}
+
+void GPU::updateSemiTransparency(uint8_t mode) {
+    if (displayListRecording) {
+        displayListRecording->commands.push_back(DisplayListCommand(mode));
+    }
+    semiTransparency = mode;
+    renderer->setSemiTransparencyMode(mode);
+}
+
 void GPU::monochromePolygon(unsigned int numberOfPoints, bool opaque) {
+    uint8_t triangles = drawnTriangles(numberOfPoints, 1);
+    if (triangles == 0) {
+        return;
+    }
     Color color = Color(gp0InstructionBuffer[0]);
     vector<Vertex> vertices = vector<Vertex>();
     for (unsigned int i = 1; i <= numberOfPoints; i++) {
         Point3D point = Point3D(gp0InstructionBuffer[i]);
         vertices.push_back(Vertex(point, color, opaque));
     }
-    renderer->pushPolygon(vertices, opaque, TextureBlendMode::TextureBlendModeNoTexture);
+    pushDrawnTriangles(vertices, triangles, opaque, TextureBlendMode::TextureBlendModeNoTexture);
 }
 
 void GPU::shadedPolygon(unsigned int numberOfPoints, bool opaque) {
+    uint8_t triangles = drawnTriangles(numberOfPoints, 2);
+    if (triangles == 0) {
+        return;
+    }
     vector<Vertex> vertices = vector<Vertex>();
     for (unsigned int i = 0; i < numberOfPoints; i++) {
         Color color = Color(gp0InstructionBuffer[i*2]);
         Point3D point = Point3D(gp0InstructionBuffer[i*2+1]);
         vertices.push_back(Vertex(point, color, opaque));
     }
-    renderer->pushPolygon(vertices, opaque, TextureBlendMode::TextureBlendModeNoTexture);
+    pushDrawnTriangles(vertices, triangles, opaque, TextureBlendMode::TextureBlendModeNoTexture);
 }
 
 void GPU::texturedPolygon(unsigned int numberOfPoints, bool opaque, TextureBlendMode textureBlendMode) {
+    // The Texpage attribute of textured polygons also updates GPUSTAT, semi transparency included,
+    // even when the polygon isn't drawn
+    updateSemiTransparency(((gp0InstructionBuffer[4] >> 16) >> 5) & 0x3);
+    uint8_t triangles = drawnTriangles(numberOfPoints, 2);
+    if (triangles == 0) {
+        return;
+    }
     Color color = Color(gp0InstructionBuffer[0]);
     Point2D clut = Point2D::forClut(gp0InstructionBuffer[2] >> 16);
     Point2D texturePage = Point2D::forTexturePage(gp0InstructionBuffer[4] >> 16);
@@ -1936,10 +2257,15 @@ void GPU::texturedPolygon(unsigned int numberOfPoints, bool opaque, TextureBlend
         Vertex vertex = Vertex(point, color, opaque, texturePoint, textureBlendMode, texturePage, textureDepthShift, clut);
         vertices.push_back(vertex);
     }
-    renderer->pushPolygon(vertices, opaque, textureBlendMode);
+    pushDrawnTriangles(vertices, triangles, opaque, textureBlendMode);
 }
 
 void GPU::shadedTexturedPolygon(unsigned int numberOfPoints, bool opaque, TextureBlendMode textureBlendMode) {
+    updateSemiTransparency(((gp0InstructionBuffer[5] >> 16) >> 5) & 0x3);
+    uint8_t triangles = drawnTriangles(numberOfPoints, 3);
+    if (triangles == 0) {
+        return;
+    }
     Point2D clut = Point2D::forClut(gp0InstructionBuffer[2] >> 16);
     Point2D texturePage = Point2D::forTexturePage(gp0InstructionBuffer[5] >> 16);
     TexturePageColors texturePageColors = texturePageColorsWithValue(((gp0InstructionBuffer[5] >> 16) >> 7) & 0x3);
@@ -1952,46 +2278,36 @@ void GPU::shadedTexturedPolygon(unsigned int numberOfPoints, bool opaque, Textur
         Vertex vertex = Vertex(point, color, opaque, texturePoint, textureBlendMode, texturePage, textureDepthShift, clut);
         vertices.push_back(vertex);
     }
-    renderer->pushPolygon(vertices, opaque, textureBlendMode);
+    pushDrawnTriangles(vertices, triangles, opaque, textureBlendMode);
 }
 
+/*
+Every segment of a polyline is checked on its own, like the triangles of a quad.
+*/
 void GPU::monochromeLine(unsigned int numberOfPoints, bool opaque) {
     Color color = Color(gp0InstructionBuffer[0]);
-    vector<Vertex> vertices = vector<Vertex>();
-    for (unsigned int i = 1; i <= numberOfPoints; i++) {
-        Point3D point = Point3D(gp0InstructionBuffer[i]);
-        vertices.push_back(Vertex(point, color, opaque));
-    }
-    if (numberOfPoints == 2) {
-        renderer->pushLine(vertices, opaque);
-        return;
-    }
-    vector<Vertex> lines = vector<Vertex>();
-    for (unsigned int i = 0; i < vertices.size() - 1; i++) {
-        lines.push_back(vertices[i]);
-        lines.push_back(vertices[i+1]);
-        renderer->pushLine(lines, opaque);
-        lines.clear();
+    for (unsigned int i = 1; i < numberOfPoints; i++) {
+        if (!isPrimitiveDrawn({ i, i + 1 })) {
+            continue;
+        }
+        vector<Vertex> line = {
+            Vertex(Point3D(gp0InstructionBuffer[i]), color, opaque),
+            Vertex(Point3D(gp0InstructionBuffer[i + 1]), color, opaque),
+        };
+        pushLine(line, opaque);
     }
 }
 
 void GPU::shadedLine(unsigned int numberOfPoints, bool opaque) {
-    vector<Vertex> vertices = vector<Vertex>();
-    for (unsigned int i = 0; i < numberOfPoints; i++) {
-        Color color = Color(gp0InstructionBuffer[i*2]);
-        Point3D point = Point3D(gp0InstructionBuffer[i*2+1]);
-        vertices.push_back(Vertex(point, color, opaque));
-    }
-    if (numberOfPoints == 2) {
-        renderer->pushLine(vertices, opaque);
-        return;
-    }
-    vector<Vertex> lines = vector<Vertex>();
-    for (unsigned int i = 0; i < vertices.size() - 1; i++) {
-        lines.push_back(vertices[i]);
-        lines.push_back(vertices[i+1]);
-        renderer->pushLine(lines, opaque);
-        lines.clear();
+    for (unsigned int i = 0; i + 1 < numberOfPoints; i++) {
+        if (!isPrimitiveDrawn({ i*2+1, i*2+3 })) {
+            continue;
+        }
+        vector<Vertex> line = {
+            Vertex(Point3D(gp0InstructionBuffer[i*2+1]), Color(gp0InstructionBuffer[i*2]), opaque),
+            Vertex(Point3D(gp0InstructionBuffer[i*2+3]), Color(gp0InstructionBuffer[i*2+2]), opaque),
+        };
+        pushLine(line, opaque);
     }
 }
 
@@ -34,6 +34,25 @@ void GPUImageBuffer::pushWord(uint32_t word) {
     index++;
 }
 
+/*
+Appends words stored little endian one after the other, as they are in RAM.
+*/
+void GPUImageBuffer::pushWords(const uint8_t *data, uint32_t count) {
+    uint32_t halfwords = count * 2;
+    for (uint32_t i = 0; i < halfwords; i++) {
+        buffer[index + i] = data[i * 2] | (data[i * 2 + 1] << 8);
+    }
+    index += halfwords;
+}
+
+/*
+Appends pixels that are already halfwords, for images that come from VRAM instead of GP0.
+*/
+void GPUImageBuffer::pushHalfwords(const uint16_t *data, uint32_t count) {
+    copy(data, data + count, buffer + index);
+    index += count;
+}
+
 bool GPUImageBuffer::isValid() {
     uint32_t resolution = width * heigth;
     return resolution == index;
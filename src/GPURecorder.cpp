@@ -0,0 +1,57 @@
+#include "GPURecorder.hpp"
+
+using namespace std;
+
+GPURecorder::GPURecorder(std::filesystem::path filePath) : logger(LogLevel::NoLog), pendingType(GPURecordType::GPURecordGp0), pendingWords() {
+    file = ofstream(filePath, ios::out|ios::binary|ios::trunc);
+    if (!file.is_open()) {
+        logger.logError("Unable to open GPU recording file: %s", filePath.string().c_str());
+    }
+    file.write(GPU_RECORDING_MAGIC, sizeof(GPU_RECORDING_MAGIC) - 1);
+    file.put(GPU_RECORDING_VERSION);
+    pendingWords.reserve(GPU_RECORDING_MAXIMUM_RUN_LENGTH);
+}
+
+GPURecorder::~GPURecorder() {
+    flush();
+    file.close();
+}
+
+void GPURecorder::writeWord(uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        file.put((char)((value >> (i * 8)) & 0xff));
+    }
+}
+
+void GPURecorder::flush() {
+    if (pendingWords.empty()) {
+        return;
+    }
+    file.put((char)pendingType);
+    writeWord(pendingWords.size());
+    for (uint32_t value : pendingWords) {
+        writeWord(value);
+    }
+    pendingWords.clear();
+}
+
+void GPURecorder::record(GPURecordType type, uint32_t value) {
+    if (type != pendingType || pendingWords.size() >= GPU_RECORDING_MAXIMUM_RUN_LENGTH) {
+        flush();
+        pendingType = type;
+    }
+    pendingWords.push_back(value);
+}
+
+void GPURecorder::recordGp0(uint32_t value) {
+    record(GPURecordType::GPURecordGp0, value);
+}
+
+void GPURecorder::recordGp1(uint32_t value) {
+    record(GPURecordType::GPURecordGp1, value);
+}
+
+void GPURecorder::recordVBlank() {
+    flush();
+    file.put((char)GPURecordType::GPURecordVBlank);
+}
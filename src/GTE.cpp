@@ -1,5 +1,46 @@
 #include "GTE.hpp"
+#include <algorithm>
 #include "Helpers.hpp"
+#include "GTEDivision.hpp"
+#include "GTEFlagRegister.tcc"
+
+/*
+Picks the widest triple vector kernels that were both built and are supported by the host,
+nullptr leaves RTPT, NCT, NCCT and NCDT on the scalar commands.
+*/
+static const GTETripleVectorKernels* selectTripleVectorKernels() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (gteTripleVectorKernelsAVX2() != nullptr && __builtin_cpu_supports("avx2")) {
+        return gteTripleVectorKernelsAVX2();
+    }
+    if (gteTripleVectorKernelsSSE41() != nullptr && __builtin_cpu_supports("sse4.1")) {
+        return gteTripleVectorKernelsSSE41();
+    }
+#endif
+    return nullptr;
+}
+
+/*
+H/SZ3 for RTPS/RTPT the way the GTE does it, with Unsigned Newton-Raphson. Only valid when
+H < SZ3 * 2, larger quotients are the caller's divide overflow.
+  z = count_leading_zeroes(SZ3)             ;z=0..0Fh (for 16bit SZ3)
+  n = (H SHL z)                             ;n=0..7FFF8000h
+  d = (SZ3 SHL z)                           ;d=8000h..FFFFh
+  u = unr_table[(d-7FC0h) SHR 7] + 101h     ;u=200h..101h
+  d = ((2000080h - (d * u)) SHR 8)          ;d=10000h..0FF01h
+  d = ((0000080h + (d * u)) SHR 8)          ;d=20000h..10000h
+  n = min(1FFFFh, (((n*d) + 8000h) SHR 16)) ;n=0..1FFFFh
+*/
+static uint32_t divideUNR(uint16_t h, uint16_t sz3) {
+    uint32_t z = __builtin_clz(sz3) - 16;
+    uint64_t n = (uint32_t)h << z;
+    uint32_t d = (uint32_t)sz3 << z;
+    uint32_t u = GTE_UNR_TABLE[(d - 0x7FC0) >> 7] + 0x101;
+    d = (0x2000080 - d * u) >> 8;
+    d = (0x0000080 + d * u) >> 8;
+    return std::min((uint64_t)0x1FFFF, (n * d + 0x8000) >> 16);
+}
 
 GTE::GTE(LogLevel logLevel) : logger(logLevel, "  GTE: "),
     v0({0, 0, 0}),
@@ -43,12 +84,58 @@ GTE::GTE(LogLevel logLevel) : logger(logLevel, "  GTE: "),
     dqb(0),
     zsf3(0),
     zsf4(0),
-    flag(GTEFlagRegister())
+    flag(GTEFlagRegister()),
+    tripleVectorKernels(selectTripleVectorKernels())
 {
 }
 
 GTE::~GTE() {}
 
+GTETripleVectorInput GTE::tripleVectorInput(bool shiftFraction, bool lm) const {
+    GTETripleVectorInput input = {
+        { v0.x, v1.x, v2.x, v2.x },
+        { v0.y, v1.y, v2.y, v2.y },
+        { v0.z, v1.z, v2.z, v2.z },
+        { { rt.v0.x, rt.v0.y, rt.v0.z }, { rt.v1.x, rt.v1.y, rt.v1.z }, { rt.v2.x, rt.v2.y, rt.v2.z } },
+        { tr.x, tr.y, tr.z },
+        { { l.v0.x, l.v0.y, l.v0.z }, { l.v1.x, l.v1.y, l.v1.z }, { l.v2.x, l.v2.y, l.v2.z } },
+        { bk.r, bk.g, bk.b },
+        { { lr.v0.x, lr.v0.y, lr.v0.z }, { lr.v1.x, lr.v1.y, lr.v1.z }, { lr.v2.x, lr.v2.y, lr.v2.z } },
+        { fc.r, fc.g, fc.b },
+        { rgbc.r, rgbc.g, rgbc.b },
+        ir0,
+        of.x,
+        of.y,
+        hl,
+        dqa,
+        dqb,
+        shiftFraction,
+        lm
+    };
+    return input;
+}
+
+/*
+Writes back what NCT, NCCT and NCDT leave behind, the three colors pushed to the RGB fifo in order
+and the accumulators of the last vector.
+*/
+void GTE::storeTripleVectorColors(const GTETripleVectorOutput &output) {
+    mac1 = output.mac[0][2];
+    mac2 = output.mac[1][2];
+    mac3 = output.mac[2][2];
+    ir1 = output.ir[0][2];
+    ir2 = output.ir[1][2];
+    ir3 = output.ir[2][2];
+    GTEColor_u8_t *fifo[] = { &rgb0, &rgb1, &rgb2 };
+    for (unsigned int i = 0; i < 3; i++) {
+        fifo[i]->r = output.rgb[0][i];
+        fifo[i]->g = output.rgb[1][i];
+        fifo[i]->b = output.rgb[2][i];
+        fifo[i]->c = rgbc.c;
+    }
+    flag._value |= output.flags;
+}
+
 void GTE::setData(uint32_t index, uint32_t value) {
     logger.logMessage("DATA [W] (IDX: %d): %#x", index, value);
     switch (index) {
@@ -632,93 +719,159 @@ uint32_t GTE::getControl(uint32_t index) {
 void GTE::execute(uint32_t value) {
     GTEInstruction instruction = GTEInstruction(value);
     flag._value = 0;
+    switch ((instruction.shiftFraction << 1) | instruction.lm) {
+        case 0: {
+            executeCommand<false, false>(instruction);
+            break;
+        }
+        case 1: {
+            executeCommand<false, true>(instruction);
+            break;
+        }
+        case 2: {
+            executeCommand<true, false>(instruction);
+            break;
+        }
+        case 3: {
+            executeCommand<true, true>(instruction);
+            break;
+        }
+    }
+    if ((flag._value & 0x7F87E000) != 0) {
+        flag._value |= 0x80000000;
+    }
+}
+
+/*
+NCLIP, AVSZ3 and AVSZ4 clear FLAG and overwrite MAC0 without reading either, which are the only
+results RTPT leaves that nothing else replaces.
+*/
+static bool overwritesPerspectiveTransformationFlags(uint32_t value) {
+    GTEInstruction instruction = GTEInstruction(value);
+    return instruction.command == 0x06 || instruction.command == 0x2d || instruction.command == 0x2e;
+}
+
+/*
+Runs the first of the given back to back commands, fusing it with the ones after when that saves
+work nobody can observe, and returns how many of them ran.
+  RTPT, NCLIP|AVSZ3|AVSZ4   RTPT skips its FLAG bits
+  RTPT, NCLIP, AVSZ3|AVSZ4  NCLIP is skipped altogether, it only leaves MAC0 and FLAG
+*/
+unsigned int GTE::executeSequence(const uint32_t *values, unsigned int count) {
+    GTEInstruction instruction = GTEInstruction(values[0]);
+    if (count < 2 || instruction.command != 0x30 || !overwritesPerspectiveTransformationFlags(values[1])) {
+        execute(values[0]);
+        return 1;
+    }
+    if (instruction.shiftFraction) {
+        perspectiveTransformationOnThreePointsDiscardingFlags<true>();
+    } else {
+        perspectiveTransformationOnThreePointsDiscardingFlags<false>();
+    }
+    if (GTEInstruction(values[1]).command == 0x06 && count > 2) {
+        GTEInstruction last = GTEInstruction(values[2]);
+        if (last.command == 0x2d || last.command == 0x2e) {
+            execute(values[2]);
+            return 3;
+        }
+    }
+    execute(values[1]);
+    return 2;
+}
+
+/*
+Commands are built once for every combination of the sf and lm fields, so neither is checked
+while calculating.
+*/
+template <bool shiftFraction, bool lm>
+void GTE::executeCommand(GTEInstruction instruction) {
     switch (instruction.command) {
         case 0x1: {
-            perspectiveTransformation(instruction, 0);
+            perspectiveTransformation<shiftFraction, lm>(0);
             break;
         }
         case 0x6: {
-            normalClipping(instruction);
+            normalClipping();
             break;
         }
         case 0xc: {
-            outerProductOfTwoVectors(instruction);
+            outerProductOfTwoVectors<shiftFraction, lm>();
             break;
         }
         case 0x10: {
-            depthCueingDPCS(instruction, false);
+            depthCueingDPCS<shiftFraction, lm>(false);
             break;
         }
         case 0x11: {
-            interpolationOfVectorAndFarColorVector(instruction);
+            interpolationOfVectorAndFarColorVector<shiftFraction, lm>();
             break;
         }
         case 0x12: {
-            multiplyVectorByMatrixAndVectorAddition(instruction);
+            multiplyVectorByMatrixAndVectorAddition<shiftFraction, lm>(instruction);
             break;
         }
         case 0x13: {
-            normalColorDepthCueSingleVector(instruction, 0);
+            normalColorDepthCueSingleVector<shiftFraction, lm>(0);
             break;
         }
         case 0x14: {
-            colorDepthQue(instruction);
+            colorDepthQue<shiftFraction, lm>();
             break;
         }
         case 0x16: {
-            normalColorDepthCueTripleVector(instruction);
+            normalColorDepthCueTripleVector<shiftFraction, lm>();
             break;
         }
         case 0x1b: {
-            normalColorColorSingleVector(instruction, 0);
+            normalColorColorSingleVector<shiftFraction, lm>(0);
             break;
         }
         case 0x1c: {
-            colorColor(instruction);
+            colorColor<shiftFraction, lm>();
             break;
         }
         case 0x1e: {
-            normalColorNCS(instruction, 0);
+            normalColorNCS<shiftFraction, lm>(0);
             break;
         }
         case 0x20: {
-            normalColorNCT(instruction);
+            normalColorNCT<shiftFraction, lm>();
             break;
         }
         case 0x28: {
-            squareVector(instruction);
+            squareVector<shiftFraction, lm>();
             break;
         }
         case 0x29: {
-            depthCueColorLight(instruction);
+            depthCueColorLight<shiftFraction, lm>();
             break;
         }
         case 0x2a: {
-            depthCueingDPCT(instruction);
+            depthCueingDPCT<shiftFraction, lm>();
             break;
         }
         case 0x2d: {
-            averageOfThreeZValues(instruction);
+            averageOfThreeZValues();
             break;
         }
         case 0x2e: {
-            averageOfFourZValues(instruction);
+            averageOfFourZValues();
             break;
         }
         case 0x30: {
-            perspectiveTransformationOnThreePoints(instruction);
+            perspectiveTransformationOnThreePoints<shiftFraction, lm>();
             break;
         }
         case 0x3d: {
-            generalPurposeInterpolationGPF(instruction);
+            generalPurposeInterpolationGPF<shiftFraction, lm>();
             break;
         }
         case 0x3e: {
-            generalPurposeInterpolationGPL(instruction);
+            generalPurposeInterpolationGPL<shiftFraction, lm>();
             break;
         }
         case 0x3f: {
-            normalColorColorTripleVector(instruction);
+            normalColorColorTripleVector<shiftFraction, lm>();
             break;
         }
         default: {
@@ -726,9 +879,6 @@ void GTE::execute(uint32_t value) {
             break;
         }
     }
-    if ((flag._value & 0x7F87E000) != 0) {
-        flag._value |= 0x80000000;
-    }
 }
 
 /*
@@ -749,14 +899,15 @@ Calculation: (left format sf=0, right format sf=1)
 [1,15,0][1,3,12]  IR2=Lm_B2[MAC2]                      [1,31,0][1,19,12][lm=1]
 [1,15,0][1,3,12]  IR3=Lm_B3[MAC3]                      [1,31,0][1,19,12][lm=1]
 */
-void GTE::squareVector(GTEInstruction instruction) {
-    mac1 = flag.calculateMAC(1, (ir1 * ir1) >> (instruction.shiftFraction * 12));
-    mac2 = flag.calculateMAC(2, (ir2 * ir2) >> (instruction.shiftFraction * 12));
-    mac3 = flag.calculateMAC(3, (ir3 * ir3) >> (instruction.shiftFraction * 12));
-
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+template <bool shiftFraction, bool lm>
+void GTE::squareVector() {
+    mac1 = flag.calculateMAC<1>((ir1 * ir1) >> (shiftFraction * 12));
+    mac2 = flag.calculateMAC<2>((ir2 * ir2) >> (shiftFraction * 12));
+    mac3 = flag.calculateMAC<3>((ir3 * ir3) >> (shiftFraction * 12));
+
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 }
 
 /*
@@ -771,9 +922,7 @@ out:     MAC0              Outerproduct of SXY1 and SXY2 with  [1,31,0]
 Calculation:
 [1,31,0] MAC0 = F[SX0*SY1+SX1*SY2+SX2*SY0-SX0*SY2-SX1*SY0-SX2*SY1] [1,43,0]
 */
-void GTE::normalClipping(GTEInstruction instruction) {
-    // TODO: unused
-    (void)instruction;
+void GTE::normalClipping() {
     mac0 = flag.calculateMAC0((int64_t)sxy0.x * sxy1.y + sxy1.x * sxy2.y + sxy2.x * sxy0.y - sxy0.x * sxy2.y - sxy1.x * sxy0.y - sxy2.x * sxy1.y);
 }
 
@@ -791,9 +940,7 @@ Calculation:
 [1,31,0] MAC0=F[ZSF3*SZ1 + ZSF3*SZ2 + ZSF3*SZ3]                [1,31,12]
 [0,16,0] OTZ=Lm_D[MAC0]                                        [1,31,0]
 */
-void GTE::averageOfThreeZValues(GTEInstruction instruction) {
-    // TODO: unused
-    (void)instruction;
+void GTE::averageOfThreeZValues() {
     int64_t average = (int64_t)zsf3 * sz1 + zsf3 * sz2 + zsf3 * sz3;
     mac0 = flag.calculateMAC0(average);
     otz = flag.calculateSZ3(average >> 12);
@@ -813,9 +960,7 @@ Calculation:
 [1,31,0] MAC0=F[ZSF4*SZ0 + ZSF4*SZ1 + ZSF4*SZ2 + ZSF4*SZ3]     [1,31,12]
 [0,16,0] OTZ=Lm_D[MAC0]                                        [1,31,0]
 */
-void GTE::averageOfFourZValues(GTEInstruction instruction) {
-    // TODO: unused
-    (void)instruction;
+void GTE::averageOfFourZValues() {
     int64_t average = (int64_t)zsf4 * sz0 + zsf4 * sz1 + zsf4 * sz2 + zsf4 * sz3;
     mac0 = flag.calculateMAC0(average);
     otz = flag.calculateSZ3(average >> 12);
@@ -840,18 +985,19 @@ Calculation: (D1=R11R12,D2=R22R23,D3=R33)
          IR2=Lm_B2[MAC1]
          IR3=Lm_B3[MAC2]
 */
-void GTE::outerProductOfTwoVectors(GTEInstruction instruction) {
+template <bool shiftFraction, bool lm>
+void GTE::outerProductOfTwoVectors() {
     int16_t d1 = rt.v0.x;
     int16_t d2 = rt.v1.y;
     int16_t d3 = rt.v2.z;
 
-    mac1 = flag.calculateMAC(1, ((d2 * ir3) - (d3 * ir2)) >> (instruction.shiftFraction * 12));
-    mac2 = flag.calculateMAC(2, ((d3 * ir1) - (d1 * ir3)) >> (instruction.shiftFraction * 12));
-    mac3 = flag.calculateMAC(3, ((d1 * ir2) - (d2 * ir1)) >> (instruction.shiftFraction * 12));
+    mac1 = flag.calculateMAC<1>(((d2 * ir3) - (d3 * ir2)) >> (shiftFraction * 12));
+    mac2 = flag.calculateMAC<2>(((d3 * ir1) - (d1 * ir3)) >> (shiftFraction * 12));
+    mac3 = flag.calculateMAC<3>(((d1 * ir2) - (d2 * ir1)) >> (shiftFraction * 12));
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 }
 
 /*
@@ -879,21 +1025,22 @@ Calculation:
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]
 */
-void GTE::generalPurposeInterpolationGPF(GTEInstruction instruction) {
-    mac1 = flag.calculateMAC(1, (ir0 * ir1)) >> (instruction.shiftFraction * 12);
-    mac2 = flag.calculateMAC(2, (ir0 * ir2)) >> (instruction.shiftFraction * 12);
-    mac3 = flag.calculateMAC(3, (ir0 * ir3)) >> (instruction.shiftFraction * 12);
+template <bool shiftFraction, bool lm>
+void GTE::generalPurposeInterpolationGPF() {
+    mac1 = flag.calculateMAC<1>((ir0 * ir1)) >> (shiftFraction * 12);
+    mac2 = flag.calculateMAC<2>((ir0 * ir2)) >> (shiftFraction * 12);
+    mac3 = flag.calculateMAC<3>((ir0 * ir3)) >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -923,25 +1070,26 @@ Calculation:
 [0,8,0]  G0<-G1<-G2<- Lm_C2[MAC2]
 [0,8,0]  B0<-B1<-B2<- Lm_C3[MAC3]
 */
-void GTE::generalPurposeInterpolationGPL(GTEInstruction instruction) {
-    int64_t m1 = (int64_t)mac1 << (instruction.shiftFraction * 12);
-    int64_t m2 = (int64_t)mac2 << (instruction.shiftFraction * 12);
-    int64_t m3 = (int64_t)mac3 << (instruction.shiftFraction * 12);
+template <bool shiftFraction, bool lm>
+void GTE::generalPurposeInterpolationGPL() {
+    int64_t m1 = (int64_t)mac1 << (shiftFraction * 12);
+    int64_t m2 = (int64_t)mac2 << (shiftFraction * 12);
+    int64_t m3 = (int64_t)mac3 << (shiftFraction * 12);
 
-    mac1 = flag.calculateMAC(1, m1 + (ir0 * ir1)) >> (instruction.shiftFraction * 12);
-    mac2 = flag.calculateMAC(2, m2 + (ir0 * ir2)) >> (instruction.shiftFraction * 12);
-    mac3 = flag.calculateMAC(3, m3 + (ir0 * ir3)) >> (instruction.shiftFraction * 12);
+    mac1 = flag.calculateMAC<1>(m1 + (ir0 * ir1)) >> (shiftFraction * 12);
+    mac2 = flag.calculateMAC<2>(m2 + (ir0 * ir2)) >> (shiftFraction * 12);
+    mac3 = flag.calculateMAC<3>(m3 + (ir0 * ir3)) >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -983,7 +1131,8 @@ Calculation:
 [1,31,0] MAC0= F[DQB + DQA * (H/SZ)]                           [1,19,24]
 [1,15,0] IR0= Lm_H[MAC0]                                       [1,31,0]
 */
-void GTE::perspectiveTransformation(GTEInstruction instruction, unsigned int index) {
+template <bool shiftFraction, bool lm>
+void GTE::perspectiveTransformation(unsigned int index) {
     GTEVector3_16_t v = {};
     switch (index) {
         case 0: {
@@ -1003,42 +1152,44 @@ void GTE::perspectiveTransformation(GTEInstruction instruction, unsigned int ind
             break;
         }
     }
-    mac1 = flag.calculateMAC(1, (tr.x * 0x1000 + rt.v0.x * v.x + rt.v0.y * v.y + rt.v0.z * v.z) >> (instruction.shiftFraction * 12));
-    mac2 = flag.calculateMAC(2, (tr.y * 0x1000 + rt.v1.x * v.x + rt.v1.y * v.y + rt.v1.z * v.z) >> (instruction.shiftFraction * 12));
-    mac3 = flag.calculateMAC(3, (tr.z * 0x1000 + rt.v2.x * v.x + rt.v2.y * v.y + rt.v2.z * v.z) >> (instruction.shiftFraction * 12));
-
-    ir1 = flag.calculateIR(1, mac1, false);
-    ir2 = flag.calculateIR(2, mac2, false);
-    ir3 = flag.calculateIR(3, mac3, false);
-
     sz0 = sz1;
     sz1 = sz2;
     sz2 = sz3;
-    sz3 = flag.calculateSZ3(mac3 >> ((1 - instruction.shiftFraction) * 12));
-
     sxy0 = sxy1;
     sxy1 = sxy2;
+    projectVector<shiftFraction>(v, flag, sxy2, sz3);
+}
+
+/*
+The RTPS calculation for a single vector, with the screen coordinates written straight to the given
+FIFO entries and the FLAG bits to the given register, so RTPT can skip the FIFO shuffles between
+vectors and fused sequences can drop flags that are overwritten before they are read.
+*/
+template <bool shiftFraction>
+void GTE::projectVector(const GTEVector3_16_t &v, GTEFlagRegister &flags, GTEVector2_16_t &sxy, uint16_t &sz) {
+    mac1 = flags.calculateMAC<1>(((int64_t)tr.x * 0x1000 + rt.v0.x * v.x + rt.v0.y * v.y + rt.v0.z * v.z) >> (shiftFraction * 12));
+    mac2 = flags.calculateMAC<2>(((int64_t)tr.y * 0x1000 + rt.v1.x * v.x + rt.v1.y * v.y + rt.v1.z * v.z) >> (shiftFraction * 12));
+    mac3 = flags.calculateMAC<3>(((int64_t)tr.z * 0x1000 + rt.v2.x * v.x + rt.v2.y * v.y + rt.v2.z * v.z) >> (shiftFraction * 12));
+
+    ir1 = flags.calculateIR<1, false>(mac1);
+    ir2 = flags.calculateIR<2, false>(mac2);
+    ir3 = flags.calculateIR<3, false>(mac3);
+
+    sz = flags.calculateSZ3(mac3 >> ((1 - shiftFraction) * 12));
 
-    int64_t result = 0;
-    int64_t divide = 0;
-    if (sz3 == 0) {
-        result = 0x1FFFF;
+    int64_t result = 0x1FFFF;
+    if (hl < sz * 2) {
+        result = divideUNR(hl, sz);
     } else {
-        divide = (((int64_t)hl * 0x20000 / sz3) + 1) / 2;
-        if (divide > 0x1FFFF) {
-            result = 0x1FFFF;
-            flag.divideOverflow = 1;
-        } else {
-            result = divide;
-        }
+        flags.divideOverflow = 1;
     }
 
     mac0 = result * ir1 + of.x;
-    sxy2.x = flag.calculateSXY2(2, mac0 / 0x10000);
+    sxy.x = flags.calculateSXY2<1>(mac0 / 0x10000);
     mac0 = result * ir2 + of.y;
-    sxy2.y = flag.calculateSXY2(2, mac0 / 0x10000);
+    sxy.y = flags.calculateSXY2<2>(mac0 / 0x10000);
     mac0 = result * dqa + dqb;
-    ir0 = flag.calculateIR0(mac0 / 0x1000);
+    ir0 = flags.calculateIR0(mac0 / 0x1000);
 }
 
 /*
@@ -1068,12 +1219,47 @@ out      SXY fifo Screen XY coordinates.(short)                [1,15,0]
 
 Calculation: Same as RTPS, but repeats for V1 and V2.
 */
-void GTE::perspectiveTransformationOnThreePoints(GTEInstruction instruction) {
-    // TODO: unused
-    (void)instruction;
-    perspectiveTransformation(instruction, 0);
-    perspectiveTransformation(instruction, 1);
-    perspectiveTransformation(instruction, 2);
+template <bool shiftFraction, bool lm>
+void GTE::perspectiveTransformationOnThreePoints() {
+    if (tripleVectorKernels != nullptr) {
+        GTETripleVectorOutput output;
+        tripleVectorKernels->perspectiveTransformation(tripleVectorInput(shiftFraction, lm), output);
+        mac1 = output.mac[0][2];
+        mac2 = output.mac[1][2];
+        mac3 = output.mac[2][2];
+        ir1 = output.ir[0][2];
+        ir2 = output.ir[1][2];
+        ir3 = output.ir[2][2];
+        sz0 = sz3;
+        sz1 = output.sz[0];
+        sz2 = output.sz[1];
+        sz3 = output.sz[2];
+        GTEVector2_16_t *fifo[] = { &sxy0, &sxy1, &sxy2 };
+        for (unsigned int i = 0; i < 3; i++) {
+            fifo[i]->x = output.sx[i];
+            fifo[i]->y = output.sy[i];
+        }
+        mac0 = output.mac0[2];
+        ir0 = output.ir0[2];
+        flag._value |= output.flags;
+        return;
+    }
+    sz0 = sz3;
+    projectVector<shiftFraction>(v0, flag, sxy0, sz1);
+    projectVector<shiftFraction>(v1, flag, sxy1, sz2);
+    projectVector<shiftFraction>(v2, flag, sxy2, sz3);
+}
+
+/*
+RTPT inside a fused sequence, the next command clears FLAG and MAC0 before they can be read.
+*/
+template <bool shiftFraction>
+void GTE::perspectiveTransformationOnThreePointsDiscardingFlags() {
+    GTEFlagRegister discarded = GTEFlagRegister();
+    sz0 = sz3;
+    projectVector<shiftFraction>(v0, discarded, sxy0, sz1);
+    projectVector<shiftFraction>(v1, discarded, sxy1, sz2);
+    projectVector<shiftFraction>(v2, discarded, sxy2, sz3);
 }
 
 /*
@@ -1107,7 +1293,8 @@ Out:     RGBn              RGB fifo.              Rn,Gn,Bn,CDn [0,8,0]
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]                             [1,27,4]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]                             [1,27,4]
 */
-void GTE::normalColorNCS(GTEInstruction instruction, unsigned int index) {
+template <bool shiftFraction, bool lm>
+void GTE::normalColorNCS(unsigned int index) {
     GTEVector3_16_t v = {};
     switch (index) {
         case 0: {
@@ -1127,41 +1314,41 @@ void GTE::normalColorNCS(GTEInstruction instruction, unsigned int index) {
             break;
         }
     }
-    mac1 = flag.calculateMAC(1, (int64_t)l.v0.x * v.x + l.v0.y * v.y + l.v0.z * v.z) >> (instruction.shiftFraction * 12);
-    mac2 = flag.calculateMAC(2, (int64_t)l.v1.x * v.x + l.v1.y * v.y + l.v1.z * v.z) >> (instruction.shiftFraction * 12);
-    mac3 = flag.calculateMAC(3, (int64_t)l.v2.x * v.x + l.v2.y * v.y + l.v2.z * v.z) >> (instruction.shiftFraction * 12);
+    mac1 = flag.calculateMAC<1>((int64_t)l.v0.x * v.x + l.v0.y * v.y + l.v0.z * v.z) >> (shiftFraction * 12);
+    mac2 = flag.calculateMAC<2>((int64_t)l.v1.x * v.x + l.v1.y * v.y + l.v1.z * v.z) >> (shiftFraction * 12);
+    mac3 = flag.calculateMAC<3>((int64_t)l.v2.x * v.x + l.v2.y * v.y + l.v2.z * v.z) >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     int64_t temporalMAC = 0;
 
-    temporalMAC = flag.calculateMAC(1, (int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.y * ir2);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.z * ir3);
-    mac1 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<1>((int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.y * ir2);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.z * ir3);
+    mac1 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(2, (int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.y * ir2);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.z * ir3);
-    mac2 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<2>((int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.y * ir2);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.z * ir3);
+    mac2 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(3, (int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.y * ir2);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.z * ir3);
-    mac3 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<3>((int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.y * ir2);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.z * ir3);
+    mac3 = temporalMAC >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -1181,10 +1368,17 @@ Out:     RGBn              RGB fifo.              Rn,Gn,Bn,CDn [0,8,0]
 
 Calculation: Same as NCS, but repeated for V1 and V2.
 */
-void GTE::normalColorNCT(GTEInstruction instruction) {
-    normalColorNCS(instruction, 0);
-    normalColorNCS(instruction, 1);
-    normalColorNCS(instruction, 2);
+template <bool shiftFraction, bool lm>
+void GTE::normalColorNCT() {
+    if (tripleVectorKernels != nullptr) {
+        GTETripleVectorOutput output;
+        tripleVectorKernels->normalColor(tripleVectorInput(shiftFraction, lm), output);
+        storeTripleVectorColors(output);
+        return;
+    }
+    normalColorNCS<shiftFraction, lm>(0);
+    normalColorNCS<shiftFraction, lm>(1);
+    normalColorNCS<shiftFraction, lm>(2);
 }
 
 /*
@@ -1226,7 +1420,8 @@ Calculation:
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]                              [1,27,4]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]                              [1,27,4]
 */
-void GTE::normalColorColorSingleVector(GTEInstruction instruction, unsigned int index) {
+template <bool shiftFraction, bool lm>
+void GTE::normalColorColorSingleVector(unsigned int index) {
     GTEVector3_16_t v = {};
     switch (index) {
         case 0: {
@@ -1246,53 +1441,53 @@ void GTE::normalColorColorSingleVector(GTEInstruction instruction, unsigned int
             break;
         }
     }
-    mac1 = flag.calculateMAC(1, (int64_t)l.v0.x * v.x + l.v0.y * v.y + l.v0.z * v.z) >> (instruction.shiftFraction * 12);
-    mac2 = flag.calculateMAC(2, (int64_t)l.v1.x * v.x + l.v1.y * v.y + l.v1.z * v.z) >> (instruction.shiftFraction * 12);
-    mac3 = flag.calculateMAC(3, (int64_t)l.v2.x * v.x + l.v2.y * v.y + l.v2.z * v.z) >> (instruction.shiftFraction * 12);
+    mac1 = flag.calculateMAC<1>((int64_t)l.v0.x * v.x + l.v0.y * v.y + l.v0.z * v.z) >> (shiftFraction * 12);
+    mac2 = flag.calculateMAC<2>((int64_t)l.v1.x * v.x + l.v1.y * v.y + l.v1.z * v.z) >> (shiftFraction * 12);
+    mac3 = flag.calculateMAC<3>((int64_t)l.v2.x * v.x + l.v2.y * v.y + l.v2.z * v.z) >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     int64_t temporalMAC = 0;
 
-    temporalMAC = flag.calculateMAC(1, (int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.y * ir2);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.z * ir3);
-    mac1 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<1>((int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.y * ir2);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.z * ir3);
+    mac1 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(2, (int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.y * ir2);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.z * ir3);
-    mac2 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<2>((int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.y * ir2);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.z * ir3);
+    mac2 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(3, (int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.y * ir2);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.z * ir3);
-    mac3 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<3>((int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.y * ir2);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.z * ir3);
+    mac3 = temporalMAC >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
-    mac1 = flag.calculateMAC(1, (rgbc.r * ir1) << 4);
-    mac2 = flag.calculateMAC(2, (rgbc.g * ir2) << 4);
-    mac3 = flag.calculateMAC(3, (rgbc.b * ir3) << 4);
+    mac1 = flag.calculateMAC<1>((rgbc.r * ir1) << 4);
+    mac2 = flag.calculateMAC<2>((rgbc.g * ir2) << 4);
+    mac3 = flag.calculateMAC<3>((rgbc.b * ir3) << 4);
 
-    mac1 = flag.calculateMAC(1, mac1 >> (instruction.shiftFraction * 12));
-    mac2 = flag.calculateMAC(2, mac2 >> (instruction.shiftFraction * 12));
-    mac3 = flag.calculateMAC(3, mac3 >> (instruction.shiftFraction * 12));
+    mac1 = flag.calculateMAC<1>(mac1 >> (shiftFraction * 12));
+    mac2 = flag.calculateMAC<2>(mac2 >> (shiftFraction * 12));
+    mac3 = flag.calculateMAC<3>(mac3 >> (shiftFraction * 12));
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -1315,10 +1510,17 @@ Out:     RGBn              RGB fifo.              Rn,Gn,Bn,CDn [0,8,0]
 Calculation:
 Same as NCCS but repeats for v1 and v2.
 */
-void GTE::normalColorColorTripleVector(GTEInstruction instruction) {
-    normalColorColorSingleVector(instruction, 0);
-    normalColorColorSingleVector(instruction, 1);
-    normalColorColorSingleVector(instruction, 2);
+template <bool shiftFraction, bool lm>
+void GTE::normalColorColorTripleVector() {
+    if (tripleVectorKernels != nullptr) {
+        GTETripleVectorOutput output;
+        tripleVectorKernels->normalColorColor(tripleVectorInput(shiftFraction, lm), output);
+        storeTripleVectorColors(output);
+        return;
+    }
+    normalColorColorSingleVector<shiftFraction, lm>(0);
+    normalColorColorSingleVector<shiftFraction, lm>(1);
+    normalColorColorSingleVector<shiftFraction, lm>(2);
 }
 
 /*
@@ -1351,46 +1553,47 @@ Calculations:
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]                             [1,27,4]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]                             [1,27,4]
 */
-void GTE::colorColor(GTEInstruction instruction) {
+template <bool shiftFraction, bool lm>
+void GTE::colorColor() {
     int64_t temporalMAC = 0;
 
-    temporalMAC = flag.calculateMAC(1, (int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.y * ir2);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.z * ir3);
-    mac1 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<1>((int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.y * ir2);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.z * ir3);
+    mac1 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(2, (int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.y * ir2);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.z * ir3);
-    mac2 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<2>((int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.y * ir2);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.z * ir3);
+    mac2 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(3, (int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.y * ir2);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.z * ir3);
-    mac3 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<3>((int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.y * ir2);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.z * ir3);
+    mac3 = temporalMAC >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
-    mac1 = flag.calculateMAC(1, (rgbc.r * ir1) << 4);
-    mac2 = flag.calculateMAC(2, (rgbc.g * ir2) << 4);
-    mac3 = flag.calculateMAC(3, (rgbc.b * ir3) << 4);
+    mac1 = flag.calculateMAC<1>((rgbc.r * ir1) << 4);
+    mac2 = flag.calculateMAC<2>((rgbc.g * ir2) << 4);
+    mac3 = flag.calculateMAC<3>((rgbc.b * ir3) << 4);
 
-    mac1 = flag.calculateMAC(1, mac1 >> (instruction.shiftFraction * 12));
-    mac2 = flag.calculateMAC(2, mac2 >> (instruction.shiftFraction * 12));
-    mac3 = flag.calculateMAC(3, mac3 >> (instruction.shiftFraction * 12));
+    mac1 = flag.calculateMAC<1>(mac1 >> (shiftFraction * 12));
+    mac2 = flag.calculateMAC<2>(mac2 >> (shiftFraction * 12));
+    mac3 = flag.calculateMAC<3>(mac3 >> (shiftFraction * 12));
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -1418,7 +1621,8 @@ Calculations:
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]                             [1,27,4]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]                             [1,27,4]
 */
-void GTE::depthCueingDPCS(GTEInstruction instruction, bool useFIFO) {
+template <bool shiftFraction, bool lm>
+void GTE::depthCueingDPCS(bool useFIFO) {
     uint8_t r = rgbc.r;
     uint8_t g = rgbc.g;
     uint8_t b = rgbc.b;
@@ -1428,36 +1632,36 @@ void GTE::depthCueingDPCS(GTEInstruction instruction, bool useFIFO) {
         b = rgb0.b;
     }
 
-    mac1 = flag.calculateMAC(1, r) << 16;
-    mac2 = flag.calculateMAC(2, g) << 16;
-    mac3 = flag.calculateMAC(3, b) << 16;
+    mac1 = flag.calculateMAC<1>(r) << 16;
+    mac2 = flag.calculateMAC<2>(g) << 16;
+    mac3 = flag.calculateMAC<3>(b) << 16;
 
     int32_t mac1Input = mac1;
     int32_t mac2Input = mac2;
     int32_t mac3Input = mac3;
 
-    mac1 = flag.calculateMAC(1, ((int64_t)fc.r << 12) - mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)fc.g << 12) - mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)fc.b << 12) - mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)fc.r << 12) - mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)fc.g << 12) - mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)fc.b << 12) - mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, false);
-    ir2 = flag.calculateIR(2, mac2, false);
-    ir3 = flag.calculateIR(3, mac3, false);
+    ir1 = flag.calculateIR<1, false>(mac1);
+    ir2 = flag.calculateIR<2, false>(mac2);
+    ir3 = flag.calculateIR<3, false>(mac3);
 
-    mac1 = flag.calculateMAC(1, ((int64_t)ir1 * ir0) + mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)ir2 * ir0) + mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)ir3 * ir0) + mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)ir1 * ir0) + mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)ir2 * ir0) + mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)ir3 * ir0) + mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -1488,10 +1692,11 @@ Calculations:
 Performs this calculation 3 times, so all three RGB values have been
 replaced by the depth cued RGB values.
 */
-void GTE::depthCueingDPCT(GTEInstruction instruction) {
-    depthCueingDPCS(instruction, true);
-    depthCueingDPCS(instruction, true);
-    depthCueingDPCS(instruction, true);
+template <bool shiftFraction, bool lm>
+void GTE::depthCueingDPCT() {
+    depthCueingDPCS<shiftFraction, lm>(true);
+    depthCueingDPCS<shiftFraction, lm>(true);
+    depthCueingDPCS<shiftFraction, lm>(true);
 }
 
 /*
@@ -1519,37 +1724,38 @@ Calculations:
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]                             [1,27,4]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]                             [1,27,4]
 */
-void GTE::interpolationOfVectorAndFarColorVector(GTEInstruction instruction) {
-    mac1 = flag.calculateMAC(1, (int64_t)ir1 << 12);
-    mac2 = flag.calculateMAC(2, (int64_t)ir2 << 12);
-    mac3 = flag.calculateMAC(3, (int64_t)ir3 << 12);
+template <bool shiftFraction, bool lm>
+void GTE::interpolationOfVectorAndFarColorVector() {
+    mac1 = flag.calculateMAC<1>((int64_t)ir1 << 12);
+    mac2 = flag.calculateMAC<2>((int64_t)ir2 << 12);
+    mac3 = flag.calculateMAC<3>((int64_t)ir3 << 12);
 
     int32_t mac1Input = mac1;
     int32_t mac2Input = mac2;
     int32_t mac3Input = mac3;
 
-    mac1 = flag.calculateMAC(1, ((int64_t)fc.r << 12) - mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)fc.g << 12) - mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)fc.b << 12) - mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)fc.r << 12) - mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)fc.g << 12) - mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)fc.b << 12) - mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, false);
-    ir2 = flag.calculateIR(2, mac2, false);
-    ir3 = flag.calculateIR(3, mac3, false);
+    ir1 = flag.calculateIR<1, false>(mac1);
+    ir2 = flag.calculateIR<2, false>(mac2);
+    ir3 = flag.calculateIR<3, false>(mac3);
 
-    mac1 = flag.calculateMAC(1, ((int64_t)ir1 * ir0) + mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)ir2 * ir0) + mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)ir3 * ir0) + mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)ir1 * ir0) + mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)ir2 * ir0) + mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)ir3 * ir0) + mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -1586,58 +1792,59 @@ Calculation:
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]                             [1,27,4]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]                             [1,27,4]
 */
-void GTE::colorDepthQue(GTEInstruction instruction) {
+template <bool shiftFraction, bool lm>
+void GTE::colorDepthQue() {
     int64_t temporalMAC = 0;
 
-    temporalMAC = flag.calculateMAC(1, (int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.y * ir2);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.z * ir3);
-    mac1 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<1>((int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.y * ir2);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.z * ir3);
+    mac1 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(2, (int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.y * ir2);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.z * ir3);
-    mac2 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<2>((int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.y * ir2);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.z * ir3);
+    mac2 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(3, (int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.y * ir2);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.z * ir3);
-    mac3 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<3>((int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.y * ir2);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.z * ir3);
+    mac3 = temporalMAC >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
-    mac1 = flag.calculateMAC(1, (rgbc.r * ir1) << 4);
-    mac2 = flag.calculateMAC(2, (rgbc.g * ir2) << 4);
-    mac3 = flag.calculateMAC(3, (rgbc.b * ir3) << 4);
+    mac1 = flag.calculateMAC<1>((rgbc.r * ir1) << 4);
+    mac2 = flag.calculateMAC<2>((rgbc.g * ir2) << 4);
+    mac3 = flag.calculateMAC<3>((rgbc.b * ir3) << 4);
 
     int32_t mac1Input = mac1;
     int32_t mac2Input = mac2;
     int32_t mac3Input = mac3;
 
-    mac1 = flag.calculateMAC(1, ((int64_t)fc.r << 12) - mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)fc.g << 12) - mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)fc.b << 12) - mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)fc.r << 12) - mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)fc.g << 12) - mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)fc.b << 12) - mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, false);
-    ir2 = flag.calculateIR(2, mac2, false);
-    ir3 = flag.calculateIR(3, mac3, false);
+    ir1 = flag.calculateIR<1, false>(mac1);
+    ir2 = flag.calculateIR<2, false>(mac2);
+    ir3 = flag.calculateIR<3, false>(mac3);
 
-    mac1 = flag.calculateMAC(1, ((int64_t)ir1 * ir0) + mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)ir2 * ir0) + mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)ir3 * ir0) + mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)ir1 * ir0) + mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)ir2 * ir0) + mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)ir3 * ir0) + mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -1679,7 +1886,8 @@ Calculation:
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]                             [1,27,4]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]                             [1,27,4]
 */
-void GTE::normalColorDepthCueSingleVector(GTEInstruction instruction, unsigned int index) {
+template <bool shiftFraction, bool lm>
+void GTE::normalColorDepthCueSingleVector(unsigned int index) {
     GTEVector3_16_t v = {};
     switch (index) {
         case 0: {
@@ -1700,65 +1908,65 @@ void GTE::normalColorDepthCueSingleVector(GTEInstruction instruction, unsigned i
         }
     }
 
-    mac1 = flag.calculateMAC(1, (int64_t)l.v0.x * v.x + l.v0.y * v.y + l.v0.z * v.z) >> (instruction.shiftFraction * 12);
-    mac2 = flag.calculateMAC(2, (int64_t)l.v1.x * v.x + l.v1.y * v.y + l.v1.z * v.z) >> (instruction.shiftFraction * 12);
-    mac3 = flag.calculateMAC(3, (int64_t)l.v2.x * v.x + l.v2.y * v.y + l.v2.z * v.z) >> (instruction.shiftFraction * 12);
+    mac1 = flag.calculateMAC<1>((int64_t)l.v0.x * v.x + l.v0.y * v.y + l.v0.z * v.z) >> (shiftFraction * 12);
+    mac2 = flag.calculateMAC<2>((int64_t)l.v1.x * v.x + l.v1.y * v.y + l.v1.z * v.z) >> (shiftFraction * 12);
+    mac3 = flag.calculateMAC<3>((int64_t)l.v2.x * v.x + l.v2.y * v.y + l.v2.z * v.z) >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     int64_t temporalMAC = 0;
 
-    temporalMAC = flag.calculateMAC(1, (int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.y * ir2);
-    temporalMAC = flag.calculateMAC(1, temporalMAC + (int64_t)lr.v0.z * ir3);
-    mac1 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<1>((int64_t)bk.r * 0x1000 + lr.v0.x * ir1);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.y * ir2);
+    temporalMAC = flag.calculateMAC<1>(temporalMAC + (int64_t)lr.v0.z * ir3);
+    mac1 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(2, (int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.y * ir2);
-    temporalMAC = flag.calculateMAC(2, temporalMAC + (int64_t)lr.v1.z * ir3);
-    mac2 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<2>((int64_t)bk.g * 0x1000 + lr.v1.x * ir1);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.y * ir2);
+    temporalMAC = flag.calculateMAC<2>(temporalMAC + (int64_t)lr.v1.z * ir3);
+    mac2 = temporalMAC >> (shiftFraction * 12);
 
-    temporalMAC = flag.calculateMAC(3, (int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.y * ir2);
-    temporalMAC = flag.calculateMAC(3, temporalMAC + (int64_t)lr.v2.z * ir3);
-    mac3 = temporalMAC >> (instruction.shiftFraction * 12);
+    temporalMAC = flag.calculateMAC<3>((int64_t)bk.b * 0x1000 + lr.v2.x * ir1);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.y * ir2);
+    temporalMAC = flag.calculateMAC<3>(temporalMAC + (int64_t)lr.v2.z * ir3);
+    mac3 = temporalMAC >> (shiftFraction * 12);
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
-    mac1 = flag.calculateMAC(1, (rgbc.r * ir1) << 4);
-    mac2 = flag.calculateMAC(2, (rgbc.g * ir2) << 4);
-    mac3 = flag.calculateMAC(3, (rgbc.b * ir3) << 4);
+    mac1 = flag.calculateMAC<1>((rgbc.r * ir1) << 4);
+    mac2 = flag.calculateMAC<2>((rgbc.g * ir2) << 4);
+    mac3 = flag.calculateMAC<3>((rgbc.b * ir3) << 4);
 
     int32_t mac1Input = mac1;
     int32_t mac2Input = mac2;
     int32_t mac3Input = mac3;
 
-    mac1 = flag.calculateMAC(1, ((int64_t)fc.r << 12) - mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)fc.g << 12) - mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)fc.b << 12) - mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)fc.r << 12) - mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)fc.g << 12) - mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)fc.b << 12) - mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, false);
-    ir2 = flag.calculateIR(2, mac2, false);
-    ir3 = flag.calculateIR(3, mac3, false);
+    ir1 = flag.calculateIR<1, false>(mac1);
+    ir2 = flag.calculateIR<2, false>(mac2);
+    ir3 = flag.calculateIR<3, false>(mac3);
 
-    mac1 = flag.calculateMAC(1, ((int64_t)ir1 * ir0) + mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)ir2 * ir0) + mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)ir3 * ir0) + mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)ir1 * ir0) + mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)ir2 * ir0) + mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)ir3 * ir0) + mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -1782,10 +1990,17 @@ Out:     RGBn              RGB fifo.              Rn,Gn,Bn,CDn [0,8,0]
 Calculation:
 Same as NCDS but repeats for v1 and v2.
 */
-void GTE::normalColorDepthCueTripleVector(GTEInstruction instruction) {
-    normalColorDepthCueSingleVector(instruction, 0);
-    normalColorDepthCueSingleVector(instruction, 1);
-    normalColorDepthCueSingleVector(instruction, 2);
+template <bool shiftFraction, bool lm>
+void GTE::normalColorDepthCueTripleVector() {
+    if (tripleVectorKernels != nullptr) {
+        GTETripleVectorOutput output;
+        tripleVectorKernels->normalColorDepthCue(tripleVectorInput(shiftFraction, lm), output);
+        storeTripleVectorColors(output);
+        return;
+    }
+    normalColorDepthCueSingleVector<shiftFraction, lm>(0);
+    normalColorDepthCueSingleVector<shiftFraction, lm>(1);
+    normalColorDepthCueSingleVector<shiftFraction, lm>(2);
 }
 
 /*
@@ -1813,37 +2028,38 @@ Calculation:
 [0,8,0]   G0<-G1<-G2<- Lm_C2[MAC2]                             [1,27,4]
 [0,8,0]   B0<-B1<-B2<- Lm_C3[MAC3]                             [1,27,4]
 */
-void GTE::depthCueColorLight(GTEInstruction instruction) {
-    mac1 = flag.calculateMAC(1, rgbc.r * ir1) << 4;
-    mac2 = flag.calculateMAC(2, rgbc.g * ir2) << 4;
-    mac3 = flag.calculateMAC(3, rgbc.b * ir3) << 4;
+template <bool shiftFraction, bool lm>
+void GTE::depthCueColorLight() {
+    mac1 = flag.calculateMAC<1>(rgbc.r * ir1) << 4;
+    mac2 = flag.calculateMAC<2>(rgbc.g * ir2) << 4;
+    mac3 = flag.calculateMAC<3>(rgbc.b * ir3) << 4;
 
     int32_t mac1Input = mac1;
     int32_t mac2Input = mac2;
     int32_t mac3Input = mac3;
 
-    mac1 = flag.calculateMAC(1, ((int64_t)fc.r << 12) - mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)fc.g << 12) - mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)fc.b << 12) - mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)fc.r << 12) - mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)fc.g << 12) - mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)fc.b << 12) - mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, false);
-    ir2 = flag.calculateIR(2, mac2, false);
-    ir3 = flag.calculateIR(3, mac3, false);
+    ir1 = flag.calculateIR<1, false>(mac1);
+    ir2 = flag.calculateIR<2, false>(mac2);
+    ir3 = flag.calculateIR<3, false>(mac3);
 
-    mac1 = flag.calculateMAC(1, ((int64_t)ir1 * ir0) + mac1Input) >> instruction.shiftFraction * 12;
-    mac2 = flag.calculateMAC(2, ((int64_t)ir2 * ir0) + mac2Input) >> instruction.shiftFraction * 12;
-    mac3 = flag.calculateMAC(3, ((int64_t)ir3 * ir0) + mac3Input) >> instruction.shiftFraction * 12;
+    mac1 = flag.calculateMAC<1>(((int64_t)ir1 * ir0) + mac1Input) >> shiftFraction * 12;
+    mac2 = flag.calculateMAC<2>(((int64_t)ir2 * ir0) + mac2Input) >> shiftFraction * 12;
+    mac3 = flag.calculateMAC<3>(((int64_t)ir3 * ir0) + mac3Input) >> shiftFraction * 12;
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 
     rgb0._value = rgb1._value;
     rgb1._value = rgb2._value;
 
-    rgb2.r = flag.calculateRGB(1, mac1 >> 4);
-    rgb2.g = flag.calculateRGB(2, mac2 >> 4);
-    rgb2.b = flag.calculateRGB(3, mac3 >> 4);
+    rgb2.r = flag.calculateRGB<1>(mac1 >> 4);
+    rgb2.g = flag.calculateRGB<2>(mac2 >> 4);
+    rgb2.b = flag.calculateRGB<3>(mac3 >> 4);
     rgb2.c = rgbc.c;
 }
 
@@ -1875,6 +2091,7 @@ Notes:
 The cv field allows selection of the far color vector, but this vector
 is not added correctly by the GTE.
 */
+template <bool shiftFraction, bool lm>
 void GTE::multiplyVectorByMatrixAndVectorAddition(GTEInstruction instruction) {
     GTEMatrix_16_t translationMatrix = {};
     switch (instruction.mvmvaTranslationMatrix()) {
@@ -1945,11 +2162,11 @@ void GTE::multiplyVectorByMatrixAndVectorAddition(GTEInstruction instruction) {
             break;
         }
     }
-    mac1 = flag.calculateMAC(1, (int64_t)(translationVector.x * 0x1000 + translationMatrix.v0.x * multiplyVector.x + translationMatrix.v0.y * multiplyVector.y + translationMatrix.v0.z * multiplyVector.z) >> (instruction.shiftFraction * 12));
-    mac2 = flag.calculateMAC(2, (int64_t)(translationVector.y * 0x1000 + translationMatrix.v1.x * multiplyVector.x + translationMatrix.v1.y * multiplyVector.y + translationMatrix.v1.z * multiplyVector.z) >> (instruction.shiftFraction * 12));
-    mac3 = flag.calculateMAC(3, (int64_t)(translationVector.z * 0x1000 + translationMatrix.v2.x * multiplyVector.x + translationMatrix.v2.y * multiplyVector.y + translationMatrix.v2.z * multiplyVector.z) >> (instruction.shiftFraction * 12));
+    mac1 = flag.calculateMAC<1>((int64_t)(translationVector.x * 0x1000 + translationMatrix.v0.x * multiplyVector.x + translationMatrix.v0.y * multiplyVector.y + translationMatrix.v0.z * multiplyVector.z) >> (shiftFraction * 12));
+    mac2 = flag.calculateMAC<2>((int64_t)(translationVector.y * 0x1000 + translationMatrix.v1.x * multiplyVector.x + translationMatrix.v1.y * multiplyVector.y + translationMatrix.v1.z * multiplyVector.z) >> (shiftFraction * 12));
+    mac3 = flag.calculateMAC<3>((int64_t)(translationVector.z * 0x1000 + translationMatrix.v2.x * multiplyVector.x + translationMatrix.v2.y * multiplyVector.y + translationMatrix.v2.z * multiplyVector.z) >> (shiftFraction * 12));
 
-    ir1 = flag.calculateIR(1, mac1, instruction.lm);
-    ir2 = flag.calculateIR(2, mac2, instruction.lm);
-    ir3 = flag.calculateIR(3, mac3, instruction.lm);
+    ir1 = flag.calculateIR<1, lm>(mac1);
+    ir2 = flag.calculateIR<2, lm>(mac2);
+    ir3 = flag.calculateIR<3, lm>(mac3);
 }
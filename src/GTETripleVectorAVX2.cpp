@@ -0,0 +1,79 @@
+#include "GTETripleVector.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+// Only the 64bit accumulators need the wider registers, four 32bit lanes already cover every vector
+struct GTELanesAVX2 {
+    typedef __m128i Type;
+    typedef __m256i WideType;
+
+    static inline Type set(int32_t value) { return _mm_set1_epi32(value); }
+    static inline Type load(const int32_t *values) { return _mm_load_si128((const __m128i *)values); }
+    static inline void store(int32_t *values, Type value) { _mm_store_si128((__m128i *)values, value); }
+    static inline Type add(Type a, Type b) { return _mm_add_epi32(a, b); }
+    static inline Type subtract(Type a, Type b) { return _mm_sub_epi32(a, b); }
+    static inline Type multiply(Type a, Type b) { return _mm_mullo_epi32(a, b); }
+    template <int count>
+    static inline Type shiftRight(Type value) { return _mm_srai_epi32(value, count); }
+    template <int count>
+    static inline Type shiftLeft(Type value) { return _mm_slli_epi32(value, count); }
+    static inline Type shiftRightBy(Type value, uint32_t count) { return _mm_sra_epi32(value, _mm_cvtsi32_si128(count)); }
+    static inline Type bitAnd(Type a, Type b) { return _mm_and_si128(a, b); }
+    static inline Type min(Type a, Type b) { return _mm_min_epi32(a, b); }
+    static inline Type max(Type a, Type b) { return _mm_max_epi32(a, b); }
+    static inline Type equal(Type a, Type b) { return _mm_cmpeq_epi32(a, b); }
+    static inline Type greaterThan(Type a, Type b) { return _mm_cmpgt_epi32(a, b); }
+    static inline Type select(Type mask, Type a, Type b) { return _mm_blendv_epi8(b, a, mask); }
+    static inline uint32_t signBits(Type value) { return _mm_movemask_ps(_mm_castsi128_ps(value)); }
+
+    // Values from 1 to FFFFh convert to floats exactly, so the exponent gives the highest set bit
+    static inline Type leadingZeros16(Type value) {
+        return _mm_sub_epi32(_mm_set1_epi32(15 + 127), _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(value)), 23));
+    }
+    static inline Type shiftLeftBy(Type value, Type count) { return _mm_sllv_epi32(value, count); }
+    static inline Type lookup(const uint32_t *table, Type index) { return _mm_i32gather_epi32((const int *)table, index, 4); }
+
+    static inline WideType setWide(int64_t value) { return _mm256_set1_epi64x(value); }
+    static inline WideType widen(Type value) { return _mm256_cvtepi32_epi64(value); }
+    static inline Type narrow(WideType value) {
+        return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(value, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+    }
+    static inline WideType addWide(WideType a, WideType b) { return _mm256_add_epi64(a, b); }
+    // Unsigned, only the low 32bit of each lane take part
+    static inline WideType multiplyWide(WideType a, WideType b) { return _mm256_mul_epu32(a, b); }
+    static inline WideType subtractWide(WideType a, WideType b) { return _mm256_sub_epi64(a, b); }
+    // There's no arithmetic 64bit shift before AVX-512, so negative lanes get flipped around a logical one
+    static inline WideType shiftRightWide(WideType value, uint32_t count) {
+        __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), value);
+        return _mm256_xor_si256(_mm256_srl_epi64(_mm256_xor_si256(value, sign), _mm_cvtsi32_si128(count)), sign);
+    }
+    // Sign extends from bit 43
+    static inline WideType truncate44(WideType value) {
+        __m256i sign = _mm256_set1_epi64x(0x80000000000);
+        return _mm256_sub_epi64(_mm256_xor_si256(_mm256_and_si256(value, _mm256_set1_epi64x(0xFFFFFFFFFFF)), sign), sign);
+    }
+    static inline WideType equalWide(WideType a, WideType b) { return _mm256_cmpeq_epi64(a, b); }
+    static inline uint32_t signBitsWide(WideType value) { return _mm256_movemask_pd(_mm256_castsi256_pd(value)); }
+};
+
+#include "GTETripleVectorKernels.tcc"
+
+static const GTETripleVectorKernels GTE_TRIPLE_VECTOR_KERNELS_AVX2 = {
+    gtePerspectiveTransformation<GTELanesAVX2>,
+    gteNormalColor<GTELanesAVX2>,
+    gteNormalColorColor<GTELanesAVX2>,
+    gteNormalColorDepthCue<GTELanesAVX2>
+};
+#endif
+
+/*
+Returns nullptr when this file was not built with AVX2 enabled.
+*/
+const GTETripleVectorKernels* gteTripleVectorKernelsAVX2() {
+#ifdef __AVX2__
+    return &GTE_TRIPLE_VECTOR_KERNELS_AVX2;
+#else
+    return nullptr;
+#endif
+}
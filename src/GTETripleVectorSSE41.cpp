@@ -0,0 +1,94 @@
+#include "GTETripleVector.hpp"
+
+#ifdef __SSE4_1__
+#include <immintrin.h>
+
+struct GTELanesSSE41 {
+    typedef __m128i Type;
+    struct WideType {
+        __m128i low;
+        __m128i high;
+    };
+
+    static inline Type set(int32_t value) { return _mm_set1_epi32(value); }
+    static inline Type load(const int32_t *values) { return _mm_load_si128((const __m128i *)values); }
+    static inline void store(int32_t *values, Type value) { _mm_store_si128((__m128i *)values, value); }
+    static inline Type add(Type a, Type b) { return _mm_add_epi32(a, b); }
+    static inline Type subtract(Type a, Type b) { return _mm_sub_epi32(a, b); }
+    static inline Type multiply(Type a, Type b) { return _mm_mullo_epi32(a, b); }
+    template <int count>
+    static inline Type shiftRight(Type value) { return _mm_srai_epi32(value, count); }
+    template <int count>
+    static inline Type shiftLeft(Type value) { return _mm_slli_epi32(value, count); }
+    static inline Type shiftRightBy(Type value, uint32_t count) { return _mm_sra_epi32(value, _mm_cvtsi32_si128(count)); }
+    static inline Type bitAnd(Type a, Type b) { return _mm_and_si128(a, b); }
+    static inline Type min(Type a, Type b) { return _mm_min_epi32(a, b); }
+    static inline Type max(Type a, Type b) { return _mm_max_epi32(a, b); }
+    static inline Type equal(Type a, Type b) { return _mm_cmpeq_epi32(a, b); }
+    static inline Type greaterThan(Type a, Type b) { return _mm_cmpgt_epi32(a, b); }
+    static inline Type select(Type mask, Type a, Type b) { return _mm_blendv_epi8(b, a, mask); }
+    static inline uint32_t signBits(Type value) { return _mm_movemask_ps(_mm_castsi128_ps(value)); }
+
+    // Values from 1 to FFFFh convert to floats exactly, so the exponent gives the highest set bit
+    static inline Type leadingZeros16(Type value) {
+        return _mm_sub_epi32(_mm_set1_epi32(15 + 127), _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(value)), 23));
+    }
+    // No per lane shifts before AVX2, so lanes get multiplied by the power of two built as a float
+    static inline Type shiftLeftBy(Type value, Type count) {
+        __m128i power = _mm_slli_epi32(_mm_add_epi32(count, _mm_set1_epi32(127)), 23);
+        return _mm_mullo_epi32(value, _mm_cvttps_epi32(_mm_castsi128_ps(power)));
+    }
+    static inline Type lookup(const uint32_t *table, Type index) {
+        return _mm_setr_epi32(table[_mm_extract_epi32(index, 0)], table[_mm_extract_epi32(index, 1)], table[_mm_extract_epi32(index, 2)], table[_mm_extract_epi32(index, 3)]);
+    }
+
+    static inline WideType setWide(int64_t value) { return { _mm_set1_epi64x(value), _mm_set1_epi64x(value) }; }
+    static inline WideType widen(Type value) { return { _mm_cvtepi32_epi64(value), _mm_cvtepi32_epi64(_mm_srli_si128(value, 8)) }; }
+    static inline Type narrow(WideType value) {
+        return _mm_unpacklo_epi64(_mm_shuffle_epi32(value.low, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_epi32(value.high, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+    static inline WideType addWide(WideType a, WideType b) { return { _mm_add_epi64(a.low, b.low), _mm_add_epi64(a.high, b.high) }; }
+    // Unsigned, only the low 32bit of each lane take part
+    static inline WideType multiplyWide(WideType a, WideType b) { return { _mm_mul_epu32(a.low, b.low), _mm_mul_epu32(a.high, b.high) }; }
+    static inline WideType subtractWide(WideType a, WideType b) { return { _mm_sub_epi64(a.low, b.low), _mm_sub_epi64(a.high, b.high) }; }
+    // There's no arithmetic 64bit shift before AVX-512, so negative lanes get flipped around a logical one
+    static inline __m128i shiftRightHalf(__m128i value, __m128i count) {
+        __m128i sign = _mm_shuffle_epi32(_mm_srai_epi32(value, 31), _MM_SHUFFLE(3, 3, 1, 1));
+        return _mm_xor_si128(_mm_srl_epi64(_mm_xor_si128(value, sign), count), sign);
+    }
+    static inline WideType shiftRightWide(WideType value, uint32_t count) {
+        __m128i shift = _mm_cvtsi32_si128(count);
+        return { shiftRightHalf(value.low, shift), shiftRightHalf(value.high, shift) };
+    }
+    // Sign extends from bit 43
+    static inline __m128i truncate44Half(__m128i value) {
+        __m128i sign = _mm_set1_epi64x(0x80000000000);
+        return _mm_sub_epi64(_mm_xor_si128(_mm_and_si128(value, _mm_set1_epi64x(0xFFFFFFFFFFF)), sign), sign);
+    }
+    static inline WideType truncate44(WideType value) { return { truncate44Half(value.low), truncate44Half(value.high) }; }
+    static inline WideType equalWide(WideType a, WideType b) { return { _mm_cmpeq_epi64(a.low, b.low), _mm_cmpeq_epi64(a.high, b.high) }; }
+    static inline uint32_t signBitsWide(WideType value) {
+        return _mm_movemask_pd(_mm_castsi128_pd(value.low)) | (_mm_movemask_pd(_mm_castsi128_pd(value.high)) << 2);
+    }
+};
+
+#include "GTETripleVectorKernels.tcc"
+
+static const GTETripleVectorKernels GTE_TRIPLE_VECTOR_KERNELS_SSE41 = {
+    gtePerspectiveTransformation<GTELanesSSE41>,
+    gteNormalColor<GTELanesSSE41>,
+    gteNormalColorColor<GTELanesSSE41>,
+    gteNormalColorDepthCue<GTELanesSSE41>
+};
+#endif
+
+/*
+Returns nullptr when this file was not built with SSE4.1 enabled.
+*/
+const GTETripleVectorKernels* gteTripleVectorKernelsSSE41() {
+#ifdef __SSE4_1__
+    return &GTE_TRIPLE_VECTOR_KERNELS_SSE41;
+#else
+    return nullptr;
+#endif
+}
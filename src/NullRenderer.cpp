@@ -0,0 +1,150 @@
+#include "NullRenderer.hpp"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include "GPU.hpp"
+#include "ConfigurationManager.hpp"
+
+using namespace std;
+
+NullRenderer::NullRenderer(std::unique_ptr<Window> &mainWindow, GPU *gpu) : logger(LogLevel::NoLog), mainWindow(mainWindow), vram(VRAM_WIDTH * VRAM_HEIGHT), displayAreaStart(), screenResolution({}) {
+    ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
+    resizeToFitFramebuffer = configurationManager->shouldResizeWindowToFitFramebuffer();
+    displayAreaStart = gpu->getDisplayAreaStart();
+    screenResolution = gpu->getResolution();
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+NullRenderer::~NullRenderer() {}
+
+void NullRenderer::countPrimitive(RendererPrimitiveType type, bool opaque, TextureBlendMode textureBlendMode) {
+    frameStatistics.primitives[type]++;
+    if (textureBlendMode != TextureBlendMode::TextureBlendModeNoTexture) {
+        frameStatistics.texturedPrimitives++;
+    }
+    if (!opaque) {
+        frameStatistics.semiTransparentPrimitives++;
+    }
+}
+
+void NullRenderer::pushLine(std::vector<Vertex> vertices, bool opaque) {
+    for (unsigned int i = 0; i + 1 < vertices.size(); i += 2) {
+        countPrimitive(RendererPrimitiveType::RendererPrimitiveTypeLine, opaque, TextureBlendMode::TextureBlendModeNoTexture);
+    }
+}
+
+void NullRenderer::pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) {
+    countPrimitive(vertices.size() == 3 ? RendererPrimitiveType::RendererPrimitiveTypeTriangle : RendererPrimitiveType::RendererPrimitiveTypeQuad, opaque, textureBlendMode);
+}
+
+void NullRenderer::pushRectangle(RectangleInstance rectangle) {
+    countPrimitive(RendererPrimitiveType::RendererPrimitiveTypeQuad, !rectangle.transparent, TextureBlendMode(rectangle.textureBlendMode));
+}
+
+void NullRenderer::setDrawingOffset(int16_t x, int16_t y) {
+    (void)x;
+    (void)y;
+}
+
+void NullRenderer::setSemiTransparencyMode(uint8_t mode) {
+    (void)mode;
+}
+
+void NullRenderer::setDithering(bool enabled) {
+    (void)enabled;
+}
+
+void NullRenderer::setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) {
+    (void)maskX;
+    (void)maskY;
+    (void)offsetX;
+    (void)offsetY;
+}
+
+void NullRenderer::setMaskBitSetting(bool setMaskBit, bool checkMaskBit) {
+    (void)setMaskBit;
+    (void)checkMaskBit;
+}
+
+void NullRenderer::prepareFrame() {}
+
+void NullRenderer::renderFrame(RendererFlushReason reason) {
+    (void)reason;
+}
+
+void NullRenderer::finalizeFrame() {
+    endFrameStatistics();
+}
+
+void NullRenderer::skipFrame() {
+    frameStatistics.skippedFrames++;
+    endFrameStatistics();
+}
+
+void NullRenderer::updateWindowTitle(string title) {
+    if (mainWindow->isHeadless()) {
+        return;
+    }
+    SDL_SetWindowTitle(mainWindow->getWindowRef(), title.c_str());
+}
+
+void NullRenderer::writeImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    uint16_t x, y, width, height;
+    tie(x, y) = imageBuffer->destination();
+    tie(width, height) = imageBuffer->resolution();
+    uint16_t *buffer = imageBuffer->bufferRef();
+    for (uint32_t row = 0; row < height; row++) {
+        uint32_t rowOffset = ((y + row) & (VRAM_HEIGHT - 1)) * VRAM_WIDTH;
+        for (uint32_t column = 0; column < width; column++) {
+            vram[rowOffset + ((x + column) & (VRAM_WIDTH - 1))] = buffer[row * width + column];
+        }
+    }
+}
+
+void NullRenderer::loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    uint16_t width, height;
+    tie(width, height) = imageBuffer->resolution();
+    writeImage(imageBuffer);
+    frameStatistics.vramUploads++;
+    frameStatistics.vramUploadBytes += ((uint64_t)width) * height * sizeof(uint16_t);
+}
+
+void NullRenderer::fillRectangle(Point2D topLeft, Dimensions size, uint16_t color) {
+    for (uint32_t row = 0; row < size.height; row++) {
+        uint16_t *destination = &vram[(topLeft.y + row) * VRAM_WIDTH + topLeft.x];
+        fill(destination, destination + size.width, color);
+    }
+    frameStatistics.vramFills++;
+}
+
+void NullRenderer::copyRectangle(Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit) {
+    copyVRAMRectangle(vram.data(), source, destination, size, setMaskBit, checkMaskBit);
+    frameStatistics.vramCopies++;
+}
+
+std::vector<uint16_t> NullRenderer::readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    return readVRAMRectangle(vram.data(), x, y, width, height);
+}
+
+void NullRenderer::resetMainWindow() {}
+
+void NullRenderer::setDisplayAreaSart(Point2D point) {
+    displayAreaStart = point;
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+void NullRenderer::setScreenResolution(Dimensions dimensions) {
+    screenResolution = dimensions;
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+void NullRenderer::setDrawingArea(Point2D topLeft, Dimensions size) {
+    (void)topLeft;
+    (void)size;
+}
+
+void NullRenderer::toggleRenderPolygonOneByOne() {}
+
+void NullRenderer::startCapture(std::filesystem::path filePath) {
+    (void)filePath;
+    logger.logWarning("Frame capture is not available with the null renderer");
+}
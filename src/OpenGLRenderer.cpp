@@ -0,0 +1,679 @@
+#include "OpenGLRenderer.hpp"
+#include <glad/glad.h>
+#include <fstream>
+#include <streambuf>
+#include <vector>
+#include "RendererDebugger.hpp"
+#include "Framebuffer.hpp"
+#include "GPU.hpp"
+#include "ConfigurationManager.hpp"
+
+using namespace std;
+
+OpenGLRenderer::OpenGLRenderer(std::unique_ptr<Window> &mainWindow, GPU *gpu) : logger(LogLevel::NoLog), vertices(), rectangles(), mainWindow(mainWindow), mode(GL_TRIANGLES), drawingOffset(), batchLeft(VRAM_WIDTH), batchTop(VRAM_HEIGHT), batchRight(-1), batchBottom(-1), displayAreaStart(), screenResolution({}), drawingAreaTopLeft(), drawingAreaSize({}), renderPolygonOneByOne(false), orderingIndex(0), semiTransparencyMode(0), subtractiveBlending(false) {
+    ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
+    resizeToFitFramebuffer = configurationManager->shouldResizeWindowToFitFramebuffer();
+    useTextureCache = configurationManager->shouldUseTextureCache();
+    resolutionScale = configurationManager->internalResolution();
+
+    textureRendererProgram = make_unique<RendererProgram>("./glsl/texture_load_vertex.glsl", "./glsl/texture_load_fragment.glsl");
+
+    textureBuffer = make_unique<RendererBuffer<Point2D>>(textureRendererProgram, RENDERER_BUFFER_SIZE);
+
+    program = make_unique<RendererProgram>("glsl/vertex.glsl", "glsl/fragment.glsl");
+    program->useProgram();
+
+    buffer = make_unique<RendererBuffer<Vertex>>(program, RENDERER_BUFFER_SIZE);
+
+    offsetUniform = program->findProgramUniform("offset");
+    glUniform2i(offsetUniform, 0, 0);
+
+    subtractiveBlendPassUniform = program->findProgramUniform("subtractive_blend_pass");
+    glUniform1ui(subtractiveBlendPassUniform, 0);
+
+    GLuint frameBufferTextureUniform = program->findProgramUniform("frame_buffer_texture");
+    glUniform1i(frameBufferTextureUniform, 0);
+    GLuint textureCacheUniform = program->findProgramUniform("texture_cache");
+    glUniform1i(textureCacheUniform, 1);
+
+    // Rectangles share the fragment shader, their corners are built in the vertex shader
+    rectangleProgram = make_unique<RendererProgram>("glsl/rectangle_vertex.glsl", "glsl/fragment.glsl");
+    rectangleProgram->useProgram();
+
+    rectangleBuffer = make_unique<RendererBuffer<RectangleInstance>>(rectangleProgram, RENDERER_BUFFER_SIZE);
+
+    rectangleOffsetUniform = rectangleProgram->findProgramUniform("offset");
+    glUniform2i(rectangleOffsetUniform, 0, 0);
+
+    rectangleSubtractiveBlendPassUniform = rectangleProgram->findProgramUniform("subtractive_blend_pass");
+    glUniform1ui(rectangleSubtractiveBlendPassUniform, 0);
+
+    GLuint rectangleFrameBufferTextureUniform = rectangleProgram->findProgramUniform("frame_buffer_texture");
+    glUniform1i(rectangleFrameBufferTextureUniform, 0);
+    GLuint rectangleTextureCacheUniform = rectangleProgram->findProgramUniform("texture_cache");
+    glUniform1i(rectangleTextureCacheUniform, 1);
+
+    Dimensions screenDimensions = mainWindow->getDimensions();
+
+    string screenVertexFile = "./glsl/screen_vertex.glsl";
+    screenRendererProgram = make_unique<RendererProgram>(screenVertexFile, "./glsl/screen_fragment.glsl");
+    screenRendererProgram->useProgram();
+    GLuint screenWidthUniform = screenRendererProgram->findProgramUniform("screen_width");
+    glUniform1f(screenWidthUniform, screenDimensions.width);
+    GLuint screenHeightUniform = screenRendererProgram->findProgramUniform("screen_height");
+    glUniform1f(screenHeightUniform, screenDimensions.height);
+    GLuint vramWidthUniform = screenRendererProgram->findProgramUniform("vram_width");
+    glUniform1f(vramWidthUniform, VRAM_WIDTH);
+    GLuint vramHeightUniform = screenRendererProgram->findProgramUniform("vram_height");
+    glUniform1f(vramHeightUniform, VRAM_HEIGHT);
+    GLuint fullFramebufferUniform = screenRendererProgram->findProgramUniform("full_framebuffer");
+    glUniform1f(fullFramebufferUniform, resizeToFitFramebuffer);
+
+    screenBuffer = make_unique<RendererBuffer<Pixel>>(screenRendererProgram, RENDERER_BUFFER_SIZE);
+
+    unpackBuffer = make_unique<PixelUnpackBuffer>();
+    loadImageTexture = make_unique<Texture>(((GLsizei) VRAM_WIDTH), ((GLsizei) VRAM_HEIGHT));
+    textureCache = make_unique<TextureCache>();
+
+    screenTexture = make_unique<Texture>(((GLsizei) (VRAM_WIDTH * resolutionScale)), ((GLsizei) (VRAM_HEIGHT * resolutionScale)));
+    downsampleTexture = make_unique<Texture>(((GLsizei) VRAM_WIDTH), ((GLsizei) VRAM_HEIGHT));
+
+    GLfloat lineWidthRange[2];
+    glGetFloatv(GL_ALIASED_LINE_WIDTH_RANGE, lineWidthRange);
+    glLineWidth(min((GLfloat)resolutionScale, lineWidthRange[1]));
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+
+    rendererDebugger->checkForOpenGLErrors();
+
+    if (configurationManager->rendererBackend() == RendererBackendCompute) {
+        computeRasterizer = make_unique<ComputeRasterizer>();
+    }
+
+    displayAreaStart = gpu->getDisplayAreaStart();
+    screenResolution = gpu->getResolution();
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+OpenGLRenderer::~OpenGLRenderer() {
+    // Pending frames are read back and the unpack buffer unmapped on destruction, which needs the
+    // context to still be around
+    frameCapture.reset();
+    unpackBuffer.reset();
+    SDL_Quit();
+}
+
+void OpenGLRenderer::checkRenderPolygonOneByOne() {
+    if (!renderPolygonOneByOne) {
+        return;
+    }
+    prepareFrame();
+    renderFrame(RendererFlushReason::RendererFlushReasonPolygonOneByOne);
+    finalizeFrame();
+}
+
+void OpenGLRenderer::checkForceDraw(unsigned int verticesToRender, GLenum newMode) {
+    if (computeRasterizer) {
+        // Lines and triangles take one primitive each, so the vertex count is an upper bound
+        if (computeRasterizer->remainingCapacity() < verticesToRender) {
+            renderFrame(RendererFlushReason::RendererFlushReasonBufferFull);
+        }
+        return;
+    }
+    // Rectangles are batched as GL_TRIANGLE_STRIP instances, one per rectangle
+    if (newMode == GL_TRIANGLE_STRIP) {
+        if (rectangleBuffer->remainingCapacity() < rectangles.size() + verticesToRender) {
+            renderFrame(RendererFlushReason::RendererFlushReasonBufferFull);
+        }
+    } else {
+        unsigned int verticesToRenderTotal = verticesToRender;
+        if (verticesToRender == 4) {
+            verticesToRenderTotal = 6;
+        }
+        if (buffer->remainingCapacity() < vertices.size() + verticesToRenderTotal) {
+            renderFrame(RendererFlushReason::RendererFlushReasonBufferFull);
+        }
+    }
+    if (mode != newMode) {
+        renderFrame(RendererFlushReason::RendererFlushReasonModeChange);
+    }
+    return;
+}
+
+void OpenGLRenderer::applyScissor() {
+    // Scissor test is specified in framebuffer coordinates, the screen texture holds the whole
+    // VRAM upside down and scaled by the internal resolution, so translate the drawing area
+    GLint scale = resolutionScale;
+    GLsizei width = drawingAreaSize.width * scale;
+    GLsizei height = drawingAreaSize.height * scale;
+    GLint x = drawingAreaTopLeft.x * scale;
+    GLint y = ((GLint)VRAM_HEIGHT - (GLint)drawingAreaSize.height - drawingAreaTopLeft.y) * scale;
+    glScissor(x, y, width, height);
+    glEnable(GL_SCISSOR_TEST);
+}
+
+/*
+B-F pixels are drawn in a second pass after the rest of the batch, so a primitive is never batched
+together with an overlapping one when either of them subtracts. Primitives that don't overlap can't
+tell in which order they were drawn.
+*/
+void OpenGLRenderer::checkSubtractiveBlending(bool subtractive, GLint left, GLint top, GLint right, GLint bottom) {
+    if (vertices.empty() && rectangles.empty()) {
+        return;
+    }
+    if (!subtractive && !subtractiveBlending) {
+        return;
+    }
+    if (left > batchRight || right < batchLeft || top > batchBottom || bottom < batchTop) {
+        return;
+    }
+    renderFrame(RendererFlushReason::RendererFlushReasonSubtractiveBlending);
+}
+
+void OpenGLRenderer::checkSubtractiveBlending(const std::vector<Vertex> &vertices, bool opaque) {
+    GLint left = VRAM_WIDTH;
+    GLint top = VRAM_HEIGHT;
+    GLint right = -1;
+    GLint bottom = -1;
+    // Grown the same way as the batch bounds in insertVertices
+    for (const auto& vertix : vertices) {
+        left = min(left, vertix.point.x + drawingOffset.x - 1);
+        top = min(top, vertix.point.y + drawingOffset.y - 1);
+        right = max(right, vertix.point.x + drawingOffset.x + 1);
+        bottom = max(bottom, vertix.point.y + drawingOffset.y + 1);
+    }
+    checkSubtractiveBlending(!opaque && semiTransparencyMode == SEMI_TRANSPARENCY_SUBTRACT, left, top, right, bottom);
+}
+
+void OpenGLRenderer::insertVertices(std::vector<Vertex> vertices, bool opaque) {
+    for (auto& vertix : vertices) {
+        vertix.semiTransparency = semiTransparencyMode;
+    }
+    if (!opaque && semiTransparencyMode == SEMI_TRANSPARENCY_SUBTRACT) {
+        subtractiveBlending = true;
+    }
+    // Grown by a pixel on every side to account for wide lines at higher internal resolutions
+    for (auto& vertix : vertices) {
+        batchLeft = min(batchLeft, vertix.point.x + drawingOffset.x - 1);
+        batchTop = min(batchTop, vertix.point.y + drawingOffset.y - 1);
+        batchRight = max(batchRight, vertix.point.x + drawingOffset.x + 1);
+        batchBottom = max(batchBottom, vertix.point.y + drawingOffset.y + 1);
+    }
+    this->vertices.insert(this->vertices.end(), vertices.begin(), vertices.end());
+}
+
+/*
+Layer of the texture cache holding the decoded page, or -1 when the primitive samples VRAM directly.
+*/
+GLint OpenGLRenderer::textureCacheLayerFor(Point2D texturePage, Point2D clut, GLuint textureDepthShift, TextureBlendMode textureBlendMode) {
+    if (!useTextureCache || textureBlendMode == TextureBlendMode::TextureBlendModeNoTexture || textureDepthShift == 0) {
+        return -1;
+    }
+    GLint layer = textureCache->layerFor(texturePage, clut, textureDepthShift);
+    if (layer < 0) {
+        renderFrame(RendererFlushReason::RendererFlushReasonTextureCacheFull);
+        layer = textureCache->layerFor(texturePage, clut, textureDepthShift);
+    }
+    return layer;
+}
+
+void OpenGLRenderer::assignTextureCacheLayer(std::vector<Vertex> &vertices, TextureBlendMode textureBlendMode) {
+    Vertex &vertex = vertices.front();
+    GLint layer = textureCacheLayerFor(vertex.texturePage, vertex.clut, vertex.textureDepthShift, textureBlendMode);
+    for (auto& vertix : vertices) {
+        vertix.textureCacheLayer = layer;
+    }
+}
+
+void OpenGLRenderer::pushLine(std::vector<Vertex> vertices, bool opaque) {
+    unsigned int size = vertices.size();
+    if (size < 2) {
+        logger.logError("Unhandled line with %d vertices", size);
+        return;
+    }
+    checkForceDraw(size, GL_LINES);
+    mode = GL_LINES;
+    markVRAMWritten(drawingAreaTopLeft, drawingAreaSize);
+    frameStatistics.primitives[RendererPrimitiveType::RendererPrimitiveTypeLine] += size / 2;
+    if (!opaque) {
+        frameStatistics.semiTransparentPrimitives += size / 2;
+    }
+    if (computeRasterizer) {
+        if (computeRasterizer->conflictsWithBatch(vertices)) {
+            renderFrame(RendererFlushReason::RendererFlushReasonTextureRead);
+        }
+        for (unsigned int i = 0; i + 1 < size; i += 2) {
+            computeRasterizer->pushLine(vertices[i], vertices[i + 1], opaque);
+        }
+        checkRenderPolygonOneByOne();
+        return;
+    }
+    checkSubtractiveBlending(vertices, opaque);
+    orderingIndex++;
+    for (auto& vertix : vertices) {
+        vertix.point.z = orderingIndex;
+    }
+    insertVertices(vertices, opaque);
+    checkRenderPolygonOneByOne();
+    return;
+}
+
+void OpenGLRenderer::pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) {
+    unsigned int size = vertices.size();
+    if (size < 3 || size > 4) {
+        logger.logError("Unhandled polygon with %d vertices", size);
+        return;
+    }
+    checkForceDraw(size, GL_TRIANGLES);
+    mode = GL_TRIANGLES;
+    markVRAMWritten(drawingAreaTopLeft, drawingAreaSize);
+    frameStatistics.primitives[size == 3 ? RendererPrimitiveType::RendererPrimitiveTypeTriangle : RendererPrimitiveType::RendererPrimitiveTypeQuad]++;
+    if (textureBlendMode != TextureBlendMode::TextureBlendModeNoTexture) {
+        frameStatistics.texturedPrimitives++;
+    }
+    if (!opaque) {
+        frameStatistics.semiTransparentPrimitives++;
+    }
+    if (computeRasterizer) {
+        if (computeRasterizer->conflictsWithBatch(vertices)) {
+            renderFrame(RendererFlushReason::RendererFlushReasonTextureRead);
+        }
+        computeRasterizer->pushPolygon(vertices, opaque);
+        checkRenderPolygonOneByOne();
+        return;
+    }
+    assignTextureCacheLayer(vertices, textureBlendMode);
+    checkSubtractiveBlending(vertices, opaque);
+    orderingIndex++;
+    for (auto& vertix : vertices) {
+        vertix.point.z = orderingIndex;
+    }
+    switch (size) {
+        case 3: {
+            insertVertices(vertices, opaque);
+            checkRenderPolygonOneByOne();
+            break;
+        }
+        case 4: {
+            insertVertices(vector<Vertex>(vertices.begin(), vertices.end() - 1), opaque);
+            checkRenderPolygonOneByOne();
+            insertVertices(vector<Vertex>(vertices.begin() + 1, vertices.end()), opaque);
+            checkRenderPolygonOneByOne();
+            break;
+        }
+    }
+    return;
+}
+
+/*
+Rectangles are queued as single instances and expanded in the vertex shader. The compute rasterizer
+takes them as regular quads.
+*/
+void OpenGLRenderer::pushRectangle(RectangleInstance rectangle) {
+    bool opaque = !rectangle.transparent;
+    TextureBlendMode textureBlendMode = TextureBlendMode(rectangle.textureBlendMode);
+    if (computeRasterizer) {
+        pushPolygon(rectangle.vertices(), opaque, textureBlendMode);
+        return;
+    }
+    checkForceDraw(1, GL_TRIANGLE_STRIP);
+    mode = GL_TRIANGLE_STRIP;
+    markVRAMWritten(drawingAreaTopLeft, drawingAreaSize);
+    frameStatistics.primitives[RendererPrimitiveType::RendererPrimitiveTypeQuad]++;
+    if (textureBlendMode != TextureBlendMode::TextureBlendModeNoTexture) {
+        frameStatistics.texturedPrimitives++;
+    }
+    if (!opaque) {
+        frameStatistics.semiTransparentPrimitives++;
+    }
+    rectangle.textureCacheLayer = textureCacheLayerFor(rectangle.texturePage, rectangle.clut, rectangle.textureDepthShift, textureBlendMode);
+    rectangle.semiTransparency = semiTransparencyMode;
+    GLint left = rectangle.point.x + drawingOffset.x - 1;
+    GLint top = rectangle.point.y + drawingOffset.y - 1;
+    GLint right = rectangle.point.x + rectangle.size.x + drawingOffset.x + 1;
+    GLint bottom = rectangle.point.y + rectangle.size.y + drawingOffset.y + 1;
+    bool subtractive = !opaque && semiTransparencyMode == SEMI_TRANSPARENCY_SUBTRACT;
+    checkSubtractiveBlending(subtractive, left, top, right, bottom);
+    if (subtractive) {
+        subtractiveBlending = true;
+    }
+    batchLeft = min(batchLeft, left);
+    batchTop = min(batchTop, top);
+    batchRight = max(batchRight, right);
+    batchBottom = max(batchBottom, bottom);
+    rectangles.push_back(rectangle);
+    checkRenderPolygonOneByOne();
+}
+
+void OpenGLRenderer::resetMainWindow() {
+    mainWindow->makeCurrent();
+}
+
+void OpenGLRenderer::setDisplayAreaSart(Point2D point) {
+    displayAreaStart = point;
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+void OpenGLRenderer::setScreenResolution(Dimensions dimensions) {
+    screenResolution = dimensions;
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+void OpenGLRenderer::setDrawingArea(Point2D topLeft, Dimensions size) {
+    // Primitives batched for the compute rasterizer carry their own clipping rectangle
+    if (computeRasterizer) {
+        drawingAreaTopLeft = topLeft;
+        drawingAreaSize = size;
+        computeRasterizer->setDrawingArea(topLeft, size);
+        return;
+    }
+    renderFrame(RendererFlushReason::RendererFlushReasonDrawingArea);
+
+    drawingAreaTopLeft = topLeft;
+    drawingAreaSize = size;
+
+    applyScissor();
+}
+
+void OpenGLRenderer::toggleRenderPolygonOneByOne() {
+    renderPolygonOneByOne = !renderPolygonOneByOne;
+}
+
+void OpenGLRenderer::startCapture(std::filesystem::path filePath) {
+    frameCapture = make_unique<FrameCapture>(filePath);
+}
+
+void OpenGLRenderer::prepareFrame() {
+    resetMainWindow();
+    applyScissor();
+    glEnable(GL_SCISSOR_TEST);
+}
+
+void OpenGLRenderer::renderFrame(RendererFlushReason reason) {
+    program->useProgram();
+    if (computeRasterizer) {
+        if (computeRasterizer->isEmpty()) {
+            return;
+        }
+        uint32_t primitives = computeRasterizer->flush();
+        frameStatistics.drawCalls++;
+        frameStatistics.bytesUploaded += primitives * sizeof(ComputePrimitive);
+        frameStatistics.flushes[reason]++;
+        return;
+    }
+    if (vertices.empty() && rectangles.empty()) {
+        return;
+    }
+    loadImageTexture->bind(GL_TEXTURE0);
+    textureCache->bind(GL_TEXTURE1);
+    glActiveTexture(GL_TEXTURE0);
+
+    Framebuffer framebuffer = Framebuffer(screenTexture);
+
+    // A mode change flushes the batch, so it holds either rectangles or vertices
+    bool drawRectangles = !rectangles.empty();
+    GLuint batchOffsetUniform = drawRectangles ? rectangleOffsetUniform : offsetUniform;
+    GLuint batchSubtractiveBlendPassUniform = drawRectangles ? rectangleSubtractiveBlendPassUniform : subtractiveBlendPassUniform;
+    (drawRectangles ? rectangleProgram : program)->useProgram();
+    glUniform2i(batchOffsetUniform, ((GLint)drawingOffset.x), ((GLint)drawingOffset.y));
+
+    // The fragment shader outputs the already weighted foreground color and, as the second
+    // source, the factor the background is multiplied by, which covers opaque pixels and the
+    // B/2+F/2, B+F and B+F/4 modes in a single pass
+    glBlendFuncSeparate(GL_ONE, GL_SRC1_COLOR, GL_ONE, GL_ZERO);
+    glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+    glEnable(GL_BLEND);
+    glUniform1ui(batchSubtractiveBlendPassUniform, 0);
+
+    drawBatch();
+
+    // B-F needs a different blend equation, so batches using it draw those pixels in a second pass.
+    // Nothing overlapping a B-F primitive shares its batch, so the submission order still holds
+    if (subtractiveBlending) {
+        glBlendEquationSeparate(GL_FUNC_REVERSE_SUBTRACT, GL_FUNC_ADD);
+        glUniform1ui(batchSubtractiveBlendPassUniform, 1);
+
+        drawBatch();
+        subtractiveBlending = false;
+    }
+    glDisable(GL_BLEND);
+    vertices.clear();
+    rectangles.clear();
+    batchLeft = VRAM_WIDTH;
+    batchTop = VRAM_HEIGHT;
+    batchRight = -1;
+    batchBottom = -1;
+    frameStatistics.flushes[reason]++;
+    orderingIndex = 0;
+    textureCache->nextBatch();
+
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+void OpenGLRenderer::drawBatch() {
+    if (!rectangles.empty()) {
+        rectangleBuffer->addData(rectangles);
+        rectangleBuffer->drawInstances(GL_TRIANGLE_STRIP, 4);
+        frameStatistics.drawCalls++;
+        frameStatistics.bytesUploaded += rectangles.size() * sizeof(RectangleInstance);
+        return;
+    }
+    buffer->addData(vertices);
+    buffer->draw(mode);
+    frameStatistics.drawCalls++;
+    frameStatistics.verticesUploaded += vertices.size();
+    frameStatistics.bytesUploaded += vertices.size() * sizeof(Vertex);
+}
+
+/*
+When nothing touched the presented area since the last present, the screen texture and the window
+already show this frame, so the resolve, blit and swap are left out. Captures still get the frame.
+*/
+void OpenGLRenderer::finalizeFrame() {
+    bool presentedAreaChanged = takePresentedAreaDirty() | mainWindow->takeExposed();
+    if (!presentedAreaChanged) {
+        frameStatistics.unchangedFrames++;
+    }
+    endFrameStatistics();
+    if (computeRasterizer && presentedAreaChanged) {
+        computeRasterizer->resolve(screenTexture);
+    }
+    if (frameCapture) {
+        frameCapture->capture(screenTexture, displayAreaStart.x * resolutionScale, (VRAM_HEIGHT - displayAreaStart.y - screenResolution.height) * resolutionScale, screenResolution.width * resolutionScale, screenResolution.height * resolutionScale);
+    }
+    if (mainWindow->isHeadless() || !presentedAreaChanged) {
+        return;
+    }
+    Dimensions windowSize = mainWindow->getDimensions();
+    glViewport(0, 0, windowSize.width, windowSize.height);
+    screenTexture->bind(GL_TEXTURE0);
+    glDisable(GL_SCISSOR_TEST);
+    glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+    glDisable(GL_BLEND);
+    vector<Pixel> pixels;
+    if (resizeToFitFramebuffer) {
+        pixels = {
+            Pixel(-1.0f, -1.0f, 0.0f, 1.0f),
+            Pixel(1.0f, -1.0f, 1.0f, 1.0f),
+            Pixel(-1.0f, 1.0f, 0.0f, 0.0f),
+            Pixel(1.0f, 1.0f, 1.0f, 0.0f),
+        };
+    } else {
+        pixels = {
+            Pixel(-1.0f, -1.0f, displayAreaStart.x, displayAreaStart.y + screenResolution.height),
+            Pixel(1.0f, -1.0f, displayAreaStart.x + screenResolution.width, displayAreaStart.y + screenResolution.height),
+            Pixel(-1.0f, 1.0f, displayAreaStart.x, displayAreaStart.y),
+            Pixel(1.0f, 1.0f, displayAreaStart.x + screenResolution.width, displayAreaStart.y),
+        };
+    }
+
+    screenBuffer->addData(pixels);
+    screenBuffer->draw(GL_TRIANGLE_STRIP);
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+    SDL_GL_SwapWindow(mainWindow->getWindowRef());
+}
+
+/*
+Everything drawn this frame is already in VRAM, so the compute rasterizer resolve and the blit to
+the window are left for the next presented frame.
+*/
+void OpenGLRenderer::skipFrame() {
+    frameStatistics.skippedFrames++;
+    endFrameStatistics();
+}
+
+void OpenGLRenderer::updateWindowTitle(string title) {
+    if (mainWindow->isHeadless()) {
+        return;
+    }
+    SDL_SetWindowTitle(mainWindow->getWindowRef(), title.c_str());
+}
+
+void OpenGLRenderer::setDrawingOffset(int16_t x, int16_t y) {
+    // The compute rasterizer applies the offset when primitives are batched
+    if (computeRasterizer) {
+        computeRasterizer->setDrawingOffset(x, y);
+        return;
+    }
+    // The offset uniform is set when the batch is drawn
+    renderFrame(RendererFlushReason::RendererFlushReasonDrawingOffset);
+    drawingOffset = Point2D(x, y);
+}
+
+void OpenGLRenderer::setSemiTransparencyMode(uint8_t mode) {
+    semiTransparencyMode = mode;
+    if (computeRasterizer) {
+        computeRasterizer->setSemiTransparencyMode(mode);
+    }
+}
+
+/*
+Dithering, the texture window and the mask bit are only honored by the compute rasterizer.
+*/
+void OpenGLRenderer::setDithering(bool enabled) {
+    if (computeRasterizer) {
+        computeRasterizer->setDithering(enabled);
+    }
+}
+
+void OpenGLRenderer::setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) {
+    if (computeRasterizer) {
+        computeRasterizer->setTextureWindow(maskX, maskY, offsetX, offsetY);
+    }
+}
+
+void OpenGLRenderer::setMaskBitSetting(bool setMaskBit, bool checkMaskBit) {
+    if (computeRasterizer) {
+        computeRasterizer->setMaskBitSetting(setMaskBit, checkMaskBit);
+    }
+}
+
+/*
+Writes the image to VRAM without counting it as an upload, copies within VRAM come through here too.
+*/
+void OpenGLRenderer::writeImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    uint16_t x, y, width, height;
+    tie(x, y) = imageBuffer->destination();
+    tie(width, height) = imageBuffer->resolution();
+    markVRAMWritten(Point2D(x, y), Dimensions(width, height));
+    if (computeRasterizer) {
+        renderFrame(RendererFlushReason::RendererFlushReasonVRAMWrite);
+        GLintptr unpackOffset = unpackBuffer->upload(imageBuffer->bufferRef(), ((GLsizeiptr)width) * height * sizeof(uint16_t));
+        computeRasterizer->writeVRAM(imageBuffer, unpackOffset);
+        unpackBuffer->release();
+        frameStatistics.bytesUploaded += ((uint64_t)width) * height * sizeof(uint16_t);
+        return;
+    }
+    GLintptr unpackOffset = unpackBuffer->upload(imageBuffer->bufferRef(), ((GLsizeiptr)width) * height * sizeof(uint16_t));
+    loadImageTexture->setImageFromBuffer(imageBuffer, unpackOffset);
+    unpackBuffer->release();
+    textureCache->writeVRAM(imageBuffer);
+    textureBuffer->clean();
+    vector<Point2D> data = { {(GLshort)x, (GLshort)y}, {(GLshort)(x + width), (GLshort)y}, {(GLshort)x, (GLshort)(y + height)}, {(GLshort)(x + width), (GLshort)(y + height)} };
+    textureBuffer->addData(data);
+    glDisable(GL_SCISSOR_TEST);
+    Framebuffer framebuffer = Framebuffer(screenTexture);
+    textureBuffer->draw(GL_TRIANGLE_STRIP);
+    frameStatistics.drawCalls++;
+    frameStatistics.verticesUploaded += data.size();
+    frameStatistics.bytesUploaded += data.size() * sizeof(Point2D) + ((uint64_t)width) * height * sizeof(uint16_t);
+    glEnable(GL_SCISSOR_TEST);
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+void OpenGLRenderer::loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    uint16_t width, height;
+    tie(width, height) = imageBuffer->resolution();
+    writeImage(imageBuffer);
+    frameStatistics.vramUploads++;
+    frameStatistics.vramUploadBytes += ((uint64_t)width) * height * sizeof(uint16_t);
+}
+
+/*
+Fills clear the rectangle in place, pending primitives only have to be drawn first when they touch
+it. Without the compute rasterizer they are textured from a separate copy of VRAM, so only the
+area they draw to matters.
+*/
+void OpenGLRenderer::fillRectangle(Point2D topLeft, Dimensions size, uint16_t color) {
+    frameStatistics.vramFills++;
+    markVRAMWritten(topLeft, size);
+    if (computeRasterizer) {
+        if (computeRasterizer->overlapsBatch(topLeft, size)) {
+            renderFrame(RendererFlushReason::RendererFlushReasonVRAMFill);
+        }
+        computeRasterizer->fillVRAM(topLeft, size, color);
+        return;
+    }
+    GLint left = topLeft.x;
+    GLint top = topLeft.y;
+    GLint right = left + size.width - 1;
+    GLint bottom = top + size.height - 1;
+    if (left <= batchRight && right >= batchLeft && top <= batchBottom && bottom >= batchTop) {
+        renderFrame(RendererFlushReason::RendererFlushReasonVRAMFill);
+    }
+    // The screen texture holds the whole VRAM upside down and scaled by the internal resolution,
+    // its RGB5_A1 texels take the 15bit color as is
+    GLint scale = resolutionScale;
+    glClearTexSubImage(screenTexture->getID(), 0, left * scale, ((GLint)VRAM_HEIGHT - bottom - 1) * scale, 0, size.width * scale, size.height * scale, 1, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, &color);
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+/*
+Reads a rectangle of VRAM back at native resolution. The screen texture holds the rendered VRAM
+scaled by the internal resolution, so it is downsampled first. The compute rasterizer already
+keeps VRAM at native resolution and is read directly.
+*/
+std::vector<uint16_t> OpenGLRenderer::readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    renderFrame(RendererFlushReason::RendererFlushReasonVRAMRead);
+    if (computeRasterizer) {
+        vector<uint16_t> vram = computeRasterizer->readVRAM();
+        return readVRAMRectangle(vram.data(), x, y, width, height);
+    }
+    glDisable(GL_SCISSOR_TEST);
+    {
+        Framebuffer readFramebuffer = Framebuffer(screenTexture, GL_READ_FRAMEBUFFER);
+        Framebuffer drawFramebuffer = Framebuffer(downsampleTexture, GL_DRAW_FRAMEBUFFER);
+        glBlitFramebuffer(0, 0, screenTexture->getWidth(), screenTexture->getHeight(), 0, 0, VRAM_WIDTH, VRAM_HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glEnable(GL_SCISSOR_TEST);
+
+    vector<uint16_t> vram = vector<uint16_t>(VRAM_WIDTH * VRAM_HEIGHT);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    downsampleTexture->bind(GL_TEXTURE0);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, vram.data());
+
+    vector<uint16_t> data = vector<uint16_t>(width * height);
+    for (uint32_t row = 0; row < height; row++) {
+        // Rows are stored bottom to top
+        uint32_t rowOffset = (VRAM_HEIGHT - 1 - ((y + row) & (VRAM_HEIGHT - 1))) * VRAM_WIDTH;
+        for (uint32_t column = 0; column < width; column++) {
+            data[row * width + column] = vram[rowOffset + ((x + column) & (VRAM_WIDTH - 1))];
+        }
+    }
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+    return data;
+}
@@ -0,0 +1,92 @@
+#include "PixelUnpackBuffer.hpp"
+#include <cstring>
+#include "RendererDebugger.hpp"
+
+using namespace std;
+
+PixelUnpackBuffer::PixelUnpackBuffer() : logger(LogLevel::NoLog), object(0), mapping(nullptr), head(0), pendingStart(0), regions() {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &object);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, object);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, PIXEL_UNPACK_BUFFER_SIZE, nullptr, flags);
+    mapping = (uint8_t *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, PIXEL_UNPACK_BUFFER_SIZE, flags);
+    if (mapping == nullptr) {
+        logger.logError("Unable to map pixel unpack buffer");
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+PixelUnpackBuffer::~PixelUnpackBuffer() {
+    for (PixelUnpackRegion &region : regions) {
+        glDeleteSync(region.fence);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, object);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &object);
+}
+
+/*
+Fences signal in the order they were inserted, so waiting on the newest region overlapping the
+range covers every region before it. That region can be anywhere in the queue: once the head
+wraps around, the oldest regions are the ones left in the skipped tail of the ring. Regions past
+it are only dropped when their fences already signaled.
+*/
+void PixelUnpackBuffer::waitForRegions(GLintptr start, GLintptr end) {
+    size_t blocking = 0;
+    for (size_t i = 0; i < regions.size(); i++) {
+        if (regions[i].start < end && start < regions[i].end) {
+            blocking = i + 1;
+        }
+    }
+    if (blocking > 0 && glClientWaitSync(regions[blocking - 1].fence, 0, GL_TIMEOUT_IGNORED) == GL_WAIT_FAILED) {
+        logger.logError("Unable to wait for pixel unpack buffer fence");
+    }
+    for (size_t i = 0; i < blocking; i++) {
+        glDeleteSync(regions.front().fence);
+        regions.pop_front();
+    }
+    while (!regions.empty()) {
+        GLenum status = glClientWaitSync(regions.front().fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        if (status == GL_WAIT_FAILED) {
+            logger.logError("Unable to wait for pixel unpack buffer fence");
+        }
+        glDeleteSync(regions.front().fence);
+        regions.pop_front();
+    }
+}
+
+/*
+Copies the data into the ring and leaves the buffer bound to GL_PIXEL_UNPACK_BUFFER, so texture
+uploads issued until release is called read from the returned offset instead of a pointer.
+*/
+GLintptr PixelUnpackBuffer::upload(const void *data, GLsizeiptr size) {
+    if (size > PIXEL_UNPACK_BUFFER_SIZE) {
+        logger.logError("Upload of %ld bytes does not fit in the pixel unpack buffer", (long)size);
+    }
+    if (head + size > PIXEL_UNPACK_BUFFER_SIZE) {
+        head = 0;
+    }
+    waitForRegions(head, head + size);
+    memcpy(mapping + head, data, size);
+    GLintptr offset = head;
+    pendingStart = head;
+    head += size;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, object);
+    return offset;
+}
+
+/*
+Fences the region written by the last upload after the commands reading it, and unbinds the
+buffer so later uploads from client memory aren't taken as offsets into it.
+*/
+void PixelUnpackBuffer::release() {
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    regions.push_back({ pendingStart, head, fence });
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
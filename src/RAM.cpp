@@ -5,16 +5,30 @@
 
 using namespace std;
 
-RAM::RAM() : data() {
+RAM::RAM() : data(), pageGenerations() {
 }
 
 RAM::~RAM() {
 
 }
 
+/*
+Backing memory, for transfers that copy whole blocks instead of going word by word.
+*/
+const uint8_t* RAM::dataRef() const {
+    return data;
+}
+
+uint32_t RAM::pageGeneration(uint32_t page) const {
+    return pageGenerations[page];
+}
+
 void RAM::receiveTransfer(filesystem::path filePath, uint32_t origin, uint32_t size, uint32_t destination) {
     uint8_t *dataDestination = &data[destination];
     readBinary(filePath, dataDestination, origin, size);
+    for (uint32_t page = destination / RAM_PAGE_SIZE; page <= (destination + size - 1) / RAM_PAGE_SIZE && page < RAM_SIZE / RAM_PAGE_SIZE; page++) {
+        pageGenerations[page]++;
+    }
 }
 
 void RAM::dump() {
@@ -1,279 +1,184 @@
 #include "Renderer.hpp"
-#include <glad/glad.h>
-#include <fstream>
-#include <streambuf>
-#include <vector>
-#include "RendererDebugger.hpp"
-#include "Framebuffer.hpp"
-#include "GPU.hpp"
-#include "ConfigurationManager.hpp"
+#include "OpenGLRenderer.hpp"
+#include "SoftwareRenderer.hpp"
+#include "NullRenderer.hpp"
+#include <algorithm>
 
 using namespace std;
 
-Renderer::Renderer(std::unique_ptr<Window> &mainWindow, GPU *gpu) : logger(LogLevel::NoLog), opaqueVertices(), transparentVertices(), mainWindow(mainWindow), mode(GL_TRIANGLES), displayAreaStart(), screenResolution({}), drawingAreaTopLeft(), drawingAreaSize({}), renderPolygonOneByOne(false), orderingIndex(0) {
-    ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
-    resizeToFitFramebuffer = configurationManager->shouldResizeWindowToFitFramebuffer();
+Renderer::Renderer() : frameStatistics(), totalStatistics(), statisticsHistory(), presentedAreaStart(), presentedAreaSize({}), presentedAreaDirty(true), copyBuffer() {}
 
-    textureRendererProgram = make_unique<RendererProgram>("./glsl/texture_load_vertex.glsl", "./glsl/texture_load_fragment.glsl");
+Renderer::~Renderer() {}
 
-    textureBuffer = make_unique<RendererBuffer<Point2D>>(textureRendererProgram, RENDERER_BUFFER_SIZE);
-
-    program = make_unique<RendererProgram>("glsl/vertex.glsl", "glsl/fragment.glsl");
-    program->useProgram();
-
-    buffer = make_unique<RendererBuffer<Vertex>>(program, RENDERER_BUFFER_SIZE);
-
-    offsetUniform = program->findProgramUniform("offset");
-    glUniform2i(offsetUniform, 0, 0);
-
-    drawTransparentTextureBlendUniform = program->findProgramUniform("draw_transparent_texture_blend");
-    glUniform1ui(drawTransparentTextureBlendUniform, 0);
-
-    Dimensions screenDimensions = mainWindow->getDimensions();
-
-    string screenVertexFile = "./glsl/screen_vertex.glsl";
-    screenRendererProgram = make_unique<RendererProgram>(screenVertexFile, "./glsl/screen_fragment.glsl");
-    screenRendererProgram->useProgram();
-    GLuint screenWidthUniform = screenRendererProgram->findProgramUniform("screen_width");
-    glUniform1f(screenWidthUniform, screenDimensions.width);
-    GLuint screenHeightUniform = screenRendererProgram->findProgramUniform("screen_height");
-    glUniform1f(screenHeightUniform, screenDimensions.height);
-    GLuint vramWidthUniform = screenRendererProgram->findProgramUniform("vram_width");
-    glUniform1f(vramWidthUniform, VRAM_WIDTH);
-    GLuint vramHeightUniform = screenRendererProgram->findProgramUniform("vram_height");
-    glUniform1f(vramHeightUniform, VRAM_HEIGHT);
-    GLuint fullFramebufferUniform = screenRendererProgram->findProgramUniform("full_framebuffer");
-    glUniform1f(fullFramebufferUniform, resizeToFitFramebuffer);
-
-    screenBuffer = make_unique<RendererBuffer<Pixel>>(screenRendererProgram, RENDERER_BUFFER_SIZE);
-
-    // TODO: handle resolution for other targets
-    loadImageTexture = make_unique<Texture>(((GLsizei) VRAM_WIDTH), ((GLsizei) VRAM_HEIGHT));
-
-    screenTexture = make_unique<Texture>(((GLsizei) screenDimensions.width), ((GLsizei) screenDimensions.height));
-    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
-
-    rendererDebugger->checkForOpenGLErrors();
-
-    displayAreaStart = gpu->getDisplayAreaStart();
-    screenResolution = gpu->getResolution();
-}
-
-Renderer::~Renderer() {
-    SDL_Quit();
-}
-
-void Renderer::checkRenderPolygonOneByOne() {
-    if (!renderPolygonOneByOne) {
-        return;
+/*
+The OpenGL renderer covers both the fixed function pipeline and the compute rasterizer, it checks
+which one was selected itself.
+*/
+unique_ptr<Renderer> Renderer::forBackend(RendererBackend backend, unique_ptr<Window> &mainWindow, GPU *gpu) {
+    switch (backend) {
+        case RendererBackendSoftware: {
+            return make_unique<SoftwareRenderer>(mainWindow, gpu);
+        }
+        case RendererBackendNull: {
+            return make_unique<NullRenderer>(mainWindow, gpu);
+        }
+        default: {
+            return make_unique<OpenGLRenderer>(mainWindow, gpu);
+        }
     }
-    prepareFrame();
-    renderFrame();
-    finalizeFrame();
 }
 
-void Renderer::checkForceDraw(unsigned int verticesToRender, GLenum newMode) {
-    unsigned int verticesToRenderTotal = verticesToRender;
-    if (verticesToRender == 4) {
-        verticesToRenderTotal = 6;
+/*
+GP0(80h) copies apply the mask bit settings of GP0(E6h) like drawing does: destination pixels with
+their mask bit set are kept when checking it, and copied pixels get it set when forcing it.
+*/
+static uint16_t maskCopiedPixel(uint16_t source, uint16_t destination, bool setMaskBit, bool checkMaskBit) {
+    if (checkMaskBit && (destination & 0x8000)) {
+        return destination;
     }
-    if (buffer->remainingCapacity() < verticesToRenderTotal) {
-        renderFrame();
+    return setMaskBit ? (source | 0x8000) : source;
+}
+
+/*
+Reads the source back and writes it at the destination, both wrapping around VRAM. The whole
+source is read before anything is written, so overlapping rectangles copy like a memmove, and the
+destination is only read back when its mask bits are checked. Writes don't wrap on every backend,
+so the destination is split at the edges of VRAM. These are copies, not uploads from the CPU, so
+they skip loadImage and its statistics.
+*/
+void Renderer::copyRectangle(Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit) {
+    vector<uint16_t> data = readVRAM(source.x, source.y, size.width, size.height);
+    if (setMaskBit || checkMaskBit) {
+        vector<uint16_t> previous = checkMaskBit ? readVRAM(destination.x, destination.y, size.width, size.height) : vector<uint16_t>(data.size());
+        for (uint32_t i = 0; i < data.size(); i++) {
+            data[i] = maskCopiedPixel(data[i], previous[i], setMaskBit, checkMaskBit);
+        }
     }
-    if (mode != newMode) {
-        renderFrame();
+    if (!copyBuffer) {
+        copyBuffer = make_unique<GPUImageBuffer>();
     }
-    return;
+    uint32_t columnSplit = min((uint32_t)size.width, VRAM_WIDTH - destination.x);
+    uint32_t rowSplit = min((uint32_t)size.height, VRAM_HEIGHT - destination.y);
+    for (uint32_t top : { 0u, rowSplit }) {
+        uint32_t rows = top == 0 ? rowSplit : size.height - rowSplit;
+        for (uint32_t left : { 0u, columnSplit }) {
+            uint32_t columns = left == 0 ? columnSplit : size.width - columnSplit;
+            if (rows == 0 || columns == 0) {
+                continue;
+            }
+            copyBuffer->reset((destination.x + left) & (VRAM_WIDTH - 1), (destination.y + top) & (VRAM_HEIGHT - 1), columns, rows);
+            for (uint32_t row = 0; row < rows; row++) {
+                copyBuffer->pushHalfwords(&data[(top + row) * size.width + left], columns);
+            }
+            writeImage(copyBuffer);
+        }
+    }
+    frameStatistics.vramCopies++;
 }
 
-void Renderer::applyScissor() {
-    // TODO: there must be a better way of doing this
-    // Scissor test is specified in window coordinates, but we get PlayStation screen buffer
-    // from the GPU commands, so we need to translate between coordinate systems. The problem here
-    // is that we need to handle different modes: full framebuffer and display area cropped.
-    Dimensions windowSize = mainWindow->getDimensions();
-
-    // Conveniently the width is the same for both modes, so nothing to do here
-    GLsizei width = drawingAreaSize.width;
-    GLint x = drawingAreaTopLeft.x;
-
-    GLsizei height = ((float)drawingAreaSize.height / VRAM_HEIGHT * windowSize.height);
-    GLint y = windowSize.height - height - ((float)drawingAreaTopLeft.y / VRAM_HEIGHT * windowSize.height);
-
-    if (resizeToFitFramebuffer) {
-        height = drawingAreaSize.height;
-        y = VRAM_HEIGHT - height - drawingAreaTopLeft.y;
+void Renderer::endFrameStatistics() {
+    totalStatistics.add(frameStatistics);
+    statisticsHistory.push_back(frameStatistics);
+    if (statisticsHistory.size() > RENDERER_STATISTICS_HISTORY_SIZE) {
+        statisticsHistory.pop_front();
     }
-    glScissor(x, y, width, height);
-    glEnable(GL_SCISSOR_TEST);
+    frameStatistics = RendererStatistics();
 }
 
-void Renderer::insertVertices(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) {
-    bool shouldDrawOpaque = opaque || textureBlendMode != TextureBlendMode::TextureBlendModeNoTexture;
-    if (shouldDrawOpaque) {
-        opaqueVertices.insert(opaqueVertices.end(), vertices.begin(), vertices.end());
-    }
-    if (!opaque) {
-        transparentVertices.insert(transparentVertices.end(), vertices.begin(), vertices.end());
-    }
+/*
+VRAM coordinates wrap around, so two ranges overlap when either one starts inside the other.
+*/
+static bool vramRangesOverlap(int32_t start, int32_t length, int32_t otherStart, int32_t otherLength, int32_t vramSize) {
+    int32_t mask = vramSize - 1;
+    return ((otherStart - start) & mask) < length || ((start - otherStart) & mask) < otherLength;
 }
 
-void Renderer::pushLine(std::vector<Vertex> vertices, bool opaque) {
-    unsigned int size = vertices.size();
-    if (size < 2) {
-        logger.logError("Unhandled line with %d vertices", size);
+/*
+Windows stretched to fit the framebuffer show the whole VRAM instead of the display area.
+*/
+void Renderer::setPresentedArea(Point2D displayAreaStart, Dimensions screenResolution, bool wholeVRAM) {
+    Point2D start = wholeVRAM ? Point2D(0, 0) : displayAreaStart;
+    Dimensions size = wholeVRAM ? Dimensions(VRAM_WIDTH, VRAM_HEIGHT) : screenResolution;
+    if (start.x == presentedAreaStart.x && start.y == presentedAreaStart.y && size._value == presentedAreaSize._value) {
         return;
     }
-    checkForceDraw(size, GL_LINES);
-    mode = GL_LINES;
-    orderingIndex++;
-    for (auto& vertix : vertices) {
-        vertix.point.z = orderingIndex;
-    }
-    insertVertices(vertices, opaque, TextureBlendMode::TextureBlendModeNoTexture);
-    checkRenderPolygonOneByOne();
-    return;
+    presentedAreaStart = start;
+    presentedAreaSize = size;
+    presentedAreaDirty = true;
 }
 
-void Renderer::pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) {
-    unsigned int size = vertices.size();
-    if (size < 3 || size > 4) {
-        logger.logError("Unhandled polygon with %d vertices", size);
+void Renderer::markVRAMWritten(Point2D topLeft, Dimensions size) {
+    if (presentedAreaDirty) {
         return;
     }
-    checkForceDraw(size, GL_TRIANGLES);
-    mode = GL_TRIANGLES;
-    orderingIndex++;
-    for (auto& vertix : vertices) {
-        vertix.point.z = orderingIndex;
-    }
-    switch (size) {
-        case 3: {
-            insertVertices(vertices, opaque, textureBlendMode);
-            checkRenderPolygonOneByOne();
-            break;
+    presentedAreaDirty = vramRangesOverlap(topLeft.x, size.width, presentedAreaStart.x, presentedAreaSize.width, VRAM_WIDTH) && vramRangesOverlap(topLeft.y, size.height, presentedAreaStart.y, presentedAreaSize.height, VRAM_HEIGHT);
+}
+
+/*
+Copies a rectangle out of a native resolution copy of VRAM, wrapping around its edges like the GPU.
+*/
+std::vector<uint16_t> Renderer::readVRAMRectangle(const uint16_t *vram, uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    vector<uint16_t> data = vector<uint16_t>(width * height);
+    for (uint32_t row = 0; row < height; row++) {
+        uint32_t rowOffset = ((y + row) & (VRAM_HEIGHT - 1)) * VRAM_WIDTH;
+        for (uint32_t column = 0; column < width; column++) {
+            data[row * width + column] = vram[rowOffset + ((x + column) & (VRAM_WIDTH - 1))];
         }
-        case 4: {
-            insertVertices(vector<Vertex>(vertices.begin(), vertices.end() - 1), opaque, textureBlendMode);
-            checkRenderPolygonOneByOne();
-            insertVertices(vector<Vertex>(vertices.begin() + 1, vertices.end()), opaque, textureBlendMode);
-            checkRenderPolygonOneByOne();
-            break;
+    }
+    return data;
+}
+
+/*
+Copies a rectangle within a native resolution copy of VRAM, both wrapping around its edges like the
+GPU and applying the mask bit settings. The source is read whole first so overlapping rectangles
+copy like a memmove.
+*/
+void Renderer::copyVRAMRectangle(uint16_t *vram, Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit) {
+    vector<uint16_t> data = readVRAMRectangle(vram, source.x, source.y, size.width, size.height);
+    for (uint32_t row = 0; row < size.height; row++) {
+        uint32_t rowOffset = ((destination.y + row) & (VRAM_HEIGHT - 1)) * VRAM_WIDTH;
+        for (uint32_t column = 0; column < size.width; column++) {
+            uint16_t &pixel = vram[rowOffset + ((destination.x + column) & (VRAM_WIDTH - 1))];
+            pixel = maskCopiedPixel(data[row * size.width + column], pixel, setMaskBit, checkMaskBit);
         }
     }
-    return;
 }
 
-void Renderer::resetMainWindow() {
-    mainWindow->makeCurrent();
+/*
+Whether the presented area changed since the last time this was called.
+*/
+bool Renderer::takePresentedAreaDirty() {
+    bool dirty = presentedAreaDirty;
+    presentedAreaDirty = false;
+    return dirty;
 }
 
-void Renderer::setDisplayAreaSart(Point2D point) {
-    displayAreaStart = point;
+/*
+Display list packets are handled before the renderer sees them, the DMA reports them through the GPU.
+*/
+void Renderer::countDisplayListPacket(RendererDisplayListPacket packet) {
+    frameStatistics.displayListPackets[packet]++;
 }
 
-void Renderer::setScreenResolution(Dimensions dimensions) {
-    screenResolution = dimensions;
-}
-
-void Renderer::setDrawingArea(Point2D topLeft, Dimensions size) {
-    renderFrame();
-
-    drawingAreaTopLeft = topLeft;
-    drawingAreaSize = size;
-
-    applyScissor();
-}
-
-void Renderer::toggleRenderPolygonOneByOne() {
-    renderPolygonOneByOne = !renderPolygonOneByOne;
-}
-
-void Renderer::prepareFrame() {
-    resetMainWindow();
-    applyScissor();
-    glEnable(GL_SCISSOR_TEST);
-    glBlendColor(0.25, 0.25, 0.25, 0.5);
-}
-
-void Renderer::renderFrame() {
-    program->useProgram();
-    loadImageTexture->bind(GL_TEXTURE0);
-
-    Framebuffer framebuffer = Framebuffer(screenTexture);
-
-    glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
-    glDisable(GL_BLEND);
-    glUniform1ui(drawTransparentTextureBlendUniform, 0);
-
-    buffer->addData(opaqueVertices);
-    opaqueVertices.clear();
-    buffer->draw(mode);
-
-    glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
-    glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-    glEnable(GL_BLEND);
-    glUniform1ui(drawTransparentTextureBlendUniform, 1);
-
-    buffer->addData(transparentVertices);
-    transparentVertices.clear();
-    buffer->draw(mode);
-    orderingIndex = 0;
-
-    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
-    rendererDebugger->checkForOpenGLErrors();
-}
-
-void Renderer::finalizeFrame() {
-    screenTexture->bind(GL_TEXTURE0);
-    glDisable(GL_SCISSOR_TEST);
-    glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
-    glDisable(GL_BLEND);
-    vector<Pixel> pixels;
-    if (resizeToFitFramebuffer) {
-        pixels = {
-            Pixel(-1.0f, -1.0f, 0.0f, 1.0f),
-            Pixel(1.0f, -1.0f, 1.0f, 1.0f),
-            Pixel(-1.0f, 1.0f, 0.0f, 0.0f),
-            Pixel(1.0f, 1.0f, 1.0f, 0.0f),
-        };
-    } else {
-        pixels = {
-            Pixel(-1.0f, -1.0f, displayAreaStart.x, displayAreaStart.y + screenResolution.height),
-            Pixel(1.0f, -1.0f, displayAreaStart.x + screenResolution.width, displayAreaStart.y + screenResolution.height),
-            Pixel(-1.0f, 1.0f, displayAreaStart.x, displayAreaStart.y),
-            Pixel(1.0f, 1.0f, displayAreaStart.x + screenResolution.width, displayAreaStart.y),
-        };
+/*
+Statistics of the last finished frame.
+*/
+RendererStatistics Renderer::getFrameStatistics() {
+    if (statisticsHistory.empty()) {
+        return RendererStatistics();
     }
-
-    screenBuffer->addData(pixels);
-    screenBuffer->draw(GL_TRIANGLE_STRIP);
-    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
-    rendererDebugger->checkForOpenGLErrors();
-    SDL_GL_SwapWindow(mainWindow->getWindowRef());
-}
-
-void Renderer::updateWindowTitle(string title) {
-    SDL_SetWindowTitle(mainWindow->getWindowRef(), title.c_str());
+    return statisticsHistory.back();
 }
 
-void Renderer::setDrawingOffset(int16_t x, int16_t y) {
-    renderFrame();
-    glUniform2i(offsetUniform, ((GLint)x), ((GLint)y));
+/*
+Statistics accumulated since the renderer was created, including the frame in progress.
+*/
+RendererStatistics Renderer::getTotalStatistics() {
+    RendererStatistics statistics = totalStatistics;
+    statistics.add(frameStatistics);
+    return statistics;
 }
 
-void Renderer::loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
-    loadImageTexture->setImageFromBuffer(imageBuffer);
-    textureBuffer->clean();
-    uint16_t x, y, width, height;
-    tie(x, y) = imageBuffer->destination();
-    tie(width, height) = imageBuffer->resolution();
-    vector<Point2D> data = { {(GLshort)x, (GLshort)y}, {(GLshort)(x + width), (GLshort)y}, {(GLshort)x, (GLshort)(y + height)}, {(GLshort)(x + width), (GLshort)(y + height)} };
-    textureBuffer->addData(data);
-    glDisable(GL_SCISSOR_TEST);
-    Framebuffer framebuffer = Framebuffer(screenTexture);
-    textureBuffer->draw(GL_TRIANGLE_STRIP);
-    glEnable(GL_SCISSOR_TEST);
-    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
-    rendererDebugger->checkForOpenGLErrors();
+std::deque<RendererStatistics> Renderer::getStatisticsHistory() {
+    return statisticsHistory;
 }
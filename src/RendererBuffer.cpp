@@ -1,24 +1,34 @@
 #include "RendererBuffer.hpp"
 #include <stddef.h>
+#include <algorithm>
 #include "Vertex.hpp"
 #include "RendererDebugger.hpp"
 
 using namespace std;
 
 template <class T>
-RendererBuffer<T>::RendererBuffer(unique_ptr<RendererProgram> &program, unsigned int capacity) : vao(make_unique<VertexArrayObject>()), program(program), capacity(capacity), size(0) {
+RendererBuffer<T>::RendererBuffer(unique_ptr<RendererProgram> &program, unsigned int capacity) : vao(make_unique<VertexArrayObject>()), program(program), capacity(capacity), size(0), mapping(nullptr), region(0), fences() {
     glGenBuffers(1, &vbo);
 
     vao->bind();
     bind();
 
-    GLsizeiptr bufferSize = sizeof(T) * capacity;
-    glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_DYNAMIC_DRAW);
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr bufferSize = sizeof(T) * capacity * RENDERER_BUFFER_REGIONS;
+    glBufferStorage(GL_ARRAY_BUFFER, bufferSize, nullptr, flags);
+    mapping = (T *)glMapBufferRange(GL_ARRAY_BUFFER, 0, bufferSize, flags);
     enableAttributes();
 }
 
 template <class T>
 RendererBuffer<T>::~RendererBuffer() {
+    for (GLsync fence : fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+        }
+    }
+    bind();
+    glUnmapBuffer(GL_ARRAY_BUFFER);
     glDeleteBuffers(1, &vbo);
 }
 
@@ -27,11 +37,11 @@ void RendererBuffer<T>::bind() const {
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
 }
 
+/*
+Drops what was added since the last draw, the region is only handed to the GPU when drawn.
+*/
 template <class T>
 void RendererBuffer<T>::clean() {
-    bind();
-    GLsizeiptr bufferSize = sizeof(T) * capacity;
-    glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_DYNAMIC_DRAW);
     size = 0;
 }
 
@@ -39,15 +49,49 @@ template <class T>
 void RendererBuffer<T>::draw(GLenum mode) {
     vao->bind();
     program->useProgram();
-    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
-    glDrawArrays(mode, 0, (GLsizei)size);
-    GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glDrawArrays(mode, (GLint)(region * capacity), (GLsizei)size);
+    finishDraw();
+}
+
+/*
+Every element in the buffer is one instance, its attributes advance once per instance and the
+vertex shader builds the vertices from gl_VertexID.
+*/
+template <class T>
+void RendererBuffer<T>::drawInstances(GLenum mode, GLsizei verticesPerInstance) {
+    vao->bind();
+    program->useProgram();
+    glDrawArraysInstancedBaseInstance(mode, 0, verticesPerInstance, (GLsizei)size, region * capacity);
+    finishDraw();
+}
+
+/*
+Waits until the GPU is done with the current region before it's written again. Regions are only
+reused after the other ones, so this is usually already signaled.
+*/
+template <class T>
+void RendererBuffer<T>::waitForRegion() {
+    GLsync fence = fences[region];
+    if (fence == nullptr) {
+        return;
+    }
     while (true) {
-        GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 10000000);
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 10000000);
         if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
             break;
         }
+        if (result == GL_WAIT_FAILED) {
+            break;
+        }
     }
+    glDeleteSync(fence);
+    fences[region] = nullptr;
+}
+
+template <class T>
+void RendererBuffer<T>::finishDraw() {
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % RENDERER_BUFFER_REGIONS;
     clean();
     RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
     rendererDebugger->checkForOpenGLErrors();
@@ -55,12 +99,10 @@ void RendererBuffer<T>::draw(GLenum mode) {
 
 template <class T>
 void RendererBuffer<T>::addData(vector<T> data) {
-    bind();
-
-    unsigned int offset = size * sizeof(T);
-    unsigned int dataSize = data.size() * sizeof(T);
-    glBufferSubData(GL_ARRAY_BUFFER, offset, dataSize, data.data());
-
+    if (size == 0) {
+        waitForRegion();
+    }
+    copy(data.begin(), data.end(), mapping + region * capacity + size);
     size += data.size();
 }
 
@@ -103,6 +145,14 @@ void RendererBuffer<Vertex>::enableAttributes() const {
     GLuint clutIdx = program->findProgramAttribute("clut");
     glVertexAttribIPointer(clutIdx, 2, GL_SHORT, sizeof(Vertex), (void*)offsetof(struct Vertex, clut));
     glEnableVertexAttribArray(clutIdx);
+
+    GLuint textureCacheLayerIdx = program->findProgramAttribute("texture_cache_layer");
+    glVertexAttribIPointer(textureCacheLayerIdx, 1, GL_INT, sizeof(Vertex), (void*)offsetof(struct Vertex, textureCacheLayer));
+    glEnableVertexAttribArray(textureCacheLayerIdx);
+
+    GLuint semiTransparencyIdx = program->findProgramAttribute("semi_transparency");
+    glVertexAttribIPointer(semiTransparencyIdx, 1, GL_UNSIGNED_INT, sizeof(Vertex), (void*)offsetof(struct Vertex, semiTransparency));
+    glEnableVertexAttribArray(semiTransparencyIdx);
 }
 
 template <>
@@ -122,6 +172,65 @@ void RendererBuffer<Pixel>::enableAttributes() const {
     glEnableVertexAttribArray(texturePositionIdx);
 }
 
+template <>
+void RendererBuffer<RectangleInstance>::enableAttributes() const {
+    GLuint positionIdx = program->findProgramAttribute("rectangle_point");
+    glVertexAttribIPointer(positionIdx, 2, GL_SHORT, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, point));
+    glEnableVertexAttribArray(positionIdx);
+    glVertexAttribDivisor(positionIdx, 1);
+
+    GLuint sizeIdx = program->findProgramAttribute("rectangle_size");
+    glVertexAttribIPointer(sizeIdx, 2, GL_SHORT, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, size));
+    glEnableVertexAttribArray(sizeIdx);
+    glVertexAttribDivisor(sizeIdx, 1);
+
+    GLuint colorIdx = program->findProgramAttribute("rectangle_color");
+    glVertexAttribIPointer(colorIdx, 3, GL_UNSIGNED_BYTE, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, color));
+    glEnableVertexAttribArray(colorIdx);
+    glVertexAttribDivisor(colorIdx, 1);
+
+    GLuint transparentPositionIdx = program->findProgramAttribute("transparent");
+    glVertexAttribIPointer(transparentPositionIdx, 1, GL_UNSIGNED_BYTE, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, transparent));
+    glEnableVertexAttribArray(transparentPositionIdx);
+    glVertexAttribDivisor(transparentPositionIdx, 1);
+
+    GLuint texturePositionIdx = program->findProgramAttribute("texture_point");
+    glVertexAttribIPointer(texturePositionIdx, 2, GL_SHORT, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, texturePosition));
+    glEnableVertexAttribArray(texturePositionIdx);
+    glVertexAttribDivisor(texturePositionIdx, 1);
+
+    GLuint textureBlendModePositionIdx = program->findProgramAttribute("texture_blend_mode");
+    glVertexAttribIPointer(textureBlendModePositionIdx, 1, GL_UNSIGNED_BYTE, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, textureBlendMode));
+    glEnableVertexAttribArray(textureBlendModePositionIdx);
+    glVertexAttribDivisor(textureBlendModePositionIdx, 1);
+
+    GLuint texturePageIdx = program->findProgramAttribute("texture_page");
+    glVertexAttribIPointer(texturePageIdx, 2, GL_SHORT, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, texturePage));
+    glEnableVertexAttribArray(texturePageIdx);
+    glVertexAttribDivisor(texturePageIdx, 1);
+
+    GLuint textureDepthShiftIdx = program->findProgramAttribute("texture_depth_shift");
+    glVertexAttribIPointer(textureDepthShiftIdx, 1, GL_UNSIGNED_BYTE, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, textureDepthShift));
+    glEnableVertexAttribArray(textureDepthShiftIdx);
+    glVertexAttribDivisor(textureDepthShiftIdx, 1);
+
+    GLuint clutIdx = program->findProgramAttribute("clut");
+    glVertexAttribIPointer(clutIdx, 2, GL_SHORT, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, clut));
+    glEnableVertexAttribArray(clutIdx);
+    glVertexAttribDivisor(clutIdx, 1);
+
+    GLuint textureCacheLayerIdx = program->findProgramAttribute("texture_cache_layer");
+    glVertexAttribIPointer(textureCacheLayerIdx, 1, GL_INT, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, textureCacheLayer));
+    glEnableVertexAttribArray(textureCacheLayerIdx);
+    glVertexAttribDivisor(textureCacheLayerIdx, 1);
+
+    GLuint semiTransparencyIdx = program->findProgramAttribute("semi_transparency");
+    glVertexAttribIPointer(semiTransparencyIdx, 1, GL_UNSIGNED_BYTE, sizeof(RectangleInstance), (void*)offsetof(struct RectangleInstance, semiTransparency));
+    glEnableVertexAttribArray(semiTransparencyIdx);
+    glVertexAttribDivisor(semiTransparencyIdx, 1);
+}
+
 template class RendererBuffer<Vertex>;
+template class RendererBuffer<RectangleInstance>;
 template class RendererBuffer<Point2D>;
 template class RendererBuffer<Pixel>;
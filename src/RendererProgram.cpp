@@ -1,15 +1,39 @@
 #include "RendererProgram.hpp"
 #include <fstream>
+#include <algorithm>
+#include <random>
+#include <system_error>
 #include "RendererDebugger.hpp"
+#include "ConfigurationManager.hpp"
 
 using namespace std;
 
-RendererProgram::RendererProgram(string vertexShaderSrcPath, string fragmentShaderSrcPath) {
-    GLuint vertexShader = compileShader(vertexShaderSrcPath, GL_VERTEX_SHADER);
-    GLuint fragmentShader = compileShader(fragmentShaderSrcPath, GL_FRAGMENT_SHADER);
-    program = linkProgram({vertexShader, fragmentShader});
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+const uint32_t PROGRAM_CACHE_MAGIC = 0x43505242; // "BRPC"
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+/*
+Header written in front of every cached program binary. The key is stored as well as being part of
+the file name so a truncated hash or a renamed file can't load the wrong program.
+*/
+struct ProgramCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+RendererProgram::RendererProgram(string vertexShaderSrcPath, string fragmentShaderSrcPath) : logger(ConfigurationManager::getInstance()->openGLLogLevel(), "  OPENGL: "), program() {
+    buildProgram({
+        { GL_VERTEX_SHADER, openShaderSource(vertexShaderSrcPath) },
+        { GL_FRAGMENT_SHADER, openShaderSource(fragmentShaderSrcPath) },
+    });
+}
+
+RendererProgram::RendererProgram(string computeShaderSrcPath) : logger(ConfigurationManager::getInstance()->openGLLogLevel(), "  OPENGL: "), program() {
+    buildProgram({
+        { GL_COMPUTE_SHADER, openShaderSource(computeShaderSrcPath) },
+    });
 }
 
 RendererProgram::~RendererProgram() {
@@ -32,8 +56,7 @@ string RendererProgram::openShaderSource(string filePath) const {
     return source;
 }
 
-GLuint RendererProgram::compileShader(string filePath, GLenum shaderType) const {
-    string source = openShaderSource(filePath);
+GLuint RendererProgram::compileShader(const string &source, GLenum shaderType) const {
     GLuint shader = glCreateShader(shaderType);
     const GLchar *src = source.c_str();
     glShaderSource(shader, 1, &src, NULL);
@@ -49,6 +72,7 @@ GLuint RendererProgram::compileShader(string filePath, GLenum shaderType) const
 
 GLuint RendererProgram::linkProgram(vector<GLuint> shaders) const {
     GLuint program = glCreateProgram();
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     for(vector<GLuint>::iterator it = shaders.begin(); it != shaders.end(); ++it) {
         glAttachShader(program, *it);
     }
@@ -62,6 +86,145 @@ GLuint RendererProgram::linkProgram(vector<GLuint> shaders) const {
     return program;
 }
 
+void RendererProgram::buildProgram(const vector<pair<GLenum, string>> &stages) {
+    uint64_t key = programCacheKey(stages);
+    program = loadProgramBinary(key);
+    if (program != 0) {
+        return;
+    }
+    vector<GLuint> shaders;
+    for (const pair<GLenum, string> &stage : stages) {
+        shaders.push_back(compileShader(stage.second, stage.first));
+    }
+    program = linkProgram(shaders);
+    for (GLuint shader : shaders) {
+        glDeleteShader(shader);
+    }
+    storeProgramBinary(key);
+}
+
+/*
+FNV-1a over every stage and the driver strings, so a driver update or an edited shader misses the cache.
+*/
+uint64_t RendererProgram::programCacheKey(const vector<pair<GLenum, string>> &stages) const {
+    uint64_t hash = 0xcbf29ce484222325;
+    auto append = [&hash](const void *data, size_t size) {
+        const uint8_t *bytes = (const uint8_t *)data;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3;
+        }
+    };
+    for (const pair<GLenum, string> &stage : stages) {
+        uint32_t type = stage.first;
+        uint64_t size = stage.second.size();
+        append(&type, sizeof(type));
+        append(&size, sizeof(size));
+        append(stage.second.data(), stage.second.size());
+    }
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION }) {
+        const GLubyte *value = glGetString(name);
+        string driver = value != nullptr ? string((const char *)value) : string();
+        append(driver.c_str(), driver.size() + 1);
+    }
+    return hash;
+}
+
+filesystem::path RendererProgram::programCachePath(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return filesystem::current_path() / "shader_cache" / name;
+}
+
+GLuint RendererProgram::loadProgramBinary(uint64_t key) const {
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0) {
+        return 0;
+    }
+    filesystem::path filePath = programCachePath(key);
+    ifstream file(filePath, ios::binary);
+    if (!file) {
+        return 0;
+    }
+    ProgramCacheHeader header;
+    if (!file.read((char *)&header, sizeof(header)) || header.magic != PROGRAM_CACHE_MAGIC || header.version != PROGRAM_CACHE_VERSION || header.key != key || header.length == 0) {
+        logger.logWarning("Ignoring invalid program cache %s", filePath.string().c_str());
+        return 0;
+    }
+    // Binaries in a format the driver doesn't list would raise GL_INVALID_ENUM instead of just failing to link.
+    vector<GLint> formats(formatCount);
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+    if (find(formats.begin(), formats.end(), (GLint)header.format) == formats.end()) {
+        logger.logWarning("Ignoring program cache %s with unsupported format 0x%x", filePath.string().c_str(), header.format);
+        return 0;
+    }
+    vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size())) {
+        logger.logWarning("Ignoring truncated program cache %s", filePath.string().c_str());
+        return 0;
+    }
+    GLuint cachedProgram = glCreateProgram();
+    glProgramBinary(cachedProgram, header.format, binary.data(), (GLsizei)binary.size());
+    GLint status = GL_FALSE;
+    glGetProgramiv(cachedProgram, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        logger.logMessage("Program cache %s rejected by the driver, recompiling", filePath.string().c_str());
+        glDeleteProgram(cachedProgram);
+        return 0;
+    }
+    return cachedProgram;
+}
+
+/*
+The binary is written next to its final name and renamed over it, so concurrent runs never see a partial file.
+Every writer gets its own temporary file, so two runs storing the same program can't interleave their writes.
+Failing to write the cache only costs the next launch a compile.
+*/
+void RendererProgram::storeProgramBinary(uint64_t key) const {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return;
+    }
+    filesystem::path filePath = programCachePath(key);
+    error_code error;
+    filesystem::create_directories(filePath.parent_path(), error);
+    if (error) {
+        logger.logWarning("Unable to create program cache directory: %s", error.message().c_str());
+        return;
+    }
+    random_device device;
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%08x%08x.tmp", device(), device());
+    filesystem::path temporaryPath = filePath;
+    temporaryPath += suffix;
+    {
+        ofstream file(temporaryPath, ios::binary | ios::trunc);
+        ProgramCacheHeader header = { PROGRAM_CACHE_MAGIC, PROGRAM_CACHE_VERSION, key, format, (uint32_t)written };
+        file.write((const char *)&header, sizeof(header));
+        file.write(binary.data(), written);
+        if (!file) {
+            logger.logWarning("Unable to write program cache %s", temporaryPath.string().c_str());
+            file.close();
+            filesystem::remove(temporaryPath, error);
+            return;
+        }
+    }
+    filesystem::rename(temporaryPath, filePath, error);
+    if (error) {
+        logger.logWarning("Unable to write program cache %s: %s", filePath.string().c_str(), error.message().c_str());
+        filesystem::remove(temporaryPath, error);
+    }
+}
+
 GLuint RendererProgram::findProgramAttribute(string attribute) const {
     const GLchar *attrib = attribute.c_str();
     GLint index = glGetAttribLocation(program, attrib);
@@ -0,0 +1,120 @@
+#include "RendererStatistics.hpp"
+
+RendererStatistics::RendererStatistics() : primitives(), texturedPrimitives(0), semiTransparentPrimitives(0), verticesUploaded(0), bytesUploaded(0), drawCalls(0), flushes(), vramUploads(0), vramUploadBytes(0), vramFills(0), vramCopies(0), skippedFrames(0), unchangedFrames(0), displayListPackets() {}
+
+uint64_t RendererStatistics::totalPrimitives() const {
+    uint64_t total = 0;
+    for (uint64_t count : primitives) {
+        total += count;
+    }
+    return total;
+}
+
+uint64_t RendererStatistics::totalFlushes() const {
+    uint64_t total = 0;
+    for (uint64_t count : flushes) {
+        total += count;
+    }
+    return total;
+}
+
+void RendererStatistics::add(const RendererStatistics &other) {
+    for (uint32_t i = 0; i < RendererPrimitiveTypeCount; i++) {
+        primitives[i] += other.primitives[i];
+    }
+    texturedPrimitives += other.texturedPrimitives;
+    semiTransparentPrimitives += other.semiTransparentPrimitives;
+    verticesUploaded += other.verticesUploaded;
+    bytesUploaded += other.bytesUploaded;
+    drawCalls += other.drawCalls;
+    for (uint32_t i = 0; i < RendererFlushReasonCount; i++) {
+        flushes[i] += other.flushes[i];
+    }
+    vramUploads += other.vramUploads;
+    vramUploadBytes += other.vramUploadBytes;
+    vramFills += other.vramFills;
+    vramCopies += other.vramCopies;
+    skippedFrames += other.skippedFrames;
+    unchangedFrames += other.unchangedFrames;
+    for (uint32_t i = 0; i < RendererDisplayListPacketCount; i++) {
+        displayListPackets[i] += other.displayListPackets[i];
+    }
+}
+
+const char* RendererStatistics::flushReasonName(RendererFlushReason reason) {
+    switch (reason) {
+        case RendererFlushReasonFrameEnd: {
+            return "Frame end";
+        }
+        case RendererFlushReasonBufferFull: {
+            return "Buffer full";
+        }
+        case RendererFlushReasonModeChange: {
+            return "Mode change";
+        }
+        case RendererFlushReasonDrawingArea: {
+            return "Drawing area";
+        }
+        case RendererFlushReasonDrawingOffset: {
+            return "Drawing offset";
+        }
+        case RendererFlushReasonTextureCacheFull: {
+            return "Texture cache full";
+        }
+        case RendererFlushReasonVRAMRead: {
+            return "VRAM read";
+        }
+        case RendererFlushReasonVRAMWrite: {
+            return "VRAM write";
+        }
+        case RendererFlushReasonTextureRead: {
+            return "Texture read";
+        }
+        case RendererFlushReasonVRAMFill: {
+            return "VRAM fill";
+        }
+        case RendererFlushReasonPolygonOneByOne: {
+            return "Polygon one by one";
+        }
+        case RendererFlushReasonSubtractiveBlending: {
+            return "Subtractive blending";
+        }
+        default: {
+            return "Unknown";
+        }
+    }
+}
+
+const char* RendererStatistics::primitiveTypeName(RendererPrimitiveType type) {
+    switch (type) {
+        case RendererPrimitiveTypeTriangle: {
+            return "Triangles";
+        }
+        case RendererPrimitiveTypeQuad: {
+            return "Quads";
+        }
+        case RendererPrimitiveTypeLine: {
+            return "Lines";
+        }
+        default: {
+            return "Unknown";
+        }
+    }
+}
+
+const char* RendererStatistics::displayListPacketName(RendererDisplayListPacket packet) {
+    switch (packet) {
+        case RendererDisplayListPacketHit: {
+            return "Hit";
+        }
+        case RendererDisplayListPacketMiss: {
+            return "Miss";
+        }
+        case RendererDisplayListPacketUncacheable: {
+            return "Uncacheable";
+        }
+        default: {
+            return "Unknown";
+        }
+    }
+}
@@ -0,0 +1,619 @@
+#include "SoftwareRasterizer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include "Renderer.hpp"
+
+using namespace std;
+
+struct SoftwareLanesScalar {
+    typedef int32_t Type;
+    static const int32_t WIDTH = 1;
+
+    static inline Type set(int32_t value) { return value; }
+    static inline Type ramp() { return 0; }
+    static inline Type load(const int32_t *values) { return values[0]; }
+    static inline void store(int32_t *values, Type value) { values[0] = value; }
+    static inline Type loadPixels(const uint16_t *pixels) { return pixels[0]; }
+    static inline void storePixels(uint16_t *pixels, Type value) { pixels[0] = (uint16_t)value; }
+    // Interpolation relies on 32bit wrap around just like the vector lanes do
+    static inline Type add(Type a, Type b) { return (int32_t)((uint32_t)a + (uint32_t)b); }
+    static inline Type subtract(Type a, Type b) { return (int32_t)((uint32_t)a - (uint32_t)b); }
+    static inline Type multiply(Type a, Type b) { return (int32_t)((uint32_t)a * (uint32_t)b); }
+    template <int count>
+    static inline Type shiftRight(Type value) { return value >> count; }
+    template <int count>
+    static inline Type shiftLeft(Type value) { return (int32_t)((uint32_t)value << count); }
+    static inline Type bitAnd(Type a, Type b) { return a & b; }
+    static inline Type bitOr(Type a, Type b) { return a | b; }
+    static inline Type min(Type a, Type b) { return a < b ? a : b; }
+    static inline Type max(Type a, Type b) { return a > b ? a : b; }
+    static inline Type equal(Type a, Type b) { return a == b ? -1 : 0; }
+    static inline Type select(Type mask, Type a, Type b) { return mask != 0 ? a : b; }
+};
+
+#include "SoftwareRasterizerSpan.tcc"
+
+void shadeSpanScalar(const SoftwareSpan &span) {
+    shadeSpanLanes<SoftwareLanesScalar>(span);
+}
+
+/*
+Picks the widest span loop that was both built and is supported by the host.
+*/
+static SoftwareSpanKernel selectSpanKernel() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (softwareSpanKernelAVX2() != nullptr && __builtin_cpu_supports("avx2")) {
+        return softwareSpanKernelAVX2();
+    }
+    if (softwareSpanKernelSSE41() != nullptr && __builtin_cpu_supports("sse4.1")) {
+        return softwareSpanKernelSSE41();
+    }
+#endif
+    return shadeSpanScalar;
+}
+
+static int64_t floorDivide(int64_t numerator, int64_t denominator) {
+    return numerator >= 0 ? numerator / denominator : -((denominator - 1 - numerator) / denominator);
+}
+
+static int64_t edgeAt(int32_t ax, int32_t ay, int32_t bx, int32_t by, int32_t x, int32_t y) {
+    return ((int64_t)(bx - ax)) * (y - ay) - ((int64_t)(by - ay)) * (x - ax);
+}
+
+// Pixels exactly on an edge only belong to the triangle when the edge is a top or a left one,
+// so triangles sharing an edge never draw the same pixel twice
+static bool isTopLeft(int32_t ax, int32_t ay, int32_t bx, int32_t by) {
+    return (ay == by && bx > ax) || by < ay;
+}
+
+/*
+Marks the tiles covering the rectangle, columns wrap around VRAM.
+*/
+static void markTiles(SoftwareTileMask &tiles, int32_t left, int32_t top, int32_t right, int32_t bottom) {
+    const int32_t columns = VRAM_WIDTH / SOFTWARE_RASTERIZER_TILE_WIDTH;
+    uint16_t mask = 0;
+    int32_t firstColumn = left / SOFTWARE_RASTERIZER_TILE_WIDTH;
+    int32_t lastColumn = min(right / SOFTWARE_RASTERIZER_TILE_WIDTH, firstColumn + columns - 1);
+    for (int32_t column = firstColumn; column <= lastColumn; column++) {
+        mask |= 1 << (column % columns);
+    }
+    for (int32_t row = top / SOFTWARE_RASTERIZER_TILE_HEIGHT; row <= bottom / SOFTWARE_RASTERIZER_TILE_HEIGHT; row++) {
+        tiles[row % tiles.size()] |= mask;
+    }
+}
+
+/*
+Marks the tiles a textured primitive may read from, its texture page and its CLUT.
+*/
+static void markTextureReads(SoftwareTileMask &tiles, const SoftwareSpan &span) {
+    if (span.textureBlendMode == TextureBlendMode::TextureBlendModeNoTexture) {
+        return;
+    }
+    int32_t pageX = span.texturePageX & (VRAM_WIDTH - 1);
+    int32_t pageY = span.texturePageY & (VRAM_HEIGHT - 1);
+    markTiles(tiles, pageX, pageY, pageX + (256 >> span.textureDepthShift) - 1, min(pageY + 255, (int32_t)VRAM_HEIGHT - 1));
+    if (span.textureDepthShift == 0) {
+        return;
+    }
+    int32_t clutX = span.clutX & (VRAM_WIDTH - 1);
+    int32_t clutY = span.clutY & (VRAM_HEIGHT - 1);
+    markTiles(tiles, clutX, clutY, clutX + (1 << (16 >> span.textureDepthShift)) - 1, clutY);
+}
+
+static bool tilesIntersect(const SoftwareTileMask &first, const SoftwareTileMask &second) {
+    for (uint32_t row = 0; row < first.size(); row++) {
+        if ((first[row] & second[row]) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(uint32_t workerCount) : logger(LogLevel::NoLog), vram(VRAM_SIZE, 0), kernel(selectSpanKernel()), drawingOffset(), drawingAreaTopLeft(), drawingAreaSize({}), semiTransparencyMode(0), dithering(false), setMaskBit(false), checkMaskBit(false), textureWindowMaskX(0), textureWindowMaskY(0), textureWindowOffsetX(0), textureWindowOffsetY(0), primitives(), batchTop(VRAM_HEIGHT), batchBottom(-1), batchWrites(), batchReads(), batchPixels(0), batchSerial(false), workerCount(clamp(workerCount, (uint32_t)1, SOFTWARE_RASTERIZER_MAX_WORKERS)), workers(), generation(0), activeWorkers(0), pendingWorkers(0), stopping(false) {
+    primitives.reserve(SOFTWARE_RASTERIZER_CAPACITY);
+    // The calling thread always takes the first share of the bands
+    for (uint32_t worker = 1; worker < this->workerCount; worker++) {
+        workers.emplace_back(&SoftwareRasterizer::workerLoop, this, worker);
+    }
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+const char* SoftwareRasterizer::kernelName() const {
+    if (kernel == softwareSpanKernelAVX2()) {
+        return "AVX2";
+    }
+    if (kernel == softwareSpanKernelSSE41()) {
+        return "SSE4.1";
+    }
+    return "scalar";
+}
+
+uint32_t SoftwareRasterizer::getWorkerCount() const {
+    return workerCount;
+}
+
+uint32_t SoftwareRasterizer::remainingCapacity() const {
+    return SOFTWARE_RASTERIZER_CAPACITY - primitives.size();
+}
+
+bool SoftwareRasterizer::isEmpty() const {
+    return primitives.empty();
+}
+
+/*
+Dithering applies to shaded and texture blended primitives only, with the same heuristic the
+compute rasterizer uses to tell shaded primitives apart.
+*/
+SoftwareSpan SoftwareRasterizer::spanFor(const Vertex &vertex, bool opaque, bool shaded) {
+    SoftwareSpan span = {};
+    span.vram = vram.data();
+    span.textureBlendMode = vertex.textureBlendMode;
+    span.textureDepthShift = vertex.textureDepthShift;
+    span.texturePageX = vertex.texturePage.x;
+    span.texturePageY = vertex.texturePage.y;
+    span.clutX = vertex.clut.x;
+    span.clutY = vertex.clut.y;
+    span.textureWindowMaskX = textureWindowMaskX;
+    span.textureWindowMaskY = textureWindowMaskY;
+    span.textureWindowOffsetX = textureWindowOffsetX;
+    span.textureWindowOffsetY = textureWindowOffsetY;
+    span.semiTransparencyMode = semiTransparencyMode;
+    span.semiTransparent = !opaque;
+    span.dither = dithering && (shaded || vertex.textureBlendMode == TextureBlendMode::TextureBlendModeTextureBlend);
+    span.setMaskBit = setMaskBit;
+    span.checkMaskBit = checkMaskBit;
+    return span;
+}
+
+/*
+Marks the tiles the primitive with the given vertices, already offset, draws to once clipped to
+the drawing area.
+*/
+void SoftwareRasterizer::markWrites(SoftwareTileMask &tiles, const int32_t *x, const int32_t *y, uint32_t count) const {
+    int32_t left = x[0];
+    int32_t right = x[0];
+    int32_t top = y[0];
+    int32_t bottom = y[0];
+    for (uint32_t i = 1; i < count; i++) {
+        left = min(left, x[i]);
+        right = max(right, x[i]);
+        top = min(top, y[i]);
+        bottom = max(bottom, y[i]);
+    }
+    left = max(left, (int32_t)drawingAreaTopLeft.x);
+    right = min({ right, (int32_t)drawingAreaTopLeft.x + (int32_t)drawingAreaSize.width, (int32_t)VRAM_WIDTH - 1 });
+    top = max(top, (int32_t)drawingAreaTopLeft.y);
+    bottom = min({ bottom, (int32_t)drawingAreaTopLeft.y + (int32_t)drawingAreaSize.height, (int32_t)VRAM_HEIGHT - 1 });
+    if (left > right || top > bottom) {
+        return;
+    }
+    markTiles(tiles, left, top, right, bottom);
+}
+
+/*
+A primitive textured from tiles it draws to itself may read pixels it has just written, which
+only matches drawing it on one thread if it is, so the whole batch falls back to a single band.
+*/
+void SoftwareRasterizer::pushPrimitive(SoftwarePrimitive &primitive) {
+    SoftwareTileMask writes = {};
+    SoftwareTileMask reads = {};
+    markTiles(writes, primitive.left, primitive.top, primitive.right, primitive.bottom);
+    markTextureReads(reads, primitive.span);
+    if (tilesIntersect(writes, reads)) {
+        batchSerial = true;
+    }
+    for (uint32_t row = 0; row < writes.size(); row++) {
+        batchWrites[row] |= writes[row];
+        batchReads[row] |= reads[row];
+    }
+    batchTop = min(batchTop, primitive.top);
+    batchBottom = max(batchBottom, primitive.bottom);
+    batchPixels += ((uint64_t)(primitive.right - primitive.left + 1)) * (primitive.bottom - primitive.top + 1);
+    primitives.push_back(primitive);
+}
+
+/*
+Whether the primitive about to be pushed has to wait for the pending batch to be drawn: either
+it is textured from tiles the batch draws to, or it draws to tiles the batch is textured from.
+Bands are drawn concurrently, so in both cases a band could otherwise see a texel before or
+after a write from another band that comes after or before it in submission order.
+*/
+bool SoftwareRasterizer::conflictsWithBatch(const std::vector<Vertex> &vertices) const {
+    if (primitives.empty()) {
+        return false;
+    }
+    vector<int32_t> x = vector<int32_t>(vertices.size());
+    vector<int32_t> y = vector<int32_t>(vertices.size());
+    uint32_t count = vertices.size();
+    for (uint32_t i = 0; i < count; i++) {
+        x[i] = vertices[i].point.x + drawingOffset.x;
+        y[i] = vertices[i].point.y + drawingOffset.y;
+    }
+    SoftwareTileMask writes = {};
+    markWrites(writes, x.data(), y.data(), count);
+    if (tilesIntersect(writes, batchReads)) {
+        return true;
+    }
+    SoftwareSpan span = {};
+    span.textureBlendMode = vertices.front().textureBlendMode;
+    span.textureDepthShift = vertices.front().textureDepthShift;
+    span.texturePageX = vertices.front().texturePage.x;
+    span.texturePageY = vertices.front().texturePage.y;
+    span.clutX = vertices.front().clut.x;
+    span.clutY = vertices.front().clut.y;
+    SoftwareTileMask reads = {};
+    markTextureReads(reads, span);
+    return tilesIntersect(reads, batchWrites);
+}
+
+/*
+Whether a fill of the rectangle has to wait for the pending batch, because the batch draws to or
+is textured from any of the tiles it covers.
+*/
+bool SoftwareRasterizer::conflictsWithBatch(Point2D topLeft, Dimensions size) const {
+    if (primitives.empty()) {
+        return false;
+    }
+    SoftwareTileMask tiles = {};
+    markTiles(tiles, topLeft.x, topLeft.y, topLeft.x + size.width - 1, topLeft.y + size.height - 1);
+    return tilesIntersect(tiles, batchWrites) || tilesIntersect(tiles, batchReads);
+}
+
+void SoftwareRasterizer::pushTriangle(const Vertex &first, const Vertex &second, const Vertex &third, bool opaque, bool shaded) {
+    SoftwarePrimitive primitive = {};
+    primitive.line = false;
+    const Vertex *vertices[3] = { &first, &second, &third };
+    int32_t *x = primitive.x;
+    int32_t *y = primitive.y;
+    for (uint32_t i = 0; i < 3; i++) {
+        x[i] = vertices[i]->point.x + drawingOffset.x;
+        y[i] = vertices[i]->point.y + drawingOffset.y;
+    }
+    int64_t area = edgeAt(x[0], y[0], x[1], y[1], x[2], y[2]);
+    if (area == 0) {
+        return;
+    }
+    if (area < 0) {
+        swap(x[1], x[2]);
+        swap(y[1], y[2]);
+        swap(vertices[1], vertices[2]);
+        area = -area;
+    }
+    primitive.area = area;
+    primitive.left = max(min({ x[0], x[1], x[2] }), (int32_t)drawingAreaTopLeft.x);
+    primitive.right = min({ max({ x[0], x[1], x[2] }), (int32_t)drawingAreaTopLeft.x + (int32_t)drawingAreaSize.width, (int32_t)VRAM_WIDTH - 1 });
+    primitive.top = max(min({ y[0], y[1], y[2] }), (int32_t)drawingAreaTopLeft.y);
+    primitive.bottom = min({ max({ y[0], y[1], y[2] }), (int32_t)drawingAreaTopLeft.y + (int32_t)drawingAreaSize.height, (int32_t)VRAM_HEIGHT - 1 });
+    if (primitive.left > primitive.right || primitive.top > primitive.bottom) {
+        return;
+    }
+
+    // Edge i is the one opposite to vertex i, its function is the weight of that vertex
+    for (uint32_t i = 0; i < 3; i++) {
+        uint32_t a = (i + 1) % 3;
+        uint32_t b = (i + 2) % 3;
+        primitive.edgeStepX[i] = -(int64_t)(y[b] - y[a]);
+        primitive.edgeBias[i] = isTopLeft(x[a], y[a], x[b], y[b]) ? 0 : -1;
+    }
+
+    // Color and texture position relative to the first vertex, then weighted by vertices 1 and 2
+    for (uint32_t i = 0; i < 3; i++) {
+        const Vertex *vertex = vertices[i];
+        int64_t values[5] = { vertex->color.r, vertex->color.g, vertex->color.b, vertex->texturePosition.x & 0xffff, vertex->texturePosition.y & 0xffff };
+        for (uint32_t j = 0; j < 5; j++) {
+            if (i == 0) {
+                primitive.base[j] = values[j];
+            } else {
+                primitive.delta[i - 1][j] = values[j] - primitive.base[j];
+            }
+        }
+    }
+    int32_t steps[5];
+    for (uint32_t j = 0; j < 5; j++) {
+        steps[j] = floorDivide((primitive.edgeStepX[1] * primitive.delta[0][j] + primitive.edgeStepX[2] * primitive.delta[1][j]) * 65536, area);
+    }
+
+    primitive.span = spanFor(first, opaque, shaded);
+    primitive.span.stepR = steps[0];
+    primitive.span.stepG = steps[1];
+    primitive.span.stepB = steps[2];
+    primitive.span.stepU = steps[3];
+    primitive.span.stepV = steps[4];
+    pushPrimitive(primitive);
+}
+
+/*
+Walks the given rows of the triangle. The range of each row is found analytically from the three
+edge functions, then color and texture position are set up exactly at its first pixel from
+integer barycentrics and stepped in 16.16 fixed point by the span loop. Nothing carries over
+from one row to the next, which is what lets bands be drawn independently.
+*/
+void SoftwareRasterizer::rasterizeTriangle(const SoftwarePrimitive &primitive, int32_t top, int32_t bottom) const {
+    const int32_t *x = primitive.x;
+    const int32_t *y = primitive.y;
+    int32_t left = primitive.left;
+    SoftwareSpan span = primitive.span;
+    for (int32_t row = top; row <= bottom; row++) {
+        int32_t rowLeft = left;
+        int32_t rowRight = primitive.right;
+        int64_t weights[3];
+        for (uint32_t i = 0; i < 3; i++) {
+            uint32_t a = (i + 1) % 3;
+            uint32_t b = (i + 2) % 3;
+            weights[i] = edgeAt(x[a], y[a], x[b], y[b], left, row);
+            int64_t value = weights[i] + primitive.edgeBias[i];
+            int64_t stepX = primitive.edgeStepX[i];
+            if (stepX == 0) {
+                if (value < 0) {
+                    rowRight = rowLeft - 1;
+                }
+            } else if (stepX < 0) {
+                rowRight = min<int64_t>(rowRight, left + floorDivide(value, -stepX));
+            } else {
+                rowLeft = max<int64_t>(rowLeft, left - floorDivide(value, stepX));
+            }
+        }
+        if (rowLeft > rowRight) {
+            continue;
+        }
+        int64_t weight1 = weights[1] + primitive.edgeStepX[1] * (rowLeft - left);
+        int64_t weight2 = weights[2] + primitive.edgeStepX[2] * (rowLeft - left);
+        int32_t values[5];
+        for (uint32_t j = 0; j < 5; j++) {
+            values[j] = primitive.base[j] * 65536 + floorDivide((weight1 * primitive.delta[0][j] + weight2 * primitive.delta[1][j]) * 65536, primitive.area);
+        }
+        span.x = rowLeft;
+        span.y = row;
+        span.length = rowRight - rowLeft + 1;
+        span.r = values[0];
+        span.g = values[1];
+        span.b = values[2];
+        span.u = values[3];
+        span.v = values[4];
+        kernel(span);
+    }
+}
+
+void SoftwareRasterizer::pushLine(const Vertex &start, const Vertex &end, bool opaque) {
+    SoftwarePrimitive primitive = {};
+    primitive.line = true;
+    primitive.x[0] = start.point.x + drawingOffset.x;
+    primitive.y[0] = start.point.y + drawingOffset.y;
+    primitive.x[1] = end.point.x + drawingOffset.x;
+    primitive.y[1] = end.point.y + drawingOffset.y;
+    primitive.left = max(min(primitive.x[0], primitive.x[1]), (int32_t)drawingAreaTopLeft.x);
+    primitive.right = min({ max(primitive.x[0], primitive.x[1]), (int32_t)drawingAreaTopLeft.x + (int32_t)drawingAreaSize.width, (int32_t)VRAM_WIDTH - 1 });
+    primitive.top = max(min(primitive.y[0], primitive.y[1]), (int32_t)drawingAreaTopLeft.y);
+    primitive.bottom = min({ max(primitive.y[0], primitive.y[1]), (int32_t)drawingAreaTopLeft.y + (int32_t)drawingAreaSize.height, (int32_t)VRAM_HEIGHT - 1 });
+    if (primitive.left > primitive.right || primitive.top > primitive.bottom) {
+        return;
+    }
+    primitive.base[0] = start.color.r;
+    primitive.base[1] = start.color.g;
+    primitive.base[2] = start.color.b;
+    primitive.delta[0][0] = end.color.r - start.color.r;
+    primitive.delta[0][1] = end.color.g - start.color.g;
+    primitive.delta[0][2] = end.color.b - start.color.b;
+    bool shaded = primitive.delta[0][0] != 0 || primitive.delta[0][1] != 0 || primitive.delta[0][2] != 0;
+    primitive.span = spanFor(start, opaque, shaded);
+    primitive.span.textureBlendMode = TextureBlendMode::TextureBlendModeNoTexture;
+    primitive.span.length = 1;
+    pushPrimitive(primitive);
+}
+
+/*
+Lines step along their major axis one pixel at a time, rounding the minor axis to the nearest
+pixel, and are shaded with single pixel spans. Only pixels within the given rows are drawn.
+*/
+void SoftwareRasterizer::rasterizeLine(const SoftwarePrimitive &primitive, int32_t top, int32_t bottom) const {
+    int32_t x0 = primitive.x[0];
+    int32_t y0 = primitive.y[0];
+    int32_t deltaX = primitive.x[1] - x0;
+    int32_t deltaY = primitive.y[1] - y0;
+    int32_t steps = max(abs(deltaX), abs(deltaY));
+    SoftwareSpan span = primitive.span;
+    for (int32_t step = 0; step <= steps; step++) {
+        int32_t x = x0;
+        int32_t y = y0;
+        if (steps > 0 && abs(deltaX) >= abs(deltaY)) {
+            x = x0 + (deltaX < 0 ? -step : step);
+            y = y0 + floorDivide(2 * step * deltaY + steps, 2 * steps);
+        } else if (steps > 0) {
+            y = y0 + (deltaY < 0 ? -step : step);
+            x = x0 + floorDivide(2 * step * deltaX + steps, 2 * steps);
+        }
+        if (x < primitive.left || x > primitive.right || y < top || y > bottom) {
+            continue;
+        }
+        span.x = x;
+        span.y = y;
+        span.r = primitive.base[0] * 65536;
+        span.g = primitive.base[1] * 65536;
+        span.b = primitive.base[2] * 65536;
+        if (steps > 0) {
+            span.r += floorDivide(step * primitive.delta[0][0], steps) * 65536;
+            span.g += floorDivide(step * primitive.delta[0][1], steps) * 65536;
+            span.b += floorDivide(step * primitive.delta[0][2], steps) * 65536;
+        }
+        shadeSpanScalar(span);
+    }
+}
+
+/*
+Quadrilaterals are drawn as the triangles (0, 1, 2) and (1, 2, 3).
+*/
+void SoftwareRasterizer::pushPolygon(const std::vector<Vertex> &vertices, bool opaque) {
+    bool shaded = false;
+    for (auto& vertex : vertices) {
+        const Color &color = vertices.front().color;
+        shaded = shaded || vertex.color.r != color.r || vertex.color.g != color.g || vertex.color.b != color.b;
+    }
+    pushTriangle(vertices[0], vertices[1], vertices[2], opaque, shaded);
+    if (vertices.size() == 4) {
+        pushTriangle(vertices[1], vertices[2], vertices[3], opaque, shaded);
+    }
+}
+
+/*
+Draws, in submission order, the rows of every primitive that fall in the bands owned by the
+worker: band b covers rows b * SOFTWARE_RASTERIZER_BAND_HEIGHT onwards and belongs to worker
+b % stride.
+*/
+void SoftwareRasterizer::rasterizeBands(uint32_t worker, uint32_t stride) const {
+    for (auto& primitive : primitives) {
+        int32_t firstBand = primitive.top / SOFTWARE_RASTERIZER_BAND_HEIGHT;
+        int32_t lastBand = primitive.bottom / SOFTWARE_RASTERIZER_BAND_HEIGHT;
+        int32_t band = firstBand + ((int32_t)worker - firstBand % (int32_t)stride + (int32_t)stride) % (int32_t)stride;
+        for (; band <= lastBand; band += stride) {
+            int32_t top = max(primitive.top, band * SOFTWARE_RASTERIZER_BAND_HEIGHT);
+            int32_t bottom = min(primitive.bottom, band * SOFTWARE_RASTERIZER_BAND_HEIGHT + SOFTWARE_RASTERIZER_BAND_HEIGHT - 1);
+            if (primitive.line) {
+                rasterizeLine(primitive, top, bottom);
+            } else {
+                rasterizeTriangle(primitive, top, bottom);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::workerLoop(uint32_t worker) {
+    uint64_t lastGeneration = 0;
+    while (true) {
+        uint32_t stride;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [&] { return stopping || generation != lastGeneration; });
+            if (stopping) {
+                return;
+            }
+            lastGeneration = generation;
+            if (worker >= activeWorkers) {
+                continue;
+            }
+            stride = activeWorkers;
+        }
+        rasterizeBands(worker, stride);
+        {
+            lock_guard<std::mutex> lock(mutex);
+            pendingWorkers--;
+        }
+        workFinished.notify_one();
+    }
+}
+
+/*
+Draws the pending primitives and returns how many were drawn. Small batches, and batches with a
+primitive textured from its own rows, are drawn on the calling thread alone.
+*/
+uint32_t SoftwareRasterizer::flush() {
+    uint32_t count = primitives.size();
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t bands = (batchBottom / SOFTWARE_RASTERIZER_BAND_HEIGHT) - (batchTop / SOFTWARE_RASTERIZER_BAND_HEIGHT) + 1;
+    uint32_t stride = min(workerCount, bands);
+    if (batchSerial || batchPixels < SOFTWARE_RASTERIZER_PARALLEL_THRESHOLD) {
+        stride = 1;
+    }
+    if (stride > 1) {
+        {
+            lock_guard<std::mutex> lock(mutex);
+            activeWorkers = stride;
+            pendingWorkers = stride - 1;
+            generation++;
+        }
+        workAvailable.notify_all();
+    }
+    rasterizeBands(0, stride);
+    if (stride > 1) {
+        unique_lock<std::mutex> lock(mutex);
+        workFinished.wait(lock, [&] { return pendingWorkers == 0; });
+    }
+
+    primitives.clear();
+    batchTop = VRAM_HEIGHT;
+    batchBottom = -1;
+    batchWrites = {};
+    batchReads = {};
+    batchPixels = 0;
+    batchSerial = false;
+    return count;
+}
+
+void SoftwareRasterizer::setDrawingOffset(int16_t x, int16_t y) {
+    drawingOffset = Point2D(x, y);
+}
+
+void SoftwareRasterizer::setDrawingArea(Point2D topLeft, Dimensions size) {
+    drawingAreaTopLeft = topLeft;
+    drawingAreaSize = size;
+}
+
+void SoftwareRasterizer::setSemiTransparencyMode(uint32_t mode) {
+    semiTransparencyMode = mode;
+}
+
+void SoftwareRasterizer::setDithering(bool enabled) {
+    dithering = enabled;
+}
+
+void SoftwareRasterizer::setMaskBitSetting(bool setMaskBit, bool checkMaskBit) {
+    this->setMaskBit = setMaskBit;
+    this->checkMaskBit = checkMaskBit;
+}
+
+void SoftwareRasterizer::setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) {
+    textureWindowMaskX = maskX & 0x1f;
+    textureWindowMaskY = maskY & 0x1f;
+    textureWindowOffsetX = offsetX & 0x1f;
+    textureWindowOffsetY = offsetY & 0x1f;
+}
+
+/*
+Uploads wrap around VRAM horizontally and vertically.
+*/
+void SoftwareRasterizer::writeVRAM(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    uint16_t x, y, width, height;
+    tie(x, y) = imageBuffer->destination();
+    tie(width, height) = imageBuffer->resolution();
+    uint16_t *buffer = imageBuffer->bufferRef();
+    for (uint32_t row = 0; row < height; row++) {
+        uint32_t rowOffset = ((y + row) & (VRAM_HEIGHT - 1)) * VRAM_WIDTH;
+        for (uint32_t column = 0; column < width; column++) {
+            vram[rowOffset + ((x + column) & (VRAM_WIDTH - 1))] = buffer[row * width + column];
+        }
+    }
+}
+
+/*
+Fills a rectangle that fits in VRAM, regardless of the drawing area and the mask bit settings.
+*/
+void SoftwareRasterizer::fillVRAM(Point2D topLeft, Dimensions size, uint16_t color) {
+    for (uint32_t row = 0; row < size.height; row++) {
+        uint16_t *destination = &vram[(topLeft.y + row) * VRAM_WIDTH + topLeft.x];
+        fill(destination, destination + size.width, color);
+    }
+}
+
+void SoftwareRasterizer::copyVRAM(Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit) {
+    Renderer::copyVRAMRectangle(vram.data(), source, destination, size, setMaskBit, checkMaskBit);
+}
+
+std::vector<uint16_t> SoftwareRasterizer::readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) const {
+    return Renderer::readVRAMRectangle(vram.data(), x, y, width, height);
+}
+
+const uint16_t* SoftwareRasterizer::vramRef() const {
+    return vram.data();
+}
@@ -0,0 +1,51 @@
+#include "SoftwareSpan.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+struct SoftwareLanesAVX2 {
+    typedef __m256i Type;
+    static const int32_t WIDTH = 8;
+
+    static inline Type set(int32_t value) { return _mm256_set1_epi32(value); }
+    static inline Type ramp() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    static inline Type load(const int32_t *values) { return _mm256_load_si256((const __m256i *)values); }
+    static inline void store(int32_t *values, Type value) { _mm256_store_si256((__m256i *)values, value); }
+    static inline Type loadPixels(const uint16_t *pixels) { return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)pixels)); }
+    static inline void storePixels(uint16_t *pixels, Type value) {
+        // Packing works within each 128bit half, so the two low quadwords are gathered afterwards
+        Type packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(value, value), 0x08);
+        _mm_storeu_si128((__m128i *)pixels, _mm256_castsi256_si128(packed));
+    }
+    static inline Type add(Type a, Type b) { return _mm256_add_epi32(a, b); }
+    static inline Type subtract(Type a, Type b) { return _mm256_sub_epi32(a, b); }
+    static inline Type multiply(Type a, Type b) { return _mm256_mullo_epi32(a, b); }
+    template <int count>
+    static inline Type shiftRight(Type value) { return _mm256_srai_epi32(value, count); }
+    template <int count>
+    static inline Type shiftLeft(Type value) { return _mm256_slli_epi32(value, count); }
+    static inline Type bitAnd(Type a, Type b) { return _mm256_and_si256(a, b); }
+    static inline Type bitOr(Type a, Type b) { return _mm256_or_si256(a, b); }
+    static inline Type min(Type a, Type b) { return _mm256_min_epi32(a, b); }
+    static inline Type max(Type a, Type b) { return _mm256_max_epi32(a, b); }
+    static inline Type equal(Type a, Type b) { return _mm256_cmpeq_epi32(a, b); }
+    static inline Type select(Type mask, Type a, Type b) { return _mm256_blendv_epi8(b, a, mask); }
+};
+
+#include "SoftwareRasterizerSpan.tcc"
+
+static void shadeSpanAVX2(const SoftwareSpan &span) {
+    shadeSpanLanes<SoftwareLanesAVX2>(span);
+}
+#endif
+
+/*
+Returns nullptr when this file was not built with AVX2 enabled.
+*/
+SoftwareSpanKernel softwareSpanKernelAVX2() {
+#ifdef __AVX2__
+    return shadeSpanAVX2;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,47 @@
+#include "SoftwareSpan.hpp"
+
+#ifdef __SSE4_1__
+#include <immintrin.h>
+
+struct SoftwareLanesSSE41 {
+    typedef __m128i Type;
+    static const int32_t WIDTH = 4;
+
+    static inline Type set(int32_t value) { return _mm_set1_epi32(value); }
+    static inline Type ramp() { return _mm_setr_epi32(0, 1, 2, 3); }
+    static inline Type load(const int32_t *values) { return _mm_load_si128((const __m128i *)values); }
+    static inline void store(int32_t *values, Type value) { _mm_store_si128((__m128i *)values, value); }
+    static inline Type loadPixels(const uint16_t *pixels) { return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)pixels)); }
+    static inline void storePixels(uint16_t *pixels, Type value) { _mm_storel_epi64((__m128i *)pixels, _mm_packus_epi32(value, value)); }
+    static inline Type add(Type a, Type b) { return _mm_add_epi32(a, b); }
+    static inline Type subtract(Type a, Type b) { return _mm_sub_epi32(a, b); }
+    static inline Type multiply(Type a, Type b) { return _mm_mullo_epi32(a, b); }
+    template <int count>
+    static inline Type shiftRight(Type value) { return _mm_srai_epi32(value, count); }
+    template <int count>
+    static inline Type shiftLeft(Type value) { return _mm_slli_epi32(value, count); }
+    static inline Type bitAnd(Type a, Type b) { return _mm_and_si128(a, b); }
+    static inline Type bitOr(Type a, Type b) { return _mm_or_si128(a, b); }
+    static inline Type min(Type a, Type b) { return _mm_min_epi32(a, b); }
+    static inline Type max(Type a, Type b) { return _mm_max_epi32(a, b); }
+    static inline Type equal(Type a, Type b) { return _mm_cmpeq_epi32(a, b); }
+    static inline Type select(Type mask, Type a, Type b) { return _mm_blendv_epi8(b, a, mask); }
+};
+
+#include "SoftwareRasterizerSpan.tcc"
+
+static void shadeSpanSSE41(const SoftwareSpan &span) {
+    shadeSpanLanes<SoftwareLanesSSE41>(span);
+}
+#endif
+
+/*
+Returns nullptr when this file was not built with SSE4.1 enabled.
+*/
+SoftwareSpanKernel softwareSpanKernelSSE41() {
+#ifdef __SSE4_1__
+    return shadeSpanSSE41;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,272 @@
+#include "SoftwareRenderer.hpp"
+#include <algorithm>
+#include <thread>
+#include "GPU.hpp"
+#include "ConfigurationManager.hpp"
+
+using namespace std;
+
+SoftwareRenderer::SoftwareRenderer(std::unique_ptr<Window> &mainWindow, GPU *gpu) : logger(LogLevel::NoLog), mainWindow(mainWindow), sdlRenderer(nullptr), sdlTexture(nullptr), displayAreaStart(), screenResolution({}), drawingAreaTopLeft(), drawingAreaSize({}), renderPolygonOneByOne(false) {
+    ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
+    resizeToFitFramebuffer = configurationManager->shouldResizeWindowToFitFramebuffer();
+    uint32_t threads = configurationManager->softwareRendererThreads();
+    if (threads == 0) {
+        threads = max(thread::hardware_concurrency(), 1u);
+    }
+    rasterizer = make_unique<SoftwareRasterizer>(threads);
+    if (!mainWindow->isHeadless()) {
+        sdlRenderer = SDL_CreateRenderer(mainWindow->getWindowRef(), -1, 0);
+        if (sdlRenderer == nullptr) {
+            logger.logError("Error creating SDL renderer: %s", SDL_GetError());
+        }
+        sdlTexture = SDL_CreateTexture(sdlRenderer, SDL_PIXELFORMAT_ABGR1555, SDL_TEXTUREACCESS_STREAMING, VRAM_WIDTH, VRAM_HEIGHT);
+        if (sdlTexture == nullptr) {
+            logger.logError("Error creating SDL texture: %s", SDL_GetError());
+        }
+        SDL_SetTextureBlendMode(sdlTexture, SDL_BLENDMODE_NONE);
+    }
+    logger.logMessage("Software renderer using %s span loops on %d threads", rasterizer->kernelName(), rasterizer->getWorkerCount());
+
+    displayAreaStart = gpu->getDisplayAreaStart();
+    screenResolution = gpu->getResolution();
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+    frameCapture.reset();
+    if (sdlTexture != nullptr) {
+        SDL_DestroyTexture(sdlTexture);
+    }
+    if (sdlRenderer != nullptr) {
+        SDL_DestroyRenderer(sdlRenderer);
+    }
+    SDL_Quit();
+}
+
+void SoftwareRenderer::checkRenderPolygonOneByOne() {
+    if (!renderPolygonOneByOne) {
+        return;
+    }
+    renderFrame(RendererFlushReason::RendererFlushReasonPolygonOneByOne);
+    presentFrame();
+}
+
+void SoftwareRenderer::pushLine(std::vector<Vertex> vertices, bool opaque) {
+    unsigned int size = vertices.size();
+    if (size < 2) {
+        logger.logError("Unhandled line with %d vertices", size);
+        return;
+    }
+    markVRAMWritten(drawingAreaTopLeft, drawingAreaSize);
+    frameStatistics.primitives[RendererPrimitiveType::RendererPrimitiveTypeLine] += size / 2;
+    if (!opaque) {
+        frameStatistics.semiTransparentPrimitives += size / 2;
+    }
+    if (rasterizer->remainingCapacity() < size / 2) {
+        renderFrame(RendererFlushReason::RendererFlushReasonBufferFull);
+    }
+    if (rasterizer->conflictsWithBatch(vertices)) {
+        renderFrame(RendererFlushReason::RendererFlushReasonTextureRead);
+    }
+    for (unsigned int i = 0; i + 1 < size; i += 2) {
+        rasterizer->pushLine(vertices[i], vertices[i + 1], opaque);
+    }
+    checkRenderPolygonOneByOne();
+}
+
+void SoftwareRenderer::pushPolygon(std::vector<Vertex> vertices, bool opaque, TextureBlendMode textureBlendMode) {
+    unsigned int size = vertices.size();
+    if (size < 3 || size > 4) {
+        logger.logError("Unhandled polygon with %d vertices", size);
+        return;
+    }
+    markVRAMWritten(drawingAreaTopLeft, drawingAreaSize);
+    frameStatistics.primitives[size == 3 ? RendererPrimitiveType::RendererPrimitiveTypeTriangle : RendererPrimitiveType::RendererPrimitiveTypeQuad]++;
+    if (textureBlendMode != TextureBlendMode::TextureBlendModeNoTexture) {
+        frameStatistics.texturedPrimitives++;
+    }
+    if (!opaque) {
+        frameStatistics.semiTransparentPrimitives++;
+    }
+    if (rasterizer->remainingCapacity() < 2) {
+        renderFrame(RendererFlushReason::RendererFlushReasonBufferFull);
+    }
+    if (rasterizer->conflictsWithBatch(vertices)) {
+        renderFrame(RendererFlushReason::RendererFlushReasonTextureRead);
+    }
+    rasterizer->pushPolygon(vertices, opaque);
+    checkRenderPolygonOneByOne();
+}
+
+void SoftwareRenderer::pushRectangle(RectangleInstance rectangle) {
+    pushPolygon(rectangle.vertices(), !rectangle.transparent, TextureBlendMode(rectangle.textureBlendMode));
+}
+
+void SoftwareRenderer::setDrawingOffset(int16_t x, int16_t y) {
+    rasterizer->setDrawingOffset(x, y);
+}
+
+void SoftwareRenderer::setSemiTransparencyMode(uint8_t mode) {
+    rasterizer->setSemiTransparencyMode(mode);
+}
+
+void SoftwareRenderer::setDithering(bool enabled) {
+    rasterizer->setDithering(enabled);
+}
+
+void SoftwareRenderer::setTextureWindow(uint8_t maskX, uint8_t maskY, uint8_t offsetX, uint8_t offsetY) {
+    rasterizer->setTextureWindow(maskX, maskY, offsetX, offsetY);
+}
+
+void SoftwareRenderer::setMaskBitSetting(bool setMaskBit, bool checkMaskBit) {
+    rasterizer->setMaskBitSetting(setMaskBit, checkMaskBit);
+}
+
+void SoftwareRenderer::prepareFrame() {}
+
+void SoftwareRenderer::renderFrame(RendererFlushReason reason) {
+    if (rasterizer->isEmpty()) {
+        return;
+    }
+    rasterizer->flush();
+    frameStatistics.drawCalls++;
+    frameStatistics.flushes[reason]++;
+}
+
+/*
+Frames that left the presented area untouched are already on the window and aren't copied again.
+*/
+void SoftwareRenderer::finalizeFrame() {
+    bool presentedAreaChanged = takePresentedAreaDirty() | mainWindow->takeExposed();
+    if (!presentedAreaChanged) {
+        frameStatistics.unchangedFrames++;
+    }
+    endFrameStatistics();
+    if (frameCapture) {
+        captureFrame();
+    }
+    if (presentedAreaChanged) {
+        presentFrame();
+    }
+}
+
+/*
+VRAM is already up to date, only the copy to the window is left out.
+*/
+void SoftwareRenderer::skipFrame() {
+    frameStatistics.skippedFrames++;
+    endFrameStatistics();
+}
+
+/*
+Converts the display area to RGBA8 with the bottom row first, the layout frame capture expects.
+*/
+void SoftwareRenderer::captureFrame() {
+    CapturedFrame frame;
+    frame.width = screenResolution.width;
+    frame.height = screenResolution.height;
+    frame.pixels.resize(((size_t)frame.width) * frame.height * 4);
+    const uint16_t *vram = rasterizer->vramRef();
+    for (uint32_t row = 0; row < frame.height; row++) {
+        uint32_t y = (displayAreaStart.y + frame.height - 1 - row) & (VRAM_HEIGHT - 1);
+        uint8_t *destination = &frame.pixels[((size_t)row) * frame.width * 4];
+        for (uint32_t column = 0; column < frame.width; column++) {
+            uint16_t pixel = vram[y * VRAM_WIDTH + ((displayAreaStart.x + column) & (VRAM_WIDTH - 1))];
+            uint8_t red = pixel & 0x1f;
+            uint8_t green = (pixel >> 5) & 0x1f;
+            uint8_t blue = (pixel >> 10) & 0x1f;
+            destination[column * 4] = (red << 3) | (red >> 2);
+            destination[column * 4 + 1] = (green << 3) | (green >> 2);
+            destination[column * 4 + 2] = (blue << 3) | (blue >> 2);
+            destination[column * 4 + 3] = 0xff;
+        }
+    }
+    frameCapture->capture(frame);
+}
+
+void SoftwareRenderer::presentFrame() {
+    if (mainWindow->isHeadless()) {
+        return;
+    }
+    SDL_UpdateTexture(sdlTexture, nullptr, rasterizer->vramRef(), VRAM_WIDTH * sizeof(uint16_t));
+    SDL_Rect source = { 0, 0, (int)VRAM_WIDTH, (int)VRAM_HEIGHT };
+    if (!resizeToFitFramebuffer) {
+        source.x = displayAreaStart.x;
+        source.y = displayAreaStart.y;
+        source.w = min((int)screenResolution.width, (int)VRAM_WIDTH - source.x);
+        source.h = min((int)screenResolution.height, (int)VRAM_HEIGHT - source.y);
+    }
+    SDL_RenderCopy(sdlRenderer, sdlTexture, &source, nullptr);
+    SDL_RenderPresent(sdlRenderer);
+}
+
+void SoftwareRenderer::updateWindowTitle(string title) {
+    if (mainWindow->isHeadless()) {
+        return;
+    }
+    SDL_SetWindowTitle(mainWindow->getWindowRef(), title.c_str());
+}
+
+void SoftwareRenderer::writeImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    uint16_t x, y, width, height;
+    tie(x, y) = imageBuffer->destination();
+    tie(width, height) = imageBuffer->resolution();
+    markVRAMWritten(Point2D(x, y), Dimensions(width, height));
+    renderFrame(RendererFlushReason::RendererFlushReasonVRAMWrite);
+    rasterizer->writeVRAM(imageBuffer);
+}
+
+void SoftwareRenderer::loadImage(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    uint16_t width, height;
+    tie(width, height) = imageBuffer->resolution();
+    writeImage(imageBuffer);
+    frameStatistics.vramUploads++;
+    frameStatistics.vramUploadBytes += ((uint64_t)width) * height * sizeof(uint16_t);
+}
+
+void SoftwareRenderer::fillRectangle(Point2D topLeft, Dimensions size, uint16_t color) {
+    markVRAMWritten(topLeft, size);
+    if (rasterizer->conflictsWithBatch(topLeft, size)) {
+        renderFrame(RendererFlushReason::RendererFlushReasonVRAMFill);
+    }
+    rasterizer->fillVRAM(topLeft, size, color);
+    frameStatistics.vramFills++;
+}
+
+void SoftwareRenderer::copyRectangle(Point2D source, Point2D destination, Dimensions size, bool setMaskBit, bool checkMaskBit) {
+    markVRAMWritten(destination, size);
+    renderFrame(RendererFlushReason::RendererFlushReasonVRAMWrite);
+    rasterizer->copyVRAM(source, destination, size, setMaskBit, checkMaskBit);
+    frameStatistics.vramCopies++;
+}
+
+std::vector<uint16_t> SoftwareRenderer::readVRAM(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    renderFrame(RendererFlushReason::RendererFlushReasonVRAMRead);
+    return rasterizer->readVRAM(x, y, width, height);
+}
+
+void SoftwareRenderer::resetMainWindow() {}
+
+void SoftwareRenderer::setDisplayAreaSart(Point2D point) {
+    displayAreaStart = point;
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+void SoftwareRenderer::setScreenResolution(Dimensions dimensions) {
+    screenResolution = dimensions;
+    setPresentedArea(displayAreaStart, screenResolution, resizeToFitFramebuffer);
+}
+
+void SoftwareRenderer::setDrawingArea(Point2D topLeft, Dimensions size) {
+    drawingAreaTopLeft = topLeft;
+    drawingAreaSize = size;
+    rasterizer->setDrawingArea(topLeft, size);
+}
+
+void SoftwareRenderer::toggleRenderPolygonOneByOne() {
+    renderPolygonOneByOne = !renderPolygonOneByOne;
+}
+
+void SoftwareRenderer::startCapture(std::filesystem::path filePath) {
+    frameCapture = make_unique<FrameCapture>(filePath);
+}
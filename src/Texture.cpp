@@ -31,7 +31,10 @@ void Texture::bind(GLenum texture) {
     glBindTexture(GL_TEXTURE_2D, object);
 }
 
-void Texture::setImageFromBuffer(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+/*
+The pixels are read from the bound pixel unpack buffer, starting at unpackOffset.
+*/
+void Texture::setImageFromBuffer(std::unique_ptr<GPUImageBuffer> &imageBuffer, GLintptr unpackOffset) {
     if (!imageBuffer->isValid()) {
         logger.logError("Invalid image buffer");
     }
@@ -40,7 +43,7 @@ void Texture::setImageFromBuffer(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
     tie(width, height) = imageBuffer->resolution();
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glBindTexture(GL_TEXTURE_2D, object);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, imageBuffer->bufferRef());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, (const void *)unpackOffset);
     RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
     rendererDebugger->checkForOpenGLErrors();
 }
@@ -0,0 +1,149 @@
+#include "TextureCache.hpp"
+#include <algorithm>
+#include "RendererDebugger.hpp"
+
+using namespace std;
+
+TextureCacheEntry::TextureCacheEntry() : texturePage(), clut(), textureDepthShift(0), valid(false), lastUsed(0), lastBatch(0) {}
+
+bool TextureCacheEntry::matches(Point2D texturePage, Point2D clut, GLuint textureDepthShift) const {
+    return valid && this->textureDepthShift == textureDepthShift && this->texturePage.x == texturePage.x && this->texturePage.y == texturePage.y && this->clut.x == clut.x && this->clut.y == clut.y;
+}
+
+static bool rangesOverlap(uint32_t start, uint32_t length, uint32_t otherStart, uint32_t otherLength, uint32_t size) {
+    // Both ranges wrap around VRAM, so compare them as up to two linear segments each
+    for (uint32_t offset = 0; offset < length; offset += (size - ((start + offset) % size))) {
+        uint32_t segmentStart = (start + offset) % size;
+        uint32_t segmentLength = min(length - offset, size - segmentStart);
+        for (uint32_t otherOffset = 0; otherOffset < otherLength; otherOffset += (size - ((otherStart + otherOffset) % size))) {
+            uint32_t otherSegmentStart = (otherStart + otherOffset) % size;
+            uint32_t otherSegmentLength = min(otherLength - otherOffset, size - otherSegmentStart);
+            if (segmentStart < otherSegmentStart + otherSegmentLength && otherSegmentStart < segmentStart + segmentLength) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TextureCacheEntry::overlaps(uint16_t x, uint16_t y, uint16_t width, uint16_t height) const {
+    if (!valid) {
+        return false;
+    }
+    uint32_t pageWidth = TEXTURE_CACHE_PAGE_SIZE >> textureDepthShift;
+    bool pageOverlaps = rangesOverlap(texturePage.x, pageWidth, x, width, VRAM_WIDTH) && rangesOverlap(texturePage.y, TEXTURE_CACHE_PAGE_SIZE, y, height, VRAM_HEIGHT);
+    if (pageOverlaps) {
+        return true;
+    }
+    uint32_t clutWidth = 1 << (16 >> textureDepthShift);
+    return rangesOverlap(clut.x, clutWidth, x, width, VRAM_WIDTH) && rangesOverlap(clut.y, 1, y, height, VRAM_HEIGHT);
+}
+
+TextureCache::TextureCache() : logger(LogLevel::NoLog), vram(VRAM_WIDTH * VRAM_HEIGHT, 0), decodeBuffer(TEXTURE_CACHE_PAGE_SIZE * TEXTURE_CACHE_PAGE_SIZE, 0), entries(), useCounter(0), batch(1) {
+    glGenTextures(1, &object);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, object);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGB5_A1, TEXTURE_CACHE_PAGE_SIZE, TEXTURE_CACHE_PAGE_SIZE, TEXTURE_CACHE_CAPACITY);
+}
+
+TextureCache::~TextureCache() {
+    glDeleteTextures(1, &object);
+}
+
+void TextureCache::bind(GLenum texture) {
+    glActiveTexture(texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, object);
+}
+
+void TextureCache::nextBatch() {
+    batch++;
+}
+
+/*
+Returns the layer holding the decoded page, decoding it into the least recently used layer on a
+miss. Layers referenced by the batch that is currently being built are never evicted, since the
+pending vertices still sample them; -1 is returned when every layer is in use, in which case the
+caller has to draw the batch before trying again.
+*/
+GLint TextureCache::layerFor(Point2D texturePage, Point2D clut, GLuint textureDepthShift) {
+    useCounter++;
+    for (uint32_t i = 0; i < TEXTURE_CACHE_CAPACITY; i++) {
+        TextureCacheEntry &entry = entries[i];
+        if (entry.matches(texturePage, clut, textureDepthShift)) {
+            entry.lastUsed = useCounter;
+            entry.lastBatch = batch;
+            return i;
+        }
+    }
+    GLint victim = -1;
+    for (uint32_t i = 0; i < TEXTURE_CACHE_CAPACITY; i++) {
+        TextureCacheEntry &entry = entries[i];
+        if (entry.lastBatch == batch) {
+            continue;
+        }
+        if (victim < 0 || !entry.valid || entry.lastUsed < entries[victim].lastUsed) {
+            victim = i;
+        }
+        if (!entry.valid) {
+            break;
+        }
+    }
+    if (victim < 0) {
+        return -1;
+    }
+    TextureCacheEntry &entry = entries[victim];
+    entry.texturePage = texturePage;
+    entry.clut = clut;
+    entry.textureDepthShift = textureDepthShift;
+    entry.valid = true;
+    entry.lastUsed = useCounter;
+    entry.lastBatch = batch;
+    decode(victim);
+    return victim;
+}
+
+void TextureCache::decode(GLint layer) {
+    TextureCacheEntry &entry = entries[layer];
+    uint32_t depthShift = entry.textureDepthShift;
+    uint32_t bitsPerPixel = 16 >> depthShift;
+    uint32_t alignMask = (1 << depthShift) - 1;
+    uint32_t indexMask = (1 << bitsPerPixel) - 1;
+    uint32_t clutOffset = (entry.clut.y & (VRAM_HEIGHT - 1)) * VRAM_WIDTH;
+    for (uint32_t y = 0; y < TEXTURE_CACHE_PAGE_SIZE; y++) {
+        uint32_t rowOffset = ((entry.texturePage.y + y) & (VRAM_HEIGHT - 1)) * VRAM_WIDTH;
+        for (uint32_t x = 0; x < TEXTURE_CACHE_PAGE_SIZE; x++) {
+            uint16_t halfword = vram[rowOffset + ((entry.texturePage.x + (x >> depthShift)) & (VRAM_WIDTH - 1))];
+            uint32_t index = (halfword >> ((x & alignMask) * bitsPerPixel)) & indexMask;
+            decodeBuffer[y * TEXTURE_CACHE_PAGE_SIZE + x] = vram[clutOffset + ((entry.clut.x + index) & (VRAM_WIDTH - 1))];
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, object);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, TEXTURE_CACHE_PAGE_SIZE, TEXTURE_CACHE_PAGE_SIZE, 1, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, decodeBuffer.data());
+    RendererDebugger *rendererDebugger = RendererDebugger::getInstance();
+    rendererDebugger->checkForOpenGLErrors();
+}
+
+void TextureCache::writeVRAM(std::unique_ptr<GPUImageBuffer> &imageBuffer) {
+    uint16_t x, y, width, height;
+    tie(x, y) = imageBuffer->destination();
+    tie(width, height) = imageBuffer->resolution();
+    uint16_t *data = imageBuffer->bufferRef();
+    for (uint32_t row = 0; row < height; row++) {
+        uint32_t rowOffset = ((y + row) & (VRAM_HEIGHT - 1)) * VRAM_WIDTH;
+        for (uint32_t column = 0; column < width; column++) {
+            vram[rowOffset + ((x + column) & (VRAM_WIDTH - 1))] = data[row * width + column];
+        }
+    }
+    for (uint32_t i = 0; i < TEXTURE_CACHE_CAPACITY; i++) {
+        TextureCacheEntry &entry = entries[i];
+        if (!entry.overlaps(x, y, width, height)) {
+            continue;
+        }
+        // Vertices already batched sample VRAM when the batch is drawn, so they have to see the new contents too
+        if (entry.lastBatch == batch) {
+            decode(i);
+        } else {
+            entry.valid = false;
+        }
+    }
+}
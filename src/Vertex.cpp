@@ -10,6 +10,18 @@ Point2D::Point2D(uint32_t position) {
     y = ((GLshort)((position >> 16) & 0xffff));
 }
 
+/*
+Vertex position:
+0-10     X coordinate (signed, -1024..+1023)
+16-26    Y coordinate (signed, -1024..+1023)
+The bits above are ignored, so 0400h is -1024 and 0800h is 0.
+*/
+Point2D Point2D::forVertexPosition(uint32_t position) {
+    GLshort x = ((GLshort)((position & 0x7ff) << 5)) >> 5;
+    GLshort y = ((GLshort)(((position >> 16) & 0x7ff) << 5)) >> 5;
+    return {x, y};
+}
+
 Point2D Point2D::forTexturePosition(uint16_t position) {
     GLshort texturePositonX = ((GLshort)(position & 0xff));
     GLshort texturePositionY = ((GLshort)((position >> 8) & 0xff));
@@ -46,8 +58,9 @@ Point3D::Point3D() : x(), y(), z() {}
 Point3D::Point3D(GLshort x, GLshort y, GLshort z) : x(x), y(y), z(z) {}
 
 Point3D::Point3D(uint32_t position) {
-    x = ((GLshort)(position & 0xffff));
-    y = ((GLshort)((position >> 16) & 0xffff));
+    Point2D point = Point2D::forVertexPosition(position);
+    x = point.x;
+    y = point.y;
     z = 0;
 }
 
@@ -57,12 +70,38 @@ Color::Color(uint32_t color) {
     b = ((GLubyte)((color >> 16) & 0xff));
 }
 
-Vertex::Vertex(Point3D point, Color color, GLuint opaque) : point(point), color(color), transparent(!opaque), texturePosition(), textureBlendMode(), texturePage(), textureDepthShift(), clut() {}
+Vertex::Vertex(Point3D point, Color color, GLuint opaque) : point(point), color(color), transparent(!opaque), texturePosition(), textureBlendMode(), texturePage(), textureDepthShift(), clut(), textureCacheLayer(-1), semiTransparency(0) {}
 
-Vertex::Vertex(Point3D point, Color color, GLuint opaque, Point2D texturePosition, TextureBlendMode textureBlendMode, Point2D texturePage, GLuint textureDepthShift, Point2D clut) : point(point), color(color),  transparent(!opaque), texturePosition(texturePosition), textureBlendMode(textureBlendMode), texturePage(texturePage), textureDepthShift(textureDepthShift), clut(clut) {}
+Vertex::Vertex(Point3D point, Color color, GLuint opaque, Point2D texturePosition, TextureBlendMode textureBlendMode, Point2D texturePage, GLuint textureDepthShift, Point2D clut) : point(point), color(color),  transparent(!opaque), texturePosition(texturePosition), textureBlendMode(textureBlendMode), texturePage(texturePage), textureDepthShift(textureDepthShift), clut(clut), textureCacheLayer(-1), semiTransparency(0) {}
 
 Vertex::~Vertex() {}
 
+RectangleInstance::RectangleInstance(Point2D point, Dimensions size, Color color, GLuint opaque) : point(point), size((GLshort)size.width, (GLshort)size.height), texturePosition(), texturePage(), clut(), color(color), transparent(!opaque), textureBlendMode(TextureBlendMode::TextureBlendModeNoTexture), textureDepthShift(), semiTransparency(0), textureCacheLayer(-1) {}
+
+RectangleInstance::RectangleInstance(Point2D point, Dimensions size, Color color, GLuint opaque, Point2D texturePosition, TextureBlendMode textureBlendMode, Point2D texturePage, GLuint textureDepthShift, Point2D clut) : point(point), size((GLshort)size.width, (GLshort)size.height), texturePosition(texturePosition), texturePage(texturePage), clut(clut), color(color), transparent(!opaque), textureBlendMode(textureBlendMode), textureDepthShift(textureDepthShift), semiTransparency(0), textureCacheLayer(-1) {}
+
+RectangleInstance::~RectangleInstance() {}
+
+/*
+The four corners as a quad in the order pushPolygon expects, for backends that rasterize
+rectangles like any other polygon.
+*/
+std::vector<Vertex> RectangleInstance::vertices() const {
+    std::vector<Vertex> vertices;
+    for (GLshort corner = 0; corner < 4; corner++) {
+        GLshort right = corner & 1;
+        GLshort bottom = corner >> 1;
+        Point3D cornerPoint = Point3D(point.x + right * size.x, point.y + bottom * size.y, 0);
+        if (textureBlendMode == TextureBlendMode::TextureBlendModeNoTexture) {
+            vertices.push_back(Vertex(cornerPoint, color, !transparent));
+            continue;
+        }
+        Point2D cornerTexturePosition = Point2D(texturePosition.x + right * size.x, texturePosition.y + bottom * size.y);
+        vertices.push_back(Vertex(cornerPoint, color, !transparent, cornerTexturePosition, TextureBlendMode(textureBlendMode), texturePage, textureDepthShift, clut));
+    }
+    return vertices;
+}
+
 Pixel::Pixel(GLfloat pointX, GLfloat pointY, GLfloat framebufferPositionX, GLfloat framebufferPositionY) : pointX(pointX), pointY(pointY), framebufferPositionX(framebufferPositionX), framebufferPositionY(framebufferPositionY) {}
 
 Pixel::~Pixel() {}
@@ -1,23 +1,121 @@
 #include "Window.hpp"
 #include "ConfigurationManager.hpp"
+#ifdef HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 using namespace std;
 
-Window::Window(bool mainWindow, string title, uint32_t width, uint32_t height, bool hidden) : logger(LogLevel::NoLog), mainWindow(mainWindow), title(title), width(width), height(height), hidden(hidden) {
-    Uint32 flags = SDL_WINDOW_OPENGL;
+/*
+Windows created without an OpenGL context are presented through SDL's own 2D renderer, which is
+what the software renderer uses on hosts with no usable OpenGL driver.
+*/
+Window::Window(bool mainWindow, string title, uint32_t width, uint32_t height, bool hidden, bool openGL) : logger(LogLevel::NoLog), mainWindow(mainWindow), title(title), width(width), height(height), glContext(nullptr), hidden(hidden), exposed(false), headless(false), openGL(openGL), eglDisplay(nullptr), eglSurface(nullptr), eglContext(nullptr) {
+    Uint32 flags = 0;
+    if (openGL) {
+        flags |= SDL_WINDOW_OPENGL;
+    }
     if (hidden) {
         flags |= SDL_WINDOW_HIDDEN;
     }
     window = SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, flags);
     windowID = SDL_GetWindowID(window);
-    glContext = SDL_GL_CreateContext(window);
+    if (openGL) {
+        glContext = SDL_GL_CreateContext(window);
+    }
+}
+
+Window::Window(string title, uint32_t width, uint32_t height, bool openGL) : logger(LogLevel::NoLog), mainWindow(true), title(title), width(width), height(height), glContext(nullptr), window(nullptr), windowID(0), hidden(false), exposed(false), headless(true), openGL(openGL), eglDisplay(nullptr), eglSurface(nullptr), eglContext(nullptr) {
+    if (openGL) {
+        setupHeadlessContext();
+    }
 }
 
 Window::~Window() {
-    SDL_GL_DeleteContext(glContext);
+    if (headless && !openGL) {
+        return;
+    }
+    if (headless) {
+#ifdef HEADLESS
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(eglDisplay, eglContext);
+        if (eglSurface != EGL_NO_SURFACE) {
+            eglDestroySurface(eglDisplay, eglSurface);
+        }
+        eglTerminate(eglDisplay);
+#endif
+        return;
+    }
+    if (openGL) {
+        SDL_GL_DeleteContext(glContext);
+    }
     SDL_DestroyWindow(window);
 }
 
+/*
+Headless windows have no SDL window, they render into an offscreen OpenGL 4.5 context created
+through EGL. Mesa's surfaceless platform is preferred since it doesn't need a display server,
+a pbuffer surface is used when the driver exposes a matching config.
+*/
+void Window::setupHeadlessContext() {
+#ifdef HEADLESS
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != nullptr) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        logger.logError("Error initializing EGL: %#x", eglGetError());
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        logger.logError("Error binding the OpenGL API: %#x", eglGetError());
+    }
+    EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numberOfConfigs = 0;
+    eglChooseConfig(display, configAttributes, &config, 1, &numberOfConfigs);
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (numberOfConfigs > 0) {
+        EGLint surfaceAttributes[] = {
+            EGL_WIDTH, (EGLint)width,
+            EGL_HEIGHT, (EGLint)height,
+            EGL_NONE
+        };
+        surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    } else {
+        config = nullptr;
+    }
+    EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT) {
+        logger.logError("Error creating headless OpenGL 4.5 context: %#x", eglGetError());
+    }
+    eglDisplay = display;
+    eglSurface = surface;
+    eglContext = context;
+#else
+    logger.logError("Headless mode requires building with EGL support");
+#endif
+}
+
 SDL_Window* Window::getWindowRef() {
     return window;
 }
@@ -27,9 +125,35 @@ SDL_GLContext Window::getGLContext() {
 }
 
 void Window::makeCurrent() {
+    if (!openGL) {
+        return;
+    }
+    if (headless) {
+#ifdef HEADLESS
+        eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext);
+#endif
+        return;
+    }
     SDL_GL_MakeCurrent(window, glContext);
 }
 
+GLADloadproc Window::getProcAddressLoader() {
+#ifdef HEADLESS
+    if (headless) {
+        return (GLADloadproc) eglGetProcAddress;
+    }
+#endif
+    return (GLADloadproc) SDL_GL_GetProcAddress;
+}
+
+bool Window::isHeadless() {
+    return headless;
+}
+
+bool Window::hasOpenGLContext() {
+    return openGL;
+}
+
 Dimensions Window::getDimensions() {
     return { width, height };
 }
@@ -49,6 +173,11 @@ void Window::handleSDLEvent(SDL_Event event) {
             }
             break;
         }
+        case SDL_WINDOWEVENT_EXPOSED:
+        case SDL_WINDOWEVENT_SIZE_CHANGED: {
+            exposed = true;
+            break;
+        }
     }
 }
 
@@ -64,3 +193,13 @@ void Window::toggleHidden() {
         SDL_HideWindow(window);
     }
 }
+
+/*
+Whether the window contents were lost or resized since the last time this was called, so the
+last frame has to be shown again even if it didn't change.
+*/
+bool Window::takeExposed() {
+    bool wasExposed = exposed;
+    exposed = false;
+    return wasExposed;
+}
@@ -10,6 +10,9 @@
 
 using namespace std;
 
+// How late the main loop can fall behind its schedule before giving up on catching up
+const uint32_t MaximumFramesBehind = 8;
+
 int main(int argc, char* argv[]) {
     EmulatorRunner *emulatorRunner = EmulatorRunner::getInstance();
     emulatorRunner->configure(argc, argv);
@@ -21,9 +24,9 @@ int main(int argc, char* argv[]) {
     Debugger *debugger = Debugger::getInstance();
     debugger->setCPU(emulator->getCPU());
     bool quit = false;
-    uint32_t initTicks = SDL_GetTicks();
-    float interval = 1000;
+    double interval = 1000;
     interval /= FrameRateTarget;
+    double nextFrameTicks = SDL_GetTicks();
     while (!quit) {
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
@@ -62,9 +65,15 @@ int main(int argc, char* argv[]) {
             continue;
         }
         uint32_t currentTicks = SDL_GetTicks();
-        if (initTicks + interval < currentTicks) {
+        // Headless runs aren't presented to anyone, so there is no need to pace them
+        if (emulator->isHeadless() || nextFrameTicks <= currentTicks) {
             emulator->emulateFrame();
-            initTicks = SDL_GetTicks();
+            // Frames are scheduled at a fixed rate, so the time spent emulating one doesn't
+            // delay the next, and falling too far behind starts over instead of rushing ahead
+            nextFrameTicks += interval;
+            if (nextFrameTicks + interval * MaximumFramesBehind < currentTicks) {
+                nextFrameTicks = currentTicks;
+            }
         }
     }
     return 0;
@@ -0,0 +1,206 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "CPU.hpp"
+#include "COP0.hpp"
+#include "GTE.hpp"
+#include "Interconnect.hpp"
+#include "InterruptController.hpp"
+#include "Debugger.hpp"
+#include "RAM.tcc"
+#include "InterruptController.tcc"
+
+using namespace std;
+
+const uint32_t CPU_GTE_TESTS_PROGRAM = 0x80010000;
+// Right after the last GTE command, where the program marks that it's done
+const uint32_t CPU_GTE_TESTS_PROGRAM_END = 0x8001001C;
+const uint32_t CPU_GTE_TESTS_HANDLER = 0x80000080;
+// Where the handler counts the interrupts it took, and stores MAC0 and EPC as it found them
+const uint32_t CPU_GTE_TESTS_RESULTS = 0x20000;
+const uint32_t CPU_GTE_TESTS_MAXIMUM_STEPS = 100;
+// Anything other than a zero word ends a fused sequence, so this keeps the commands apart
+const uint32_t CPU_GTE_TESTS_UNFUSED_NOP = 0x00000025; // or zero, zero, zero
+
+const vector<uint32_t> CPU_GTE_TESTS_HANDLER_PROGRAM = {
+    0x3C1A8002, // lui k0, 0x8002
+    0x8F5B0000, // lw k1, 0(k0)
+    0x00000000,
+    0x277B0001, // addiu k1, k1, 1
+    0xAF5B0000, // sw k1, 0(k0)
+    0x481BC000, // mfc2 k1, MAC0
+    0x00000000,
+    0xAF5B0004, // sw k1, 4(k0)
+    0x401B7000, // mfc0 k1, EPC
+    0x00000000,
+    0xAF5B0008, // sw k1, 8(k0)
+    0x3C1A1F80, // lui k0, 0x1F80
+    0xAF401070, // sw zero, 0x1070(k0), acknowledges every request
+    0x401A7000, // mfc0 k0, EPC
+    0x00000000,
+    0x03400008, // jr k0
+    0x42000010, // rfe
+};
+
+static uint32_t failures = 0;
+
+static void check(bool condition, string description) {
+    if (!condition) {
+        cout << "FAILED: " << description << endl;
+        failures++;
+    }
+}
+
+struct CPUGTERun {
+    uint32_t steps;
+    uint32_t interrupts;
+    uint32_t handlerMAC0;
+    uint32_t handlerEPC;
+    vector<uint32_t> registers;
+};
+
+/*
+The CPU and only what it needs to run code from RAM. The interconnect loads the BIOS from the
+working directory, so a blank one is put in a scratch directory first.
+*/
+struct CPUGTEMachine {
+    unique_ptr<COP0> cop0;
+    unique_ptr<BIOS> bios;
+    unique_ptr<RAM> ram;
+    unique_ptr<GPU> gpu;
+    unique_ptr<DMA> dma;
+    unique_ptr<Scratchpad> scratchpad;
+    unique_ptr<CDROM> cdrom;
+    unique_ptr<InterruptController> interruptController;
+    unique_ptr<Expansion1> expansion1;
+    unique_ptr<Timer0> timer0;
+    unique_ptr<Timer1> timer1;
+    unique_ptr<Timer2> timer2;
+    unique_ptr<Controller> controller;
+    unique_ptr<SPU> spu;
+    unique_ptr<Interconnect> interconnect;
+    unique_ptr<GTE> gte;
+    unique_ptr<CPU> cpu;
+
+    CPUGTEMachine() : cop0(make_unique<COP0>()), bios(make_unique<BIOS>(LogLevel::NoLog)), ram(make_unique<RAM>()), interruptController(make_unique<InterruptController>(LogLevel::NoLog)), gte(make_unique<GTE>(LogLevel::NoLog)) {
+        filesystem::path directory = filesystem::temp_directory_path() / "ruby-cpu-gte-tests";
+        filesystem::create_directories(directory);
+        ofstream(directory / "SCPH1001.BIN", ios::out|ios::binary) << string(BIOS_SIZE, '\0');
+        filesystem::current_path(directory);
+        interconnect = make_unique<Interconnect>(LogLevel::NoLog, cop0, bios, ram, gpu, dma, scratchpad, cdrom, interruptController, expansion1, timer0, timer1, timer2, controller, spu);
+        cpu = make_unique<CPU>(LogLevel::NoLog, interconnect, cop0, false, gte, interruptController);
+        Debugger::getInstance()->setCPU(cpu.get());
+    }
+
+    void storeProgram(uint32_t address, vector<uint32_t> program) {
+        for (uint32_t word : program) {
+            ram->store<uint32_t>(address & 0x1FFFFFFF, word);
+            address += 4;
+        }
+    }
+};
+
+/*
+Runs RTPT, NCLIP and AVSZ3 with two NOPs between each, the way the PsyQ macros lay them out, and
+raises an interrupt before the given step. CAUSE is only updated at checkStep, like the emulator
+only checks for interrupts between batches of instructions. The handler counts the interrupt and
+keeps MAC0 and EPC as it found them. Stops once the program is done, counting the steps it took.
+*/
+static CPUGTERun runSequence(bool fusable, uint32_t raiseStep, uint32_t checkStep) {
+    CPUGTEMachine machine = CPUGTEMachine();
+    uint32_t nop = fusable ? 0 : CPU_GTE_TESTS_UNFUSED_NOP;
+    machine.storeProgram(CPU_GTE_TESTS_PROGRAM, {
+        0x4A280030, nop, nop, // RTPT
+        0x4B400006, nop, nop, // NCLIP
+        0x4B58002D, // AVSZ3
+        0x24080001, // addiu t0, zero, 1
+    });
+    machine.storeProgram(CPU_GTE_TESTS_HANDLER, CPU_GTE_TESTS_HANDLER_PROGRAM);
+    mt19937 generator(0x52554259);
+    for (uint32_t i = 0; i < 32; i++) {
+        machine.gte->setData(i, generator());
+        machine.gte->setControl(i, generator());
+    }
+    // COP2 usable, the interrupt controller line unmasked and interrupts enabled
+    machine.cop0->status.value = 0x40000401;
+    machine.interruptController->store<uint32_t>(4, 1 << InterruptRequestNumber::VBLANK);
+    machine.cpu->setProgramCounter(CPU_GTE_TESTS_PROGRAM);
+    uint32_t step = 0;
+    for (; step < CPU_GTE_TESTS_MAXIMUM_STEPS; step++) {
+        if (step == raiseStep) {
+            machine.interruptController->trigger(InterruptRequestNumber::VBLANK);
+        }
+        if (step == checkStep) {
+            machine.cpu->handleInterrupts();
+        }
+        if (machine.cpu->getRegisters()[8] == 1) {
+            break;
+        }
+        machine.cpu->executeNextInstruction();
+    }
+    CPUGTERun run = {};
+    run.steps = step;
+    run.interrupts = machine.ram->load<uint32_t>(CPU_GTE_TESTS_RESULTS);
+    run.handlerMAC0 = machine.ram->load<uint32_t>(CPU_GTE_TESTS_RESULTS + 4);
+    run.handlerEPC = machine.ram->load<uint32_t>(CPU_GTE_TESTS_RESULTS + 8);
+    for (uint32_t i = 0; i < 32; i++) {
+        run.registers.push_back(machine.gte->getData(i));
+    }
+    for (uint32_t i = 0; i < 32; i++) {
+        run.registers.push_back(machine.gte->getControl(i));
+    }
+    return run;
+}
+
+static void testUninterruptedSequenceMatches() {
+    CPUGTERun fused = runSequence(true, CPU_GTE_TESTS_MAXIMUM_STEPS, 0);
+    CPUGTERun sequential = runSequence(false, CPU_GTE_TESTS_MAXIMUM_STEPS, 0);
+    check(fused.steps == sequential.steps, "fused sequence takes as many steps as its instructions");
+    check(fused.registers == sequential.registers, "fused and sequential GTE registers match");
+}
+
+/*
+The request is already raised when RTPT runs but only taken after it, so the handler has to find
+the GTE and EPC between RTPT and NCLIP.
+*/
+static void testPendingInterruptIsTakenBetweenCommands() {
+    CPUGTERun fused = runSequence(true, 0, 1);
+    CPUGTERun sequential = runSequence(false, 0, 1);
+    check(sequential.interrupts == 1 && sequential.handlerEPC == CPU_GTE_TESTS_PROGRAM + 4, "sequential run takes the interrupt after RTPT");
+    check(fused.interrupts == sequential.interrupts, "fused run takes the interrupt once");
+    check(fused.steps == sequential.steps, "fused run takes as many steps");
+    check(fused.handlerEPC == sequential.handlerEPC, "fused run returns to the instruction after RTPT");
+    check(fused.handlerMAC0 == sequential.handlerMAC0, "handler sees the GTE as RTPT left it");
+    check(fused.registers == sequential.registers, "GTE registers match after the interrupt");
+}
+
+/*
+The request comes in after the sequence was fused, so it's taken once the whole sequence retired.
+The handler still has to run from its first instruction and leave the same GTE state behind.
+*/
+static void testInterruptRaisedAfterFusingRunsWholeHandler() {
+    CPUGTERun fused = runSequence(true, 1, 1);
+    CPUGTERun sequential = runSequence(false, 1, 1);
+    check(fused.interrupts == 1, "fused run takes the interrupt once");
+    check(fused.handlerEPC == CPU_GTE_TESTS_PROGRAM_END, "fused run returns past the last fused command");
+    // Both runs take the interrupt on the same step, from there the fused one only saves the six
+    // instructions after RTPT it already retired
+    check(fused.steps + 6 == sequential.steps, "handler starts on the step the interrupt is taken");
+    check(fused.registers == sequential.registers, "GTE registers match after the interrupt");
+}
+
+int main() {
+    testUninterruptedSequenceMatches();
+    testPendingInterruptIsTakenBetweenCommands();
+    testInterruptRaisedAfterFusingRunsWholeHandler();
+    if (failures > 0) {
+        cout << failures << " checks failed" << endl;
+        return 1;
+    }
+    cout << "All checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "FrameSkipController.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+const uint32_t FRAME_SKIP_TESTS_FRAME_RATE = 60;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, string description) {
+    if (!condition) {
+        cout << "FAILED: " << description << endl;
+        failures++;
+    }
+}
+
+/*
+Feeds the controller vblanks the given number of frame budgets apart and returns which of them
+were skipped, the first one only starts the clock.
+*/
+static string skippedFrames(uint32_t maximumSkippedFrames, initializer_list<double> frameTimes) {
+    FrameSkipController controller = FrameSkipController(true, maximumSkippedFrames, FRAME_SKIP_TESTS_FRAME_RATE);
+    duration<double> frameBudget = duration<double>(1.0 / FRAME_SKIP_TESTS_FRAME_RATE);
+    steady_clock::time_point now = steady_clock::time_point();
+    controller.shouldSkipFrame(now);
+    string skipped;
+    for (double frameTime : frameTimes) {
+        now += duration_cast<steady_clock::duration>(frameBudget * frameTime);
+        skipped += controller.shouldSkipFrame(now) ? "S" : ".";
+    }
+    return skipped;
+}
+
+static void testOnTimeFramesAreNeverSkipped() {
+    check(skippedFrames(3, { 1.0, 0.5, 1.0, 0.9, 1.0 }) == ".....", "frames within budget are presented");
+}
+
+static void testSlowFrameIsSkippedWithLimitOfOne() {
+    check(skippedFrames(1, { 2.5 }) == "S", "a frame over budget is skipped with a limit of one");
+    check(skippedFrames(1, { 3.0, 1.0, 1.0, 1.0 }) == "S.S.", "never more than one frame is skipped in a row with a limit of one");
+}
+
+static void testConsecutiveSkipsStopAtLimit() {
+    check(skippedFrames(3, { 5.0, 1.0, 1.0, 1.0 }) == "SSS.", "consecutive skips stop at the limit");
+}
+
+static void testLagIsPaidBackByFastFrames() {
+    check(skippedFrames(3, { 2.5, 0.2, 0.2, 1.0 }) == "S...", "fast frames pay back lag");
+}
+
+static void testStallsAreForgotten() {
+    check(skippedFrames(3, { FRAME_SKIP_STALL_FRAMES + 1.0, 1.0 }) == "..", "stalls reset the lag instead of skipping");
+}
+
+int main() {
+    testOnTimeFramesAreNeverSkipped();
+    testSlowFrameIsSkippedWithLimitOfOne();
+    testConsecutiveSkipsStopAtLimit();
+    testLagIsPaidBackByFastFrames();
+    testStallsAreForgotten();
+    if (failures > 0) {
+        cout << failures << " checks failed" << endl;
+        return 1;
+    }
+    cout << "All checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Renderer.hpp"
+
+using namespace std;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, string description) {
+    if (!condition) {
+        cout << "FAILED: " << description << endl;
+        failures++;
+    }
+}
+
+static uint16_t &pixel(vector<uint16_t> &vram, uint32_t x, uint32_t y) {
+    return vram[y * VRAM_WIDTH + x];
+}
+
+/*
+A 2x1 source copied over one pixel with its mask bit set and one without.
+*/
+static vector<uint16_t> copyWithMaskBitSetting(bool setMaskBit, bool checkMaskBit) {
+    vector<uint16_t> vram = vector<uint16_t>(VRAM_WIDTH * VRAM_HEIGHT);
+    pixel(vram, 0, 0) = 0x1234;
+    pixel(vram, 1, 0) = 0x0567;
+    pixel(vram, 10, 0) = 0x8001;
+    pixel(vram, 11, 0) = 0x0002;
+    Renderer::copyVRAMRectangle(vram.data(), Point2D(0, 0), Point2D(10, 0), Dimensions(2, 1), setMaskBit, checkMaskBit);
+    return vram;
+}
+
+static void testCopyIgnoresMaskBitsWhenDisabled() {
+    vector<uint16_t> vram = copyWithMaskBitSetting(false, false);
+    check(pixel(vram, 10, 0) == 0x1234 && pixel(vram, 11, 0) == 0x0567, "plain copy overwrites every pixel");
+}
+
+static void testCopySetsMaskBit() {
+    vector<uint16_t> vram = copyWithMaskBitSetting(true, false);
+    check(pixel(vram, 10, 0) == 0x9234 && pixel(vram, 11, 0) == 0x8567, "copied pixels get the mask bit");
+    check(pixel(vram, 0, 0) == 0x1234, "source is left alone");
+}
+
+static void testCopyKeepsMaskedPixels() {
+    vector<uint16_t> vram = copyWithMaskBitSetting(false, true);
+    check(pixel(vram, 10, 0) == 0x8001, "masked destination pixel is kept");
+    check(pixel(vram, 11, 0) == 0x0567, "unmasked destination pixel is copied over");
+    vram = copyWithMaskBitSetting(true, true);
+    check(pixel(vram, 10, 0) == 0x8001 && pixel(vram, 11, 0) == 0x8567, "both settings apply together");
+}
+
+/*
+The check is done against the destination as it was before the copy, even where it overlaps the
+source.
+*/
+static void testOverlappingCopyChecksOriginalDestination() {
+    vector<uint16_t> vram = vector<uint16_t>(VRAM_WIDTH * VRAM_HEIGHT);
+    pixel(vram, 0, 0) = 0x8001;
+    pixel(vram, 1, 0) = 0x0002;
+    pixel(vram, 2, 0) = 0x0003;
+    Renderer::copyVRAMRectangle(vram.data(), Point2D(0, 0), Point2D(1, 0), Dimensions(2, 1), false, true);
+    check(pixel(vram, 1, 0) == 0x8001 && pixel(vram, 2, 0) == 0x0002, "overlapping copy behaves like a memmove");
+}
+
+static void testCopyWrapsAroundVRAM() {
+    vector<uint16_t> vram = vector<uint16_t>(VRAM_WIDTH * VRAM_HEIGHT);
+    pixel(vram, 0, 0) = 0x0001;
+    pixel(vram, 1, 0) = 0x0002;
+    pixel(vram, 0, VRAM_HEIGHT - 1) = 0x8000;
+    Renderer::copyVRAMRectangle(vram.data(), Point2D(0, 0), Point2D(VRAM_WIDTH - 1, VRAM_HEIGHT - 1), Dimensions(2, 1), true, true);
+    check(pixel(vram, VRAM_WIDTH - 1, VRAM_HEIGHT - 1) == 0x8001, "copy starts at the edge of VRAM");
+    check(pixel(vram, 0, VRAM_HEIGHT - 1) == 0x8000, "masked pixel past the edge is kept");
+}
+
+int main() {
+    testCopyIgnoresMaskBitsWhenDisabled();
+    testCopySetsMaskBit();
+    testCopyKeepsMaskedPixels();
+    testOverlappingCopyChecksOriginalDestination();
+    testCopyWrapsAroundVRAM();
+    if (failures > 0) {
+        cout << failures << " checks failed" << endl;
+        return 1;
+    }
+    cout << "All checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <string>
+#include "Vertex.hpp"
+
+using namespace std;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, string description) {
+    if (!condition) {
+        cout << "FAILED: " << description << endl;
+        failures++;
+    }
+}
+
+static uint32_t position(uint16_t x, uint16_t y) {
+    return ((uint32_t)y << 16) | x;
+}
+
+static void testVertexPositionsAreElevenBitSigned() {
+    Point2D point = Point2D::forVertexPosition(position(0x03FF, 0x0400));
+    check(point.x == 1023 && point.y == -1024, "bit 10 is the sign bit");
+    point = Point2D::forVertexPosition(position(0x07FF, 0xFFFF));
+    check(point.x == -1 && point.y == -1, "all ones is -1");
+    point = Point2D::forVertexPosition(position(0x0800, 0xF9FF));
+    check(point.x == 0 && point.y == 0x1FF, "bits above bit 10 are ignored");
+}
+
+/*
+The GPU culls primitives from their GP0 words and the renderer draws the vertices built from them, so
+both have to decode positions the same way.
+*/
+static void testCullAndVerticesDecodeAlike() {
+    for (uint32_t word : { position(0x0800, 0x0800), position(0x0C00, 0x8400), position(0x7BFF, 0xFFF0) }) {
+        Point2D point = Point2D::forVertexPosition(word);
+        Point3D vertex = Point3D(word);
+        check(point.x == vertex.x && point.y == vertex.y, "cull and vertex positions match");
+    }
+}
+
+/*
+A segment from 1023 to 0400h spans a single pixel as 16-bit values, but 2047 pixels as the GPU
+reads it, so it's wider than the 1023 pixels a primitive may span and isn't drawn.
+*/
+static void testOutOfRangeSpanIsMeasuredOnElevenBits() {
+    Point2D left = Point2D::forVertexPosition(position(0x0400, 0));
+    Point2D right = Point2D::forVertexPosition(position(0x03FF, 0));
+    check(right.x - left.x == 2047, "span wraps around the 11-bit range");
+}
+
+int main() {
+    testVertexPositionsAreElevenBitSigned();
+    testCullAndVerticesDecodeAlike();
+    testOutOfRangeSpanIsMeasuredOnElevenBits();
+    if (failures > 0) {
+        cout << failures << " checks failed" << endl;
+        return 1;
+    }
+    cout << "All checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <SDL2/SDL.h>
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <memory>
+#include <vector>
+#include "GPU.hpp"
+#include "GPU.tcc"
+#include "GPURecorder.hpp"
+#include "InterruptController.hpp"
+#include "DebugInfoRenderer.hpp"
+#include "ConfigurationManager.hpp"
+#include "Constants.h"
+#include "Window.hpp"
+#include "Logger.hpp"
+
+using namespace std;
+
+const uint32_t REPLAY_SCREEN_WIDTH = 1024;
+const uint32_t REPLAY_SCREEN_HEIGHT = 512;
+
+/*
+Feeds a dump written with `ruby --record-gpu` back into the GPU as fast as possible, presenting a
+frame at every recorded vblank, and reports frame rate, draw calls and flushes per frame.
+*/
+class GPUReplay {
+    Logger logger;
+    ifstream file;
+    std::unique_ptr<Window> mainWindow;
+    std::unique_ptr<InterruptController> interruptController;
+    std::unique_ptr<DebugInfoRenderer> debugInfoRenderer;
+    std::unique_ptr<GPU> gpu;
+    vector<uint32_t> words;
+
+    uint32_t readWord();
+public:
+    GPUReplay(std::filesystem::path filePath);
+    ~GPUReplay();
+
+    void run(uint32_t loops);
+};
+
+GPUReplay::GPUReplay(std::filesystem::path filePath) : logger(LogLevel::NoLog), words() {
+    file = ifstream(filePath, ios::in|ios::binary);
+    if (!file.is_open()) {
+        logger.logError("Unable to open GPU recording file: %s", filePath.string().c_str());
+    }
+    char magic[sizeof(GPU_RECORDING_MAGIC) - 1];
+    file.read(magic, sizeof(magic));
+    uint8_t version = file.get();
+    if (!file || memcmp(magic, GPU_RECORDING_MAGIC, sizeof(magic)) != 0) {
+        logger.logError("Invalid GPU recording file: %s", filePath.string().c_str());
+    }
+    if (version != GPU_RECORDING_VERSION) {
+        logger.logError("Unsupported GPU recording version: %d", version);
+    }
+    if (SDL_Init(0) != 0) {
+        logger.logError("Error initializing SDL: %s", SDL_GetError());
+    }
+    ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
+    bool openGL = configurationManager->shouldUseOpenGL();
+    mainWindow = make_unique<Window>(EmulatorName + " - replay", REPLAY_SCREEN_WIDTH, REPLAY_SCREEN_HEIGHT, openGL);
+    mainWindow->makeCurrent();
+    if (openGL && !gladLoadGLLoader(mainWindow->getProcAddressLoader())) {
+        logger.logError("Failed to initialize the OpenGL context.");
+    }
+    interruptController = make_unique<InterruptController>(LogLevel::NoLog);
+    gpu = make_unique<GPU>(LogLevel::NoLog, mainWindow, interruptController, debugInfoRenderer);
+}
+
+GPUReplay::~GPUReplay() {
+    file.close();
+}
+
+uint32_t GPUReplay::readWord() {
+    uint8_t bytes[4];
+    file.read(reinterpret_cast<char *>(bytes), 4);
+    if (!file) {
+        logger.logError("Truncated GPU recording file");
+    }
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (((uint32_t)bytes[3]) << 24);
+}
+
+void GPUReplay::run(uint32_t loops) {
+    streampos recordsStart = file.tellg();
+    uint64_t frames = 0;
+    RendererStatistics initialStatistics = gpu->getRendererStatistics();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t loop = 0; loop < loops; loop++) {
+        file.clear();
+        file.seekg(recordsStart);
+        int type;
+        while ((type = file.get()) != EOF) {
+            switch (type) {
+                case GPURecordType::GPURecordGp0:
+                case GPURecordType::GPURecordGp1: {
+                    uint32_t count = readWord();
+                    words.resize(count);
+                    for (uint32_t i = 0; i < count; i++) {
+                        words[i] = readWord();
+                    }
+                    uint32_t offset = type == GPURecordType::GPURecordGp0 ? 0 : 4;
+                    for (uint32_t value : words) {
+                        gpu->store<uint32_t>(offset, value);
+                    }
+                    break;
+                }
+                case GPURecordType::GPURecordVBlank: {
+                    gpu->render();
+                    frames++;
+                    break;
+                }
+                default: {
+                    logger.logError("Unknown GPU recording record type: %#x", type);
+                }
+            }
+        }
+    }
+    glFinish();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    RendererStatistics statistics = gpu->getRendererStatistics();
+    double perFrame = frames > 0 ? 1.0 / frames : 0.0;
+    cout << "Frames: " << frames << endl;
+    cout << "Time: " << elapsed.count() << " s" << endl;
+    cout << "Frames per second: " << (elapsed.count() > 0 ? frames / elapsed.count() : 0.0) << endl;
+    cout << "Primitives per frame: " << (statistics.totalPrimitives() - initialStatistics.totalPrimitives()) * perFrame << endl;
+    cout << "Vertices uploaded per frame: " << (statistics.verticesUploaded - initialStatistics.verticesUploaded) * perFrame << endl;
+    cout << "Draw calls per frame: " << (statistics.drawCalls - initialStatistics.drawCalls) * perFrame << endl;
+    cout << "Flushes per frame: " << (statistics.totalFlushes() - initialStatistics.totalFlushes()) * perFrame << endl;
+    for (uint32_t i = 0; i < RendererFlushReasonCount; i++) {
+        uint64_t flushes = statistics.flushes[i] - initialStatistics.flushes[i];
+        if (flushes == 0) {
+            continue;
+        }
+        cout << "  " << RendererStatistics::flushReasonName(RendererFlushReason(i)) << ": " << flushes * perFrame << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cout << "Usage: ruby-gpu-replay DUMP [LOOPS]" << endl;
+        return 1;
+    }
+    uint32_t loops = 1;
+    if (argc > 2) {
+        loops = max(atoi(argv[2]), 1);
+    }
+    ConfigurationManager *configurationManager = ConfigurationManager::getInstance();
+    configurationManager->setupConfigurationFile();
+    configurationManager->loadConfiguration();
+    GPUReplay replay = GPUReplay(filesystem::current_path() / string(argv[1]));
+    replay.run(loops);
+    return 0;
+}
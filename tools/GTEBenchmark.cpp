@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "GTE.hpp"
+#include "Logger.hpp"
+
+using namespace std;
+
+// Bits of a COP2 command word selecting the sf and lm variants
+const uint32_t GTE_BENCHMARK_SHIFT_FRACTION = 1 << 19;
+const uint32_t GTE_BENCHMARK_LM = 1 << 10;
+// Best of this many runs is reported, leaving out whatever else the host was busy with
+const uint32_t GTE_BENCHMARK_REPETITIONS = 5;
+
+struct GTEBenchmarkCommand {
+    string name;
+    uint32_t opcode;
+};
+
+/*
+Runs GTE commands back to back on a register state resembling a 3D scene, and reports how long
+each takes for every sf and lm combination. Cycles are those of the timestamp counter, on hosts
+that have one.
+  ruby-gte-benchmark [ITERATIONS]
+*/
+class GTEBenchmark {
+    GTE gte;
+    vector<GTEBenchmarkCommand> commands;
+
+    void loadScene();
+public:
+    GTEBenchmark();
+    ~GTEBenchmark();
+
+    void run(uint32_t iterations);
+};
+
+GTEBenchmark::GTEBenchmark() : gte(LogLevel::NoLog), commands({
+    { "RTPS", 0x0180001 },
+    { "RTPT", 0x0280030 },
+    { "NCLIP", 0x1400006 },
+    { "AVSZ3", 0x158002D },
+    { "MVMVA", 0x0400012 },
+    { "NCDS", 0x0E80413 },
+    { "NCDT", 0x0F80416 },
+    { "NCCT", 0x118043F },
+    { "NCT", 0x0D80420 },
+    { "DPCT", 0x0F8002A },
+}) {}
+
+GTEBenchmark::~GTEBenchmark() {}
+
+void GTEBenchmark::loadScene() {
+    // Rotation close to identity, translation pushing the vertices in front of the camera
+    const uint32_t control[] = {
+        0x00001000, 0x00000000, 0x00001000, 0x00000000, 0x00001000,
+        0x00000010, 0xFFFFFFF0, 0x00000800,
+        0x0B500B50, 0xF4B00000, 0x0B500B50, 0x00000000, 0x00001000,
+        0x00000400, 0x00000400, 0x00000400,
+        0x08000C00, 0x04000800, 0x0C000400, 0x08000C00, 0x00000400,
+        0x00000800, 0x00000800, 0x00000800,
+        0x00A00000, 0x00780000, 0x00000200, 0xFFFFFEB8, 0x01400000,
+        0x00000155, 0x00000100,
+    };
+    for (uint32_t i = 0; i < sizeof(control) / sizeof(control[0]); i++) {
+        gte.setControl(i, control[i]);
+    }
+    const uint32_t data[] = {
+        0x00400040, 0x00000040, 0xFFC00040, 0x00000080, 0x0040FFC0, 0x000000C0,
+        0x20808080,
+    };
+    for (uint32_t i = 0; i < sizeof(data) / sizeof(data[0]); i++) {
+        gte.setData(i, data[i]);
+    }
+    gte.setData(8, 0x800);
+}
+
+void GTEBenchmark::run(uint32_t iterations) {
+    cout << left << setw(8) << "Command" << setw(8) << "Flags" << right << setw(12) << "ns/op" << setw(12) << "cycles/op" << endl;
+    for (const GTEBenchmarkCommand &command : commands) {
+        for (uint32_t variant = 0; variant < 4; variant++) {
+            bool shiftFraction = (variant & 2) != 0;
+            bool lm = (variant & 1) != 0;
+            uint32_t opcode = command.opcode & ~(GTE_BENCHMARK_SHIFT_FRACTION | GTE_BENCHMARK_LM);
+            opcode |= (shiftFraction ? GTE_BENCHMARK_SHIFT_FRACTION : 0) | (lm ? GTE_BENCHMARK_LM : 0);
+            double nanoseconds = 0;
+            double cycles = 0;
+            for (uint32_t repetition = 0; repetition < GTE_BENCHMARK_REPETITIONS; repetition++) {
+                loadScene();
+                auto start = chrono::steady_clock::now();
+#if defined(__x86_64__) || defined(__i386__)
+                uint64_t startCycles = __rdtsc();
+#endif
+                for (uint32_t i = 0; i < iterations; i++) {
+                    gte.execute(opcode);
+                }
+#if defined(__x86_64__) || defined(__i386__)
+                double runCycles = (double)(__rdtsc() - startCycles) / iterations;
+#else
+                double runCycles = 0;
+#endif
+                double runNanoseconds = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+                nanoseconds = repetition == 0 ? runNanoseconds : min(nanoseconds, runNanoseconds);
+                cycles = repetition == 0 ? runCycles : min(cycles, runCycles);
+            }
+            string flags = string("sf=") + (shiftFraction ? "1" : "0") + (lm ? ",lm" : "");
+            cout << left << setw(8) << command.name << setw(8) << flags << right << fixed << setprecision(1) << setw(12) << nanoseconds << setw(12) << cycles << endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t iterations = 1000000;
+    if (argc > 1) {
+        iterations = max(atoi(argv[1]), 1);
+    }
+    GTEBenchmark benchmark;
+    benchmark.run(iterations);
+    return 0;
+}
@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+#include "GTE.hpp"
+#include "Logger.hpp"
+
+using namespace std;
+
+const char GTE_VECTORS_MAGIC[] = "RUBYGTEV";
+const uint8_t GTE_VECTORS_VERSION = 1;
+const uint32_t GTE_VECTORS_REGISTERS = 64;
+// Same seed every run, so a set recorded on one tree can be regenerated on another
+const uint32_t GTE_VECTORS_SEED = 0x47544521;
+const uint32_t GTE_VECTORS_DEFAULT_STATES = 1024;
+// Times each command runs back to back on every state while measuring throughput
+const uint32_t GTE_VECTORS_THROUGHPUT_REPEATS = 64;
+// Bits of a COP2 command word that are randomized on top of the command number: lm, the MVMVA
+// fields and sf
+const uint32_t GTE_VECTORS_VARIANT_MASK = 0x000FE400;
+const uint32_t GTE_VECTORS_MAXIMUM_REPORTED_MISMATCHES = 32;
+
+struct GTEVectorsCommand {
+    string name;
+    uint32_t command;
+};
+
+struct GTEVectorsSequence {
+    string name;
+    vector<uint32_t> opcodes;
+};
+
+/*
+A register state, the command word run on it, and the 32 data registers followed by the 32 control
+registers once it completed.
+*/
+struct GTEVector {
+    uint32_t opcode;
+    uint32_t input[GTE_VECTORS_REGISTERS];
+    uint32_t output[GTE_VECTORS_REGISTERS];
+};
+
+/*
+Golden vectors for the GTE. Recording runs every command on randomized and edge case register
+states and stores the results, verifying runs the same states again and compares every data and
+control register, FLAG included, then reports how many operations per second each command takes.
+Verifying also runs every recorded state through the command sequences the GTE fuses, and compares
+them against the same commands run one at a time.
+  ruby-gte-vectors record FILE [STATES]
+  ruby-gte-vectors verify FILE
+*/
+class GTEVectors {
+    Logger logger;
+    GTE gte;
+    GTE sequentialGTE;
+    vector<GTEVectorsCommand> commands;
+    vector<GTEVectorsSequence> sequences;
+    vector<GTEVector> vectors;
+
+    uint32_t randomRegister(mt19937 &generator, uint32_t mode);
+    void generate(uint32_t states);
+    void loadState(GTE &target, const uint32_t *registers);
+    void storeState(GTE &target, uint32_t *registers);
+    void reportMismatch(string name, const uint32_t *expected, const uint32_t *output);
+    bool verifySequences();
+    void reportThroughput();
+public:
+    GTEVectors();
+    ~GTEVectors();
+
+    void record(std::filesystem::path filePath, uint32_t states);
+    bool verify(std::filesystem::path filePath);
+};
+
+GTEVectors::GTEVectors() : logger(LogLevel::NoLog), gte(LogLevel::NoLog), sequentialGTE(LogLevel::NoLog), commands({
+    { "RTPS", 0x01 },
+    { "NCLIP", 0x06 },
+    { "OP", 0x0C },
+    { "DPCS", 0x10 },
+    { "INTPL", 0x11 },
+    { "MVMVA", 0x12 },
+    { "NCDS", 0x13 },
+    { "CDP", 0x14 },
+    { "NCDT", 0x16 },
+    { "NCCS", 0x1B },
+    { "CC", 0x1C },
+    { "NCS", 0x1E },
+    { "NCT", 0x20 },
+    { "SQR", 0x28 },
+    { "DCPL", 0x29 },
+    { "DPCT", 0x2A },
+    { "AVSZ3", 0x2D },
+    { "AVSZ4", 0x2E },
+    { "RTPT", 0x30 },
+    { "GPF", 0x3D },
+    { "GPL", 0x3E },
+    { "NCCT", 0x3F },
+}), sequences({
+    { "RTPT+NCLIP", { 0x0280030, 0x1400006 } },
+    { "RTPT+AVSZ3", { 0x0280030, 0x158002D } },
+    { "RTPT+AVSZ4", { 0x0280030, 0x168002E } },
+    { "RTPT+NCLIP+AVSZ3", { 0x0280030, 0x1400006, 0x158002D } },
+    { "RTPT+NCLIP+AVSZ4", { 0x0280030, 0x1400006, 0x168002E } },
+    { "RTPT+RTPT", { 0x0280030, 0x0280030 } },
+    { "NCLIP+AVSZ3", { 0x1400006, 0x158002D } },
+}), vectors() {}
+
+GTEVectors::~GTEVectors() {}
+
+/*
+Mode 0 is any value, mode 1 a value at one of the limits the GTE saturates or divides against, and
+mode 2 picks between both for every register.
+*/
+uint32_t GTEVectors::randomRegister(mt19937 &generator, uint32_t mode) {
+    const uint32_t edgeValues[] = {
+        0x00000000, 0x00000001, 0x00007FFF, 0x00008000, 0x0000FFFF, 0x00010000,
+        0x7FFF7FFF, 0x80008000, 0xFFFF0000, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF,
+        0x00000FFF, 0x00001000, 0xFFFFF000, 0x000000FF,
+    };
+    if (mode == 2) {
+        mode = generator() & 1;
+    }
+    if (mode == 0) {
+        return generator();
+    }
+    return edgeValues[generator() % (sizeof(edgeValues) / sizeof(edgeValues[0]))];
+}
+
+void GTEVectors::generate(uint32_t states) {
+    mt19937 generator(GTE_VECTORS_SEED);
+    vectors.clear();
+    vectors.reserve(commands.size() * states);
+    for (const GTEVectorsCommand &command : commands) {
+        for (uint32_t state = 0; state < states; state++) {
+            GTEVector golden = {};
+            golden.opcode = command.command | (generator() & GTE_VECTORS_VARIANT_MASK);
+            for (uint32_t i = 0; i < GTE_VECTORS_REGISTERS; i++) {
+                golden.input[i] = randomRegister(generator, state % 3);
+            }
+            vectors.push_back(golden);
+        }
+    }
+}
+
+/*
+Data registers go in first and in order, so writes with side effects (SXYP pushing the screen XY
+FIFO, IRGB overwriting IR1-IR3) always land the same way.
+*/
+void GTEVectors::loadState(GTE &target, const uint32_t *registers) {
+    for (uint32_t i = 0; i < GTE_VECTORS_REGISTERS / 2; i++) {
+        target.setData(i, registers[i]);
+    }
+    for (uint32_t i = 0; i < GTE_VECTORS_REGISTERS / 2; i++) {
+        target.setControl(i, registers[GTE_VECTORS_REGISTERS / 2 + i]);
+    }
+}
+
+void GTEVectors::storeState(GTE &target, uint32_t *registers) {
+    for (uint32_t i = 0; i < GTE_VECTORS_REGISTERS / 2; i++) {
+        registers[i] = target.getData(i);
+    }
+    for (uint32_t i = 0; i < GTE_VECTORS_REGISTERS / 2; i++) {
+        registers[GTE_VECTORS_REGISTERS / 2 + i] = target.getControl(i);
+    }
+}
+
+void GTEVectors::reportMismatch(string name, const uint32_t *expected, const uint32_t *output) {
+    cout << "Mismatch running " << name << ":" << endl;
+    for (uint32_t i = 0; i < GTE_VECTORS_REGISTERS; i++) {
+        if (output[i] == expected[i]) {
+            continue;
+        }
+        cout << "  " << (i < GTE_VECTORS_REGISTERS / 2 ? "data " : "control ") << dec << i % (GTE_VECTORS_REGISTERS / 2);
+        cout << hex << setfill('0') << ": expected " << setw(8) << expected[i] << ", got " << setw(8) << output[i] << endl;
+        cout << dec << setfill(' ');
+    }
+}
+
+void GTEVectors::record(std::filesystem::path filePath, uint32_t states) {
+    generate(states);
+    ofstream file = ofstream(filePath, ios::out|ios::binary);
+    if (!file.is_open()) {
+        logger.logError("Unable to open GTE vectors file: %s", filePath.string().c_str());
+    }
+    uint32_t count = vectors.size();
+    file.write(GTE_VECTORS_MAGIC, sizeof(GTE_VECTORS_MAGIC) - 1);
+    file.put(GTE_VECTORS_VERSION);
+    file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    for (GTEVector &golden : vectors) {
+        loadState(gte, golden.input);
+        gte.execute(golden.opcode);
+        storeState(gte, golden.output);
+        file.write(reinterpret_cast<const char *>(&golden), sizeof(golden));
+    }
+    if (!file) {
+        logger.logError("Unable to write GTE vectors file: %s", filePath.string().c_str());
+    }
+    cout << "Recorded " << count << " vectors" << endl;
+    reportThroughput();
+}
+
+bool GTEVectors::verify(std::filesystem::path filePath) {
+    ifstream file = ifstream(filePath, ios::in|ios::binary);
+    if (!file.is_open()) {
+        logger.logError("Unable to open GTE vectors file: %s", filePath.string().c_str());
+    }
+    char magic[sizeof(GTE_VECTORS_MAGIC) - 1];
+    file.read(magic, sizeof(magic));
+    uint8_t version = file.get();
+    if (!file || memcmp(magic, GTE_VECTORS_MAGIC, sizeof(magic)) != 0) {
+        logger.logError("Invalid GTE vectors file: %s", filePath.string().c_str());
+    }
+    if (version != GTE_VECTORS_VERSION) {
+        logger.logError("Unsupported GTE vectors version: %d", version);
+    }
+    uint32_t count = 0;
+    file.read(reinterpret_cast<char *>(&count), sizeof(count));
+    vectors.resize(count);
+    file.read(reinterpret_cast<char *>(vectors.data()), count * sizeof(GTEVector));
+    if (!file) {
+        logger.logError("Truncated GTE vectors file: %s", filePath.string().c_str());
+    }
+    uint32_t mismatches = 0;
+    for (const GTEVector &golden : vectors) {
+        uint32_t output[GTE_VECTORS_REGISTERS];
+        loadState(gte, golden.input);
+        gte.execute(golden.opcode);
+        storeState(gte, output);
+        if (memcmp(output, golden.output, sizeof(output)) == 0) {
+            continue;
+        }
+        mismatches++;
+        if (mismatches > GTE_VECTORS_MAXIMUM_REPORTED_MISMATCHES) {
+            continue;
+        }
+        char opcode[16];
+        snprintf(opcode, sizeof(opcode), "%07x", golden.opcode);
+        reportMismatch(opcode, golden.output, output);
+    }
+    cout << "Verified " << count << " vectors, " << mismatches << " mismatches" << endl;
+    bool sequencesMatch = verifySequences();
+    reportThroughput();
+    return mismatches == 0 && sequencesMatch;
+}
+
+/*
+Runs every recorded state through each sequence with GTE::executeSequence and again one command at
+a time, with the sf and lm bits of the state's own command. Fusing drops the FLAG bits RTPT raises
+and skips NCLIP when AVSZ follows, so the check counts how many runs had the first command raise
+flags and fails a sequence where that never happened, since dropping them would then go unchecked.
+Runs ending with flags raised by the last command are counted too. NCLIP never raises any right
+after RTPT, which saturates the screen coordinates to 11 bits.
+*/
+bool GTEVectors::verifySequences() {
+    uint32_t mismatches = 0;
+    bool covered = true;
+    cout << left << setw(18) << "Sequence" << right << setw(12) << "Runs" << setw(12) << "First FLAG" << setw(12) << "Last FLAG" << endl;
+    for (const GTEVectorsSequence &sequence : sequences) {
+        uint32_t firstFlagged = 0;
+        uint32_t lastFlagged = 0;
+        for (const GTEVector &golden : vectors) {
+            vector<uint32_t> opcodes = sequence.opcodes;
+            for (uint32_t &opcode : opcodes) {
+                opcode |= golden.opcode & GTE_VECTORS_VARIANT_MASK;
+            }
+            loadState(gte, golden.input);
+            uint32_t executed = 0;
+            while (executed < opcodes.size()) {
+                executed += gte.executeSequence(opcodes.data() + executed, opcodes.size() - executed);
+            }
+            loadState(sequentialGTE, golden.input);
+            for (uint32_t i = 0; i < opcodes.size(); i++) {
+                sequentialGTE.execute(opcodes[i]);
+                if (i == 0 && sequentialGTE.getControl(31) != 0) {
+                    firstFlagged++;
+                }
+            }
+            uint32_t expected[GTE_VECTORS_REGISTERS];
+            uint32_t output[GTE_VECTORS_REGISTERS];
+            storeState(sequentialGTE, expected);
+            storeState(gte, output);
+            if (expected[GTE_VECTORS_REGISTERS - 1] != 0) {
+                lastFlagged++;
+            }
+            if (memcmp(output, expected, sizeof(output)) == 0) {
+                continue;
+            }
+            mismatches++;
+            if (mismatches <= GTE_VECTORS_MAXIMUM_REPORTED_MISMATCHES) {
+                reportMismatch(sequence.name, expected, output);
+            }
+        }
+        covered = covered && firstFlagged > 0;
+        cout << left << setw(18) << sequence.name << right << setw(12) << vectors.size() << setw(12) << firstFlagged << setw(12) << lastFlagged << endl;
+    }
+    cout << "Verified " << sequences.size() << " sequences, " << mismatches << " mismatches" << endl;
+    if (!covered) {
+        cout << "The first command of some sequence never raised FLAG bits, record more states" << endl;
+    }
+    return mismatches == 0 && covered;
+}
+
+/*
+Each state is loaded outside the timed region, then its command runs back to back on it.
+*/
+void GTEVectors::reportThroughput() {
+    cout << left << setw(8) << "Command" << right << setw(16) << "ops/s" << endl;
+    for (const GTEVectorsCommand &command : commands) {
+        chrono::duration<double> elapsed = chrono::duration<double>::zero();
+        uint64_t operations = 0;
+        for (const GTEVector &golden : vectors) {
+            if ((golden.opcode & 0x3F) != command.command) {
+                continue;
+            }
+            loadState(gte, golden.input);
+            auto start = chrono::steady_clock::now();
+            for (uint32_t i = 0; i < GTE_VECTORS_THROUGHPUT_REPEATS; i++) {
+                gte.execute(golden.opcode);
+            }
+            elapsed += chrono::steady_clock::now() - start;
+            operations += GTE_VECTORS_THROUGHPUT_REPEATS;
+        }
+        if (operations == 0) {
+            continue;
+        }
+        cout << left << setw(8) << command.name << right << fixed << setprecision(0) << setw(16) << operations / elapsed.count() << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || (strcmp(argv[1], "record") != 0 && strcmp(argv[1], "verify") != 0)) {
+        cout << "Usage: ruby-gte-vectors record FILE [STATES]" << endl;
+        cout << "       ruby-gte-vectors verify FILE" << endl;
+        return 1;
+    }
+    GTEVectors vectors;
+    filesystem::path filePath = filesystem::current_path() / string(argv[2]);
+    if (strcmp(argv[1], "record") == 0) {
+        uint32_t states = GTE_VECTORS_DEFAULT_STATES;
+        if (argc > 3) {
+            states = max(atoi(argv[3]), 1);
+        }
+        vectors.record(filePath, states);
+        return 0;
+    }
+    return vectors.verify(filePath) ? 0 : 1;
+}